@@ -0,0 +1,254 @@
+/*
+ * Helpers shared by the benchmarks.  
+ * Benchmarks are built with optimizations and without sanitizers, see the 
+ * `bench_%` rule of the makefile.
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+/* clock_gettime() for pure c99 compilers */
+#if !defined(_POSIX_C_SOURCE) || _POSIX_C_SOURCE < 200112L
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+/* syscall(), to reach perf_event_open() */
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Returns a monotonic timestamp in nanoseconds.
+ */
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/*
+ * Keeps the compiler from optimizing away the computation of `x`.
+ */
+#if defined(__GNUC__)
+#define bench_keep(x) __asm__ volatile("" : : "r"(x) : "memory")
+#else
+static volatile size_t bench_sink;
+#define bench_keep(x) (bench_sink ^= (size_t) (x))
+#endif
+
+/*
+ * xorshift64, a cheap deterministic source of keys.
+ */
+static inline uint64_t bench_rand(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/*
+ * Orders doubles for `qsort`.
+ */
+static inline int bench_cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Returns the `q` quantile, between 0 and 1, of the `n` sorted samples.
+ */
+static inline double bench_quantile(const double *sorted, size_t n, double q)
+{
+    size_t i = (size_t) (q * (double) n);
+
+    if (n == 0)
+    {
+        return 0.0;
+    }
+    return sorted[i < n ? i : n - 1];
+}
+
+/*
+ * Hardware counters read around the timed code, through `perf_event_open` on
+ * Linux.  A counter the kernel or the CPU does not offer is left out, and none
+ * is when perf events are unavailable, e.g. within most containers or with a
+ * `perf_event_paranoid` above 2.
+ */
+enum bench_counter
+{
+    BENCH_CYCLES,
+    BENCH_INSTRUCTIONS,
+    BENCH_LLC_MISSES,
+    BENCH_DTLB_MISSES,
+    BENCH_BRANCH_MISSES,
+    BENCH_NCOUNTERS
+};
+
+static const char *const bench_counter_names[BENCH_NCOUNTERS] =
+{
+    "cycles", "instructions", "llc_misses", "dtlb_misses", "branch_misses"
+};
+
+/*
+ * The file descriptor of each counter, -1 if left out, and the counts summed
+ * over every `bench_counters_start` and `bench_counters_stop` pair since the
+ * last `bench_counters_reset`.
+ */
+typedef struct bench_counters
+{
+    int fds[BENCH_NCOUNTERS];
+    double counts[BENCH_NCOUNTERS];
+} BenchCounters;
+
+#if defined(__linux__)
+static inline int bench_perf_open(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    /* user space only, allowed up to a `perf_event_paranoid` of 2 */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    /* scaled up in `bench_counters_stop` if the PMU had to multiplex */
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+                       | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+#define BENCH_CACHE_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) \
+     | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+#endif
+
+/*
+ * Opens every counter it can, returns how many.  On zero `errno` tells why the
+ * last one could not be opened.
+ */
+static inline int bench_counters_open(BenchCounters *c)
+{
+    int i, nopen = 0;
+
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        c->fds[i] = -1;
+        c->counts[i] = 0.0;
+    }
+#if defined(__linux__)
+    c->fds[BENCH_CYCLES] = bench_perf_open(PERF_TYPE_HARDWARE,
+                                           PERF_COUNT_HW_CPU_CYCLES);
+    c->fds[BENCH_INSTRUCTIONS] = bench_perf_open(PERF_TYPE_HARDWARE,
+                                                 PERF_COUNT_HW_INSTRUCTIONS);
+    c->fds[BENCH_LLC_MISSES] = bench_perf_open(PERF_TYPE_HW_CACHE,
+                                    BENCH_CACHE_MISS(PERF_COUNT_HW_CACHE_LL));
+    c->fds[BENCH_DTLB_MISSES] = bench_perf_open(PERF_TYPE_HW_CACHE,
+                                    BENCH_CACHE_MISS(PERF_COUNT_HW_CACHE_DTLB));
+    c->fds[BENCH_BRANCH_MISSES] = bench_perf_open(PERF_TYPE_HARDWARE,
+                                                  PERF_COUNT_HW_BRANCH_MISSES);
+#else
+    errno = ENOSYS;
+#endif
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        nopen += c->fds[i] >= 0;
+    }
+    return nopen;
+}
+
+static inline void bench_counters_reset(BenchCounters *c)
+{
+    int i;
+
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        c->counts[i] = 0.0;
+    }
+}
+
+static inline void bench_counters_start(BenchCounters *c)
+{
+#if defined(__linux__)
+    int i;
+
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        if (c->fds[i] >= 0)
+        {
+            ioctl(c->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void) c;
+#endif
+}
+
+static inline void bench_counters_stop(BenchCounters *c)
+{
+#if defined(__linux__)
+    /* value, time enabled, time running */
+    uint64_t v[3];
+    int i;
+
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        if (c->fds[i] >= 0)
+        {
+            ioctl(c->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        if (c->fds[i] >= 0 && read(c->fds[i], v, sizeof(v)) == sizeof(v)
+            && v[2] != 0)
+        {
+            c->counts[i] += (double) v[0] * ((double) v[1] / (double) v[2]);
+        }
+    }
+#else
+    (void) c;
+#endif
+}
+
+static inline void bench_counters_close(BenchCounters *c)
+{
+#if defined(__linux__)
+    int i;
+
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        if (c->fds[i] >= 0)
+        {
+            close(c->fds[i]);
+            c->fds[i] = -1;
+        }
+    }
+#else
+    (void) c;
+#endif
+}
+
+#endif
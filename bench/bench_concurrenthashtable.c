@@ -0,0 +1,193 @@
+/*
+ * Compares the throughput of a `ConcurrentHashTableADT` against a `HashTableADT`
+ * behind a single mutex, from one thread up to the number of cores.  Every
+ * thread runs a read-mostly mix: nine lookups of shared keys for each insertion
+ * or deletion of a key of its own.
+ */
+#include "bench.h"
+#include "concurrenthashtable_adt.h"
+#include "hashing.h"
+#include "hashtable_adt.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define NSHARED (1 << 16)
+#define NOPS (1 << 20)
+#define NPRIVATE 1024
+#define MAX_THREADS 64
+
+static uint64_t shared_keys[NSHARED];
+static uint64_t private_keys[MAX_THREADS][NPRIVATE];
+
+static HashTableADT *locked_table;
+static pthread_mutex_t table_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ConcurrentHashTableADT *striped_table;
+
+static pthread_barrier_t start_barrier;
+
+struct worker_args
+{
+    size_t id;
+    int striped;
+};
+
+static Element locked_lookup(const void *key, size_t keysize)
+{
+    Element e;
+
+    pthread_mutex_lock(&table_mutex);
+    e = cadthashtable_lookup(locked_table, key, keysize);
+    pthread_mutex_unlock(&table_mutex);
+    return e;
+}
+
+static void locked_insert(const void *key, size_t keysize, Element e)
+{
+    pthread_mutex_lock(&table_mutex);
+    cadthashtable_insert(locked_table, key, keysize, e);
+    pthread_mutex_unlock(&table_mutex);
+}
+
+static void locked_delete(const void *key, size_t keysize, Element e)
+{
+    pthread_mutex_lock(&table_mutex);
+    cadthashtable_delete(locked_table, (void *) key, keysize, e);
+    pthread_mutex_unlock(&table_mutex);
+}
+
+static void *worker(void *arg)
+{
+    struct worker_args *args = arg;
+    uint64_t state = 0x243f6a8885a308d3u + args->id;
+    uint64_t *mine = private_keys[args->id];
+    size_t i, nfound = 0, next = 0;
+
+    pthread_barrier_wait(&start_barrier);
+
+    for (i = 0; i < NOPS; i++)
+    {
+        uint64_t r = bench_rand(&state);
+
+        if (r % 10 != 0)
+        {
+            const uint64_t *key = &shared_keys[(r >> 8) % NSHARED];
+
+            nfound += (args->striped
+                       ? cadtconcurrenthashtable_lookup(striped_table, key, sizeof(*key))
+                       : locked_lookup(key, sizeof(*key))) != NULL;
+        }
+        else
+        {
+            /* Alternate inserting and deleting keys of this thread */
+            uint64_t *key = &mine[next / 2 % NPRIVATE];
+
+            if (next++ % 2 == 0)
+            {
+                if (args->striped)
+                {
+                    cadtconcurrenthashtable_insert(striped_table, key, sizeof(*key), key);
+                }
+                else
+                {
+                    locked_insert(key, sizeof(*key), key);
+                }
+            }
+            else if (args->striped)
+            {
+                cadtconcurrenthashtable_delete(striped_table, key, sizeof(*key), key);
+            }
+            else
+            {
+                locked_delete(key, sizeof(*key), key);
+            }
+        }
+    }
+    bench_keep(nfound);
+
+    return NULL;
+}
+
+/*
+ * Returns the total operations per second of `nthreads` workers.
+ */
+static double run(size_t nthreads, int striped)
+{
+    pthread_t threads[MAX_THREADS];
+    struct worker_args args[MAX_THREADS];
+    uint64_t start, end;
+    size_t i;
+
+    pthread_barrier_init(&start_barrier, NULL, (unsigned) nthreads + 1);
+    for (i = 0; i < nthreads; i++)
+    {
+        args[i].id = i;
+        args[i].striped = striped;
+        if (pthread_create(&threads[i], NULL, worker, &args[i]) != 0)
+        {
+            perror("run pthread_create failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    pthread_barrier_wait(&start_barrier);
+    start = bench_now_ns();
+    for (i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    end = bench_now_ns();
+    pthread_barrier_destroy(&start_barrier);
+
+    return (double) (nthreads * NOPS) / ((double) (end - start) / 1e9);
+}
+
+int main(void)
+{
+    long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t maxthreads = ncores < 1 ? 1 : ncores > MAX_THREADS ? MAX_THREADS
+                                                               : (size_t) ncores;
+    uint64_t state = 0x13198a2e03707344u;
+    size_t i, j, nthreads;
+
+    for (i = 0; i < MAX_THREADS; i++)
+    {
+        for (j = 0; j < NPRIVATE; j++)
+        {
+            /* Distinct from the shared keys, whose top bit is clear */
+            private_keys[i][j] = (UINT64_C(1) << 63) | (i << 32) | j;
+        }
+    }
+
+    locked_table = cadthashtable_new_pow2(NSHARED, cadthash_int);
+    striped_table = cadtconcurrenthashtable_new(NSHARED, cadthash_int);
+    if (locked_table == NULL || striped_table == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < NSHARED; i++)
+    {
+        shared_keys[i] = bench_rand(&state) >> 1;
+        cadthashtable_insert(locked_table, &shared_keys[i], sizeof(uint64_t),
+                             &shared_keys[i]);
+        cadtconcurrenthashtable_insert(striped_table, &shared_keys[i],
+                                       sizeof(uint64_t), &shared_keys[i]);
+    }
+
+    printf("%-8s %14s %14s\n", "threads", "mutex Mops/s", "striped Mops/s");
+    /* Powers of two, then the core count itself */
+    for (nthreads = 1; ; nthreads = nthreads * 2 < maxthreads ? nthreads * 2
+                                                              : maxthreads)
+    {
+        printf("%-8zu %14.2f %14.2f\n", nthreads, run(nthreads, 0) / 1e6,
+               run(nthreads, 1) / 1e6);
+        if (nthreads == maxthreads)
+        {
+            break;
+        }
+    }
+
+    cadthashtable_destroy(locked_table);
+    cadtconcurrenthashtable_destroy(striped_table);
+
+    return EXIT_SUCCESS;
+}
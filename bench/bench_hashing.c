@@ -0,0 +1,169 @@
+/*
+ * Compares the hash functions of hashing.h against a naive byte loop on the
+ * key shapes found in practice, reporting the time per hash and how evenly
+ * the hashes spread over a power of two number of buckets.
+ */
+#include "bench.h"
+#include "hashing.h"
+
+#include <string.h>
+
+#define NKEYS (1 << 16)
+#define NROUNDS 64
+#define NBUCKETS (NKEYS / 4)
+
+/*
+ * FNV-1a, one multiplication per byte.  The usual hand-rolled hash.
+ */
+static size_t naive_hash(const void *data, size_t size)
+{
+    const unsigned char *p = data;
+    size_t hash = 2166136261u;
+
+    while (size-- > 0)
+    {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * A set of keys of one shape, stored back to back `keysize` bytes apart.
+ */
+struct key_shape
+{
+    const char *name;
+    size_t keysize;
+    int is_int;
+    unsigned char *keys;
+};
+
+struct hash_candidate
+{
+    const char *name;
+    HashFunction *fp;
+    int ints_only;
+};
+
+static void fill_keys(struct key_shape *shape)
+{
+    uint64_t state = 0x243f6a8885a308d3u;
+    size_t i, j;
+
+    if ((shape->keys = malloc(NKEYS * shape->keysize)) == NULL)
+    {
+        perror("fill_keys malloc failed allocating keys");
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < NKEYS; i++)
+    {
+        unsigned char *key = &shape->keys[i * shape->keysize];
+
+        if (shape->is_int)
+        {
+            /* Sequential ids, the worst case for weak mixing */
+            uint64_t id = i;
+            memcpy(key, &id, shape->keysize);
+        }
+        else if (shape->keysize == 48)
+        {
+            /* URLs sharing a long prefix */
+            memset(key, 0, 48);
+            snprintf((char *) key, 48, "https://example.com/api/v1/items/%08zu", i);
+        }
+        else
+        {
+            for (j = 0; j < shape->keysize; j++)
+            {
+                key[j] = (unsigned char) bench_rand(&state);
+            }
+        }
+    }
+}
+
+/*
+ * Returns the nanoseconds per hash of `fp` over the keys of `shape`.
+ */
+static double time_hash(HashFunction *fp, const struct key_shape *shape)
+{
+    uint64_t start, end;
+    size_t r, i;
+
+    start = bench_now_ns();
+    for (r = 0; r < NROUNDS; r++)
+    {
+        for (i = 0; i < NKEYS; i++)
+        {
+            bench_keep(fp(&shape->keys[i * shape->keysize], shape->keysize));
+        }
+    }
+    end = bench_now_ns();
+
+    return (double) (end - start) / ((double) NROUNDS * NKEYS);
+}
+
+/*
+ * Returns the size of the fullest bucket, over the average bucket load.
+ */
+static double bucket_skew(HashFunction *fp, const struct key_shape *shape)
+{
+    static size_t buckets[NBUCKETS];
+    size_t i, max = 0;
+
+    memset(buckets, 0, sizeof(buckets));
+    for (i = 0; i < NKEYS; i++)
+    {
+        size_t b = fp(&shape->keys[i * shape->keysize], shape->keysize)
+                 & (NBUCKETS - 1);
+
+        if (++buckets[b] > max)
+        {
+            max = buckets[b];
+        }
+    }
+    return (double) max / (NKEYS / NBUCKETS);
+}
+
+int main(void)
+{
+    struct key_shape shapes[] =
+    {
+        { "u32 id", 4, 1, NULL },
+        { "u64 id", 8, 1, NULL },
+        { "16B id", 16, 0, NULL },
+        { "48B url", 48, 0, NULL },
+        { "256B blob", 256, 0, NULL },
+    };
+    struct hash_candidate candidates[] =
+    {
+        { "naive", naive_hash, 0 },
+        { "bytes", cadthash_bytes, 0 },
+        { "seeded", cadthash_bytes_seeded, 0 },
+        { "int", cadthash_int, 1 },
+    };
+    size_t s, c;
+
+    cadthash_set_seed(bench_now_ns());
+
+    printf("%-10s %-8s %10s %10s\n", "shape", "hash", "ns/hash", "max/avg");
+    for (s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++)
+    {
+        fill_keys(&shapes[s]);
+
+        for (c = 0; c < sizeof(candidates) / sizeof(candidates[0]); c++)
+        {
+            if (candidates[c].ints_only && !shapes[s].is_int)
+            {
+                continue;
+            }
+            printf("%-10s %-8s %10.2f %10.2f\n", shapes[s].name,
+                   candidates[c].name,
+                   time_hash(candidates[c].fp, &shapes[s]),
+                   bucket_skew(candidates[c].fp, &shapes[s]));
+        }
+        free(shapes[s].keys);
+    }
+
+    return EXIT_SUCCESS;
+}
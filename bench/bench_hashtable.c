@@ -0,0 +1,91 @@
+/*
+ * Compares single and batched lookups on a `HashTableADT` larger than the
+ * last level cache, where every lookup misses on its bucket and its entry.
+ */
+#include "bench.h"
+#include "hashing.h"
+#include "hashtable_adt.h"
+
+#define NKEYS (1 << 20)
+#define NLOOKUPS (1 << 22)
+#define BATCH 64
+
+int main(void)
+{
+    HashTableADT *ht;
+    uint64_t *keys, *order;
+    const void *ptrs[BATCH];
+    size_t sizes[BATCH];
+    Element results[BATCH];
+    uint64_t state = 0x243f6a8885a308d3u, start, end;
+    size_t i, j, nfound;
+    int pow2;
+
+    if ((keys = malloc(NKEYS * sizeof(*keys))) == NULL
+        || (order = malloc(NLOOKUPS * sizeof(*order))) == NULL)
+    {
+        perror("main malloc failed allocating keys");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < NKEYS; i++)
+    {
+        keys[i] = bench_rand(&state);
+    }
+    /* Random lookup order, so the hardware prefetcher cannot help */
+    for (i = 0; i < NLOOKUPS; i++)
+    {
+        order[i] = keys[bench_rand(&state) % NKEYS];
+    }
+    for (j = 0; j < BATCH; j++)
+    {
+        sizes[j] = sizeof(*keys);
+    }
+
+    printf("%-8s %-8s %10s\n", "buckets", "lookup", "ns/key");
+    for (pow2 = 0; pow2 <= 1; pow2++)
+    {
+        ht = pow2 ? cadthashtable_new_pow2(NKEYS, cadthash_int)
+                  : cadthashtable_new(NKEYS, cadthash_int);
+        if (ht == NULL)
+        {
+            exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < NKEYS; i++)
+        {
+            cadthashtable_insert(ht, &keys[i], sizeof(*keys), &keys[i]);
+        }
+
+        nfound = 0;
+        start = bench_now_ns();
+        for (i = 0; i < NLOOKUPS; i++)
+        {
+            nfound += cadthashtable_lookup(ht, &order[i], sizeof(*order)) != NULL;
+        }
+        end = bench_now_ns();
+        bench_keep(nfound);
+        printf("%-8s %-8s %10.2f\n", pow2 ? "pow2" : "prime", "single",
+               (double) (end - start) / NLOOKUPS);
+
+        nfound = 0;
+        start = bench_now_ns();
+        for (i = 0; i < NLOOKUPS; i += BATCH)
+        {
+            for (j = 0; j < BATCH; j++)
+            {
+                ptrs[j] = &order[i + j];
+            }
+            nfound += cadthashtable_lookup_n(ht, ptrs, sizes, BATCH, results);
+        }
+        end = bench_now_ns();
+        bench_keep(nfound);
+        printf("%-8s %-8s %10.2f\n", pow2 ? "pow2" : "prime", "batch",
+               (double) (end - start) / NLOOKUPS);
+
+        cadthashtable_destroy(ht);
+    }
+
+    free(order);
+    free(keys);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+/*
+ * Compares the push/pop and enqueue/dequeue calls to the library against the
+ * inline fast paths of `CADT_INLINE`, on the same objects.  A parenthesized
+ * name, e.g. `(cadtstack_push)`, calls the library function.
+ */
+#define CADT_INLINE
+#include "bench.h"
+#include "queue_adt.h"
+#include "stack_adt.h"
+
+#define NITEMS (1 << 22)
+#define BATCH 64
+
+/* Any non-NULL element will do */
+static char item;
+
+/*
+ * Returns the nanoseconds per item pushed then popped in batches of `BATCH`.
+ */
+static double run_stack(StackADT *s, int inlined)
+{
+    uint64_t start, end;
+    size_t i, j;
+
+    start = bench_now_ns();
+    for (i = 0; i < NITEMS; i += BATCH)
+    {
+        for (j = 0; j < BATCH; j++)
+        {
+            if (inlined)
+            {
+                cadtstack_push(s, &item);
+                continue;
+            }
+            (cadtstack_push)(s, &item);
+        }
+        for (j = 0; j < BATCH; j++)
+        {
+            bench_keep(inlined ? cadtstack_pop(s) : (cadtstack_pop)(s));
+        }
+    }
+    end = bench_now_ns();
+
+    return (double) (end - start) / NITEMS;
+}
+
+/*
+ * Returns the nanoseconds per item enqueued then dequeued in batches of
+ * `BATCH`.
+ */
+static double run_queue(QueueADT *q, int inlined)
+{
+    uint64_t start, end;
+    size_t i, j;
+
+    start = bench_now_ns();
+    for (i = 0; i < NITEMS; i += BATCH)
+    {
+        for (j = 0; j < BATCH; j++)
+        {
+            if (inlined)
+            {
+                cadtqueue_enqueue(q, &item);
+                continue;
+            }
+            (cadtqueue_enqueue)(q, &item);
+        }
+        for (j = 0; j < BATCH; j++)
+        {
+            bench_keep(inlined ? cadtqueue_dequeue(q) : (cadtqueue_dequeue)(q));
+        }
+    }
+    end = bench_now_ns();
+
+    return (double) (end - start) / NITEMS;
+}
+
+int main(void)
+{
+    StackADT *s;
+    QueueADT *q, *pow2;
+
+    /* Sized for the batches, so that only the fast paths are timed */
+    if ((s = cadtstack_new(BATCH)) == NULL
+        || (q = cadtqueue_new(BATCH)) == NULL
+        || (pow2 = cadtqueue_new_pow2(BATCH)) == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-12s %14s %14s\n", "container", "call ns/item", "inline ns/item");
+    printf("%-12s %14.2f %14.2f\n", "stack", run_stack(s, 0), run_stack(s, 1));
+    printf("%-12s %14.2f %14.2f\n", "queue", run_queue(q, 0), run_queue(q, 1));
+    printf("%-12s %14.2f %14.2f\n", "queue pow2", run_queue(pow2, 0),
+           run_queue(pow2, 1));
+
+    cadtstack_destroy(s);
+    cadtqueue_destroy(q);
+    cadtqueue_destroy(pow2);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+/*
+ * Measures the throughput of a `LFStackADT` under contention, against a
+ * `StackADT` behind a mutex, with every thread pushing then popping batches of
+ * items, up to the number of cores.
+ */
+#include "bench.h"
+#include "lfstack_adt.h"
+#include "stack_adt.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define NITEMS (1 << 22)
+/* Items each thread pushes before popping as many */
+#define BATCH 16
+#define MAX_THREADS 64
+
+static LFStackADT *lockfree;
+static StackADT *locked;
+static pthread_mutex_t stack_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t start_barrier;
+
+/* Any non-NULL element will do */
+static char item;
+
+struct worker_args
+{
+    size_t nitems;
+    int use_lf;
+};
+
+static void push(int use_lf)
+{
+    if (use_lf)
+    {
+        cadtlfstack_push(lockfree, &item);
+        return;
+    }
+    pthread_mutex_lock(&stack_mutex);
+    cadtstack_push(locked, &item);
+    pthread_mutex_unlock(&stack_mutex);
+}
+
+static Element pop(int use_lf)
+{
+    Element e;
+
+    if (use_lf)
+    {
+        return cadtlfstack_pop(lockfree);
+    }
+    pthread_mutex_lock(&stack_mutex);
+    e = cadtstack_pop(locked);
+    pthread_mutex_unlock(&stack_mutex);
+    return e;
+}
+
+static void *worker(void *arg)
+{
+    struct worker_args *args = arg;
+    size_t i, j;
+
+    pthread_barrier_wait(&start_barrier);
+    for (i = 0; i < args->nitems; i += BATCH)
+    {
+        for (j = 0; j < BATCH; j++)
+        {
+            push(args->use_lf);
+        }
+        for (j = 0; j < BATCH; j++)
+        {
+            bench_keep(pop(args->use_lf));
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Returns the items per second pushed and popped by `nthreads` threads.
+ */
+static double run(size_t nthreads, int use_lf)
+{
+    pthread_t threads[MAX_THREADS];
+    struct worker_args args[MAX_THREADS];
+    uint64_t start, end;
+    size_t i;
+
+    pthread_barrier_init(&start_barrier, NULL, (unsigned) (nthreads + 1));
+    for (i = 0; i < nthreads; i++)
+    {
+        args[i].nitems = NITEMS / nthreads;
+        args[i].use_lf = use_lf;
+        if (pthread_create(&threads[i], NULL, worker, &args[i]) != 0)
+        {
+            perror("run pthread_create failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    pthread_barrier_wait(&start_barrier);
+    start = bench_now_ns();
+    for (i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    end = bench_now_ns();
+    pthread_barrier_destroy(&start_barrier);
+
+    return (double) NITEMS / ((double) (end - start) / 1e9);
+}
+
+int main(void)
+{
+    long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t maxthreads = ncores < 1 ? 1 : ncores > MAX_THREADS ? MAX_THREADS
+                                                              : (size_t) ncores;
+    size_t nthreads;
+
+    if ((lockfree = cadtlfstack_new(MAX_THREADS * BATCH)) == NULL
+        || (locked = cadtstack_new(MAX_THREADS * BATCH)) == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-8s %14s %14s\n", "threads", "mutex Mitem/s", "lf Mitem/s");
+    /* Powers of two, then the core count itself */
+    for (nthreads = 1; ; nthreads = nthreads * 2 < maxthreads ? nthreads * 2
+                                                              : maxthreads)
+    {
+        printf("%-8zu %14.2f %14.2f\n", nthreads, run(nthreads, 0) / 1e6,
+               run(nthreads, 1) / 1e6);
+        if (nthreads == maxthreads)
+        {
+            break;
+        }
+    }
+
+    cadtlfstack_destroy(lockfree);
+    cadtstack_destroy(locked);
+
+    return EXIT_SUCCESS;
+}
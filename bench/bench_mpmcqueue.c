@@ -0,0 +1,163 @@
+/*
+ * Measures the throughput of a `MPMCQueueADT` under contention, against a
+ * circular `QueueADT` behind a mutex, with as many producers as consumers and
+ * up to the number of cores in total.
+ */
+#include "bench.h"
+#include "mpmcqueue_adt.h"
+#include "queue_adt.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define NITEMS (1 << 21)
+#define QUEUE_SIZE 1024
+#define MAX_THREADS 64
+
+static MPMCQueueADT *mpmc;
+static QueueADT *locked;
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t start_barrier;
+
+/* Items dequeued so far, consumers stop once it reaches `NITEMS` */
+static size_t nconsumed;
+
+/* Any non-NULL element will do */
+static char item;
+
+struct worker_args
+{
+    size_t nitems;
+    int use_mpmc;
+};
+
+static Element enqueue(int use_mpmc)
+{
+    Element e;
+
+    if (use_mpmc)
+    {
+        return cadtmpmcqueue_enqueue(mpmc, &item);
+    }
+    pthread_mutex_lock(&queue_mutex);
+    e = cadtqueue_enqueue(locked, &item);
+    pthread_mutex_unlock(&queue_mutex);
+    return e;
+}
+
+static Element dequeue(int use_mpmc)
+{
+    Element e;
+
+    if (use_mpmc)
+    {
+        return cadtmpmcqueue_dequeue(mpmc);
+    }
+    pthread_mutex_lock(&queue_mutex);
+    e = cadtqueue_dequeue(locked);
+    pthread_mutex_unlock(&queue_mutex);
+    return e;
+}
+
+static void *producer(void *arg)
+{
+    struct worker_args *args = arg;
+    size_t i;
+
+    pthread_barrier_wait(&start_barrier);
+    for (i = 0; i < args->nitems; i++)
+    {
+        while (enqueue(args->use_mpmc) == NULL)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    struct worker_args *args = arg;
+
+    pthread_barrier_wait(&start_barrier);
+    while (__atomic_load_n(&nconsumed, __ATOMIC_RELAXED) < NITEMS)
+    {
+        if (dequeue(args->use_mpmc) == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        __atomic_fetch_add(&nconsumed, 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+/*
+ * Returns the items per second moved by `npairs` producers and as many
+ * consumers.
+ */
+static double run(size_t npairs, int use_mpmc)
+{
+    pthread_t threads[MAX_THREADS];
+    struct worker_args args[MAX_THREADS / 2];
+    uint64_t start, end;
+    size_t i;
+
+    nconsumed = 0;
+    pthread_barrier_init(&start_barrier, NULL, (unsigned) (2 * npairs + 1));
+    for (i = 0; i < npairs; i++)
+    {
+        /* The first producer takes the remainder */
+        args[i].nitems = NITEMS / npairs + (i == 0 ? NITEMS % npairs : 0);
+        args[i].use_mpmc = use_mpmc;
+        if (pthread_create(&threads[2 * i], NULL, producer, &args[i]) != 0
+            || pthread_create(&threads[2 * i + 1], NULL, consumer, &args[i]) != 0)
+        {
+            perror("run pthread_create failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    pthread_barrier_wait(&start_barrier);
+    start = bench_now_ns();
+    for (i = 0; i < 2 * npairs; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    end = bench_now_ns();
+    pthread_barrier_destroy(&start_barrier);
+
+    return (double) NITEMS / ((double) (end - start) / 1e9);
+}
+
+int main(void)
+{
+    long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t maxpairs = ncores < 2 ? 1 : ncores > MAX_THREADS ? MAX_THREADS / 2
+                                                             : (size_t) ncores / 2;
+    size_t npairs;
+
+    if ((mpmc = cadtmpmcqueue_new(QUEUE_SIZE)) == NULL
+        || (locked = cadtqueue_new_circular(QUEUE_SIZE)) == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-10s %-10s %14s %14s\n", "producers", "consumers", "mutex Mitem/s",
+           "mpmc Mitem/s");
+    /* Powers of two, then the core count itself */
+    for (npairs = 1; ; npairs = npairs * 2 < maxpairs ? npairs * 2 : maxpairs)
+    {
+        printf("%-10zu %-10zu %14.2f %14.2f\n", npairs, npairs,
+               run(npairs, 0) / 1e6, run(npairs, 1) / 1e6);
+        if (npairs == maxpairs)
+        {
+            break;
+        }
+    }
+
+    cadtmpmcqueue_destroy(mpmc);
+    cadtqueue_destroy(locked);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+/*
+ * Measures the per-item cost of moving items through a dynamic `QueueADT` one
+ * at a time, against whole batches with `cadtqueue_enqueue_n` and
+ * `cadtqueue_dequeue_n`.
+ */
+#include "bench.h"
+#include "queue_adt.h"
+
+#define NITEMS (1 << 22)
+#define MAX_BATCH 256
+
+/* Any non-NULL element will do */
+static char item;
+
+/*
+ * Returns the nanoseconds per item enqueued then dequeued in batches of
+ * `batch` items, one call per item if `bulk` is zero.
+ */
+static double run(size_t batch, int bulk)
+{
+    Element src[MAX_BATCH], dst[MAX_BATCH];
+    QueueADT *q;
+    uint64_t start, end;
+    size_t i, j;
+
+    if ((q = cadtqueue_new(16)) == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    for (j = 0; j < batch; j++)
+    {
+        src[j] = &item;
+    }
+
+    start = bench_now_ns();
+    for (i = 0; i < NITEMS; i += batch)
+    {
+        if (bulk)
+        {
+            cadtqueue_enqueue_n(q, src, batch);
+            cadtqueue_dequeue_n(q, dst, batch);
+            bench_keep(dst[batch - 1]);
+            continue;
+        }
+        for (j = 0; j < batch; j++)
+        {
+            cadtqueue_enqueue(q, src[j]);
+        }
+        for (j = 0; j < batch; j++)
+        {
+            bench_keep(cadtqueue_dequeue(q));
+        }
+    }
+    end = bench_now_ns();
+
+    cadtqueue_destroy(q);
+
+    return (double) (end - start) / NITEMS;
+}
+
+int main(void)
+{
+    size_t batch;
+
+    printf("%-8s %14s %14s\n", "batch", "single ns/item", "bulk ns/item");
+    for (batch = 1; batch <= MAX_BATCH; batch *= 4)
+    {
+        printf("%-8zu %14.2f %14.2f\n", batch, run(batch, 0), run(batch, 1));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/*
+ * Measures the cost of handing items from one thread to another through a
+ * `SPSCQueueADT`, against a circular `QueueADT` behind a mutex.
+ */
+#include "bench.h"
+#include "queue_adt.h"
+#include "spscqueue_adt.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define NITEMS (1 << 22)
+#define QUEUE_SIZE 1024
+
+static SPSCQueueADT *spsc;
+static QueueADT *locked;
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Any non-NULL element will do */
+static char item;
+
+static void *spsc_producer(void *arg)
+{
+    size_t i;
+
+    (void) arg;
+    for (i = 0; i < NITEMS; i++)
+    {
+        while (cadtspscqueue_enqueue(spsc, &item) == NULL)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *locked_producer(void *arg)
+{
+    size_t i;
+
+    (void) arg;
+    for (i = 0; i < NITEMS; i++)
+    {
+        for (;;)
+        {
+            Element e;
+
+            pthread_mutex_lock(&queue_mutex);
+            e = cadtqueue_enqueue(locked, &item);
+            pthread_mutex_unlock(&queue_mutex);
+            if (e != NULL)
+            {
+                break;
+            }
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Returns the nanoseconds per item handed over by `producer` to this thread.
+ */
+static double run(void *(*producer)(void *), int use_spsc)
+{
+    pthread_t thread;
+    uint64_t start, end;
+    size_t i = 0;
+
+    start = bench_now_ns();
+    if (pthread_create(&thread, NULL, producer, NULL) != 0)
+    {
+        perror("run pthread_create failed");
+        exit(EXIT_FAILURE);
+    }
+    while (i < NITEMS)
+    {
+        Element e;
+
+        if (use_spsc)
+        {
+            e = cadtspscqueue_dequeue(spsc);
+        }
+        else
+        {
+            pthread_mutex_lock(&queue_mutex);
+            e = cadtqueue_dequeue(locked);
+            pthread_mutex_unlock(&queue_mutex);
+        }
+
+        if (e == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        i++;
+    }
+    pthread_join(thread, NULL);
+    end = bench_now_ns();
+
+    return (double) (end - start) / NITEMS;
+}
+
+int main(void)
+{
+    if ((spsc = cadtspscqueue_new(QUEUE_SIZE)) == NULL
+        || (locked = cadtqueue_new_circular(QUEUE_SIZE)) == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-8s %10s\n", "queue", "ns/item");
+    printf("%-8s %10.2f\n", "mutex", run(locked_producer, 0));
+    printf("%-8s %10.2f\n", "spsc", run(spsc_producer, 1));
+
+    cadtspscqueue_destroy(spsc);
+    cadtqueue_destroy(locked);
+
+    return EXIT_SUCCESS;
+}
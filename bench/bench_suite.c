@@ -0,0 +1,782 @@
+/*
+ * Measures the core operations of the stack, queue, deque and hash tables
+ * over working sets from L1-resident to far beyond the last level cache.
+ *
+ * Every operation is run over `n` elements at a time, a pass, repeated until
+ * at least `MIN_OPS` operations were run.  Each pass is timed in batches of
+ * `BATCH` operations, which give ns/op.  Evenly spaced batches, at most
+ * `LATENCY_BATCHES` of them, have their operations timed one by one instead,
+ * and the latency percentiles are those of these single operations.  The cost
+ * of reading the clock is measured once and subtracted from every batch and
+ * every single operation.  A single operation cannot overlap with its
+ * neighbours as it does within a batch, so p50 usually sits above ns/op.
+ *
+ * With `-p`, hardware counters are read around the batches of every pass and
+ * reported per operation.  They include the clock reads, two per batch and two
+ * per single operation timed.
+ *
+ * Usage: bench_suite [-o results.csv] [-b baseline.csv] [-t percent]
+ *                    [-m max MiB] [-f filter] [-p]
+ *
+ *  -o  Writes the results as CSV, the format `-b` reads back.
+ *  -b  Compares ns/op against a previous CSV, flagging any row slower by more
+ *      than `-t` percent, 10 by default.
+ *  -m  Skips working sets above this many MiB, 512 by default.
+ *  -f  Only runs the operations whose `adt/op` name contains the filter.
+ *  -p  Reads the hardware counters of bench.h, if perf events are available.
+ */
+#include "bench.h"
+#include "deque_adt.h"
+#include "flathashtable_adt.h"
+#include "hashing.h"
+#include "hashtable_adt.h"
+#include "queue_adt.h"
+#include "stack_adt.h"
+
+#include <string.h>
+#include <unistd.h>
+
+/* Operations timed between two clock reads */
+#define BATCH 32
+/* Batches timed operation by operation for the percentiles, at most */
+#define LATENCY_BATCHES 8192
+/* Operations timed for each operation and working set, at least */
+#define MIN_OPS (1 << 20)
+/* Working sets, from L1-resident up, eight times larger each */
+#define MIN_WS ((size_t) 16 << 10)
+#define NSIZES 6
+#define DEFAULT_MAX_MIB 512
+#define DEFAULT_THRESHOLD 10.0
+#define MAX_BASELINE 1024
+
+/*
+ * What every operation runs on.  Each pass builds the structure it needs, and
+ * releases it once the pass is over.
+ */
+struct state
+{
+    size_t n;
+    uint64_t *keys;     /* n keys, inserted in order */
+    uint64_t *order;    /* n of the keys, in random order */
+    uint64_t *absent;   /* n keys never inserted */
+    StackADT *stack;
+    QueueADT *queue;
+    DequeADT *deque;
+    HashTableADT *ht;
+    FlatHashTableADT *flat;
+};
+
+/*
+ * An operation to time.  `setup` and `teardown` run untimed around every pass,
+ * `run` performs the operations `from` to `to` of a pass.
+ */
+struct bench_case
+{
+    const char *adt;
+    const char *op;
+    /* Approximate bytes per element, to size the working sets */
+    size_t elem_bytes;
+    int needs_keys;
+    void (*setup)(struct state *st);
+    void (*run)(struct state *st, size_t from, size_t to);
+    void (*teardown)(struct state *st);
+};
+
+struct result
+{
+    size_t ws_bytes;
+    size_t nelems;
+    size_t nops;
+    double ns_per_op;
+    double p50;
+    double p99;
+    double p999;
+    /* Per operation, negative if not counted */
+    double counters[BENCH_NCOUNTERS];
+};
+
+struct baseline_row
+{
+    char adt[32];
+    char op[32];
+    size_t ws_bytes;
+    double ns_per_op;
+};
+
+/* Any non-NULL element will do */
+static char item;
+
+static BenchCounters counters;
+static int use_counters;
+
+static void fail(const char *msg)
+{
+    perror(msg);
+    exit(EXIT_FAILURE);
+}
+
+/****************************************************************** Stack */
+
+static void stack_empty(struct state *st)
+{
+    if ((st->stack = cadtstack_new(16)) == NULL)
+    {
+        fail("stack_empty");
+    }
+}
+
+static void stack_full(struct state *st)
+{
+    size_t i;
+
+    stack_empty(st);
+    for (i = 0; i < st->n; i++)
+    {
+        cadtstack_push(st->stack, &item);
+    }
+}
+
+static void stack_push(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        cadtstack_push(st->stack, &item);
+    }
+}
+
+static void stack_pop(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        bench_keep(cadtstack_pop(st->stack));
+    }
+}
+
+static void stack_destroy(struct state *st)
+{
+    cadtstack_destroy(st->stack);
+}
+
+/****************************************************************** Queue */
+
+static void queue_empty(struct state *st)
+{
+    if ((st->queue = cadtqueue_new(16)) == NULL)
+    {
+        fail("queue_empty");
+    }
+}
+
+static void queue_full(struct state *st)
+{
+    size_t i;
+
+    queue_empty(st);
+    for (i = 0; i < st->n; i++)
+    {
+        cadtqueue_enqueue(st->queue, &item);
+    }
+}
+
+static void queue_enqueue(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        cadtqueue_enqueue(st->queue, &item);
+    }
+}
+
+static void queue_dequeue(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        bench_keep(cadtqueue_dequeue(st->queue));
+    }
+}
+
+static void queue_destroy(struct state *st)
+{
+    cadtqueue_destroy(st->queue);
+}
+
+/****************************************************************** Deque */
+
+static void deque_empty(struct state *st)
+{
+    if ((st->deque = cadtdeque_new(16)) == NULL)
+    {
+        fail("deque_empty");
+    }
+}
+
+static void deque_full(struct state *st)
+{
+    size_t i;
+
+    deque_empty(st);
+    for (i = 0; i < st->n; i++)
+    {
+        cadtdeque_push_rear(st->deque, &item);
+    }
+}
+
+static void deque_push_front(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        cadtdeque_push_front(st->deque, &item);
+    }
+}
+
+static void deque_pop_rear(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        bench_keep(cadtdeque_pop_rear(st->deque));
+    }
+}
+
+static void deque_destroy(struct state *st)
+{
+    cadtdeque_destroy(st->deque);
+}
+
+/************************************************************* Hash table */
+
+static void ht_empty(struct state *st)
+{
+    if ((st->ht = cadthashtable_new(16, cadthash_int)) == NULL)
+    {
+        fail("ht_empty");
+    }
+}
+
+static void ht_full(struct state *st)
+{
+    size_t i;
+
+    ht_empty(st);
+    for (i = 0; i < st->n; i++)
+    {
+        cadthashtable_insert(st->ht, &st->keys[i], sizeof(uint64_t), &item);
+    }
+}
+
+static void ht_insert(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        cadthashtable_insert(st->ht, &st->keys[from], sizeof(uint64_t), &item);
+    }
+}
+
+static void ht_lookup(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        bench_keep(cadthashtable_lookup(st->ht, &st->order[from],
+                                        sizeof(uint64_t)));
+    }
+}
+
+static void ht_lookup_miss(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        bench_keep(cadthashtable_lookup(st->ht, &st->absent[from],
+                                        sizeof(uint64_t)));
+    }
+}
+
+static void ht_delete(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        bench_keep(cadthashtable_delete(st->ht, &st->keys[from],
+                                        sizeof(uint64_t), &item));
+    }
+}
+
+static void ht_destroy(struct state *st)
+{
+    cadthashtable_destroy(st->ht);
+}
+
+/******************************************************** Flat hash table */
+
+static void flat_empty(struct state *st)
+{
+    if ((st->flat = cadtflathashtable_new(16, cadthash_int)) == NULL)
+    {
+        fail("flat_empty");
+    }
+}
+
+static void flat_full(struct state *st)
+{
+    size_t i;
+
+    flat_empty(st);
+    for (i = 0; i < st->n; i++)
+    {
+        cadtflathashtable_insert(st->flat, &st->keys[i], sizeof(uint64_t),
+                                 &item);
+    }
+}
+
+static void flat_insert(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        cadtflathashtable_insert(st->flat, &st->keys[from], sizeof(uint64_t),
+                                 &item);
+    }
+}
+
+static void flat_lookup(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        bench_keep(cadtflathashtable_lookup(st->flat, &st->order[from],
+                                            sizeof(uint64_t)));
+    }
+}
+
+static void flat_lookup_miss(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        bench_keep(cadtflathashtable_lookup(st->flat, &st->absent[from],
+                                            sizeof(uint64_t)));
+    }
+}
+
+static void flat_delete(struct state *st, size_t from, size_t to)
+{
+    for (; from < to; from++)
+    {
+        bench_keep(cadtflathashtable_delete(st->flat, &st->keys[from],
+                                            sizeof(uint64_t), &item));
+    }
+}
+
+static void flat_destroy(struct state *st)
+{
+    cadtflathashtable_destroy(st->flat);
+}
+
+/*
+ * Stacks and queues hold a pointer per element.  Hash table entries also hold
+ * the key and the links, next to their bucket and the keys of the benchmark.
+ */
+static const struct bench_case cases[] =
+{
+    { "stack", "push", 8, 0, stack_empty, stack_push, stack_destroy },
+    { "stack", "pop", 8, 0, stack_full, stack_pop, stack_destroy },
+    { "queue", "enqueue", 8, 0, queue_empty, queue_enqueue, queue_destroy },
+    { "queue", "dequeue", 8, 0, queue_full, queue_dequeue, queue_destroy },
+    { "deque", "push_front", 8, 0, deque_empty, deque_push_front, deque_destroy },
+    { "deque", "pop_rear", 8, 0, deque_full, deque_pop_rear, deque_destroy },
+    { "hashtable", "insert", 64, 1, ht_empty, ht_insert, ht_destroy },
+    { "hashtable", "lookup", 64, 1, ht_full, ht_lookup, ht_destroy },
+    { "hashtable", "lookup_miss", 64, 1, ht_full, ht_lookup_miss, ht_destroy },
+    { "hashtable", "delete", 64, 1, ht_full, ht_delete, ht_destroy },
+    { "flathash", "insert", 64, 1, flat_empty, flat_insert, flat_destroy },
+    { "flathash", "lookup", 64, 1, flat_full, flat_lookup, flat_destroy },
+    { "flathash", "lookup_miss", 64, 1, flat_full, flat_lookup_miss, flat_destroy },
+    { "flathash", "delete", 64, 1, flat_full, flat_delete, flat_destroy },
+};
+
+#define NCASES (sizeof(cases) / sizeof(cases[0]))
+
+/*
+ * Returns the smallest delay between two clock reads, out of many.
+ */
+static double clock_overhead_ns(void)
+{
+    uint64_t best = UINT64_MAX;
+    int i;
+
+    for (i = 0; i < 10000; i++)
+    {
+        uint64_t start = bench_now_ns();
+        uint64_t end = bench_now_ns();
+
+        if (end - start < best)
+        {
+            best = end - start;
+        }
+    }
+    return (double) best;
+}
+
+/*
+ * Allocates the keys of `st`, inserted keys and absent ones drawn from two
+ * streams of a generator that never repeats a value within its period.
+ */
+static void make_keys(struct state *st)
+{
+    uint64_t present = 0x243f6a8885a308d3u, missing = 0x13198a2e03707344u;
+    size_t i;
+
+    if ((st->keys = malloc(st->n * sizeof(uint64_t))) == NULL
+        || (st->order = malloc(st->n * sizeof(uint64_t))) == NULL
+        || (st->absent = malloc(st->n * sizeof(uint64_t))) == NULL)
+    {
+        fail("make_keys malloc failed allocating keys");
+    }
+    for (i = 0; i < st->n; i++)
+    {
+        st->keys[i] = bench_rand(&present);
+        st->absent[i] = bench_rand(&missing);
+    }
+    /* Random lookup order, so the hardware prefetcher cannot help */
+    for (i = 0; i < st->n; i++)
+    {
+        st->order[i] = st->keys[bench_rand(&present) % st->n];
+    }
+}
+
+static void free_keys(struct state *st)
+{
+    free(st->keys);
+    free(st->order);
+    free(st->absent);
+}
+
+/*
+ * Times the operations `from` to `to` of a pass of `c` one by one, appending
+ * their latencies to `samples`.  Returns how many.
+ */
+static size_t time_single_ops(const struct bench_case *c, struct state *st,
+                              size_t from, size_t to, double overhead,
+                              double *samples)
+{
+    size_t i;
+
+    for (i = from; i < to; i++)
+    {
+        uint64_t start = bench_now_ns();
+        double ns;
+
+        c->run(st, i, i + 1);
+        ns = (double) (bench_now_ns() - start) - overhead;
+        samples[i - from] = (ns > 0.0) ? ns : 0.0;
+    }
+    return to - from;
+}
+
+/*
+ * Times `c` over a working set of `ws_bytes` bytes.
+ */
+static struct result run_case(const struct bench_case *c, size_t ws_bytes,
+                              double overhead)
+{
+    struct state st = { 0 };
+    struct result r;
+    size_t npasses, nbatches, stride, batch = 0, batched_ops = 0;
+    size_t nsamples = 0, pass, i;
+    double *samples, total_ns = 0.0;
+
+    st.n = ws_bytes / c->elem_bytes;
+    npasses = (MIN_OPS + st.n - 1) / st.n;
+    /* At least MIN_OPS / BATCH batches, so most are still timed as batches */
+    nbatches = npasses * ((st.n + BATCH - 1) / BATCH);
+    stride = nbatches / LATENCY_BATCHES + 1;
+    if (c->needs_keys)
+    {
+        make_keys(&st);
+    }
+    if ((samples = malloc((size_t) LATENCY_BATCHES * BATCH
+                          * sizeof(double))) == NULL)
+    {
+        fail("run_case malloc failed allocating samples");
+    }
+
+    bench_counters_reset(&counters);
+    for (pass = 0; pass < npasses; pass++)
+    {
+        c->setup(&st);
+        if (use_counters)
+        {
+            bench_counters_start(&counters);
+        }
+        for (i = 0; i < st.n; i += BATCH)
+        {
+            size_t to = (i + BATCH < st.n) ? (i + BATCH) : st.n;
+            uint64_t start;
+            double ns;
+
+            if (batch++ % stride == 0)
+            {
+                nsamples += time_single_ops(c, &st, i, to, overhead,
+                                            &samples[nsamples]);
+                continue;
+            }
+            start = bench_now_ns();
+            c->run(&st, i, to);
+            ns = (double) (bench_now_ns() - start) - overhead;
+            total_ns += (ns > 0.0) ? ns : 0.0;
+            batched_ops += to - i;
+        }
+        if (use_counters)
+        {
+            bench_counters_stop(&counters);
+        }
+        c->teardown(&st);
+    }
+
+    qsort(samples, nsamples, sizeof(double), bench_cmp_double);
+    r.ws_bytes = ws_bytes;
+    r.nelems = st.n;
+    r.nops = npasses * st.n;
+    r.ns_per_op = total_ns / (double) batched_ops;
+    r.p50 = bench_quantile(samples, nsamples, 0.50);
+    r.p99 = bench_quantile(samples, nsamples, 0.99);
+    r.p999 = bench_quantile(samples, nsamples, 0.999);
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        r.counters[i] = (use_counters && counters.fds[i] >= 0)
+                        ? counters.counts[i] / (double) r.nops : -1.0;
+    }
+
+    free(samples);
+    if (c->needs_keys)
+    {
+        free_keys(&st);
+    }
+    return r;
+}
+
+/*
+ * Reads the rows of a CSV written with `-o`, returns how many.
+ */
+static size_t read_baseline(const char *path, struct baseline_row *rows)
+{
+    FILE *f;
+    char line[512];
+    size_t n = 0;
+
+    if ((f = fopen(path, "r")) == NULL)
+    {
+        fail("read_baseline fopen failed");
+    }
+    while (n < MAX_BASELINE && fgets(line, sizeof(line), f) != NULL)
+    {
+        struct baseline_row *row = &rows[n];
+
+        if (sscanf(line, "%31[^,],%31[^,],%zu,%*u,%*u,%lf", row->adt, row->op,
+                   &row->ws_bytes, &row->ns_per_op) == 4)
+        {
+            n++;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+static const struct baseline_row *find_baseline(const struct baseline_row *rows,
+                                                size_t nrows,
+                                                const struct bench_case *c,
+                                                size_t ws_bytes)
+{
+    size_t i;
+
+    for (i = 0; i < nrows; i++)
+    {
+        if (rows[i].ws_bytes == ws_bytes && strcmp(rows[i].adt, c->adt) == 0
+            && strcmp(rows[i].op, c->op) == 0)
+        {
+            return &rows[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Prints `bytes` as KiB, MiB or GiB.
+ */
+static void print_size(size_t bytes)
+{
+    if (bytes >= (size_t) 1 << 30)
+    {
+        printf("%6zuG", bytes >> 30);
+    }
+    else if (bytes >= (size_t) 1 << 20)
+    {
+        printf("%6zuM", bytes >> 20);
+    }
+    else
+    {
+        printf("%6zuK", bytes >> 10);
+    }
+}
+
+/*
+ * Prints the counters of `r` per operation, a dash for those not counted.
+ */
+static void print_counters(const struct result *r)
+{
+    int i;
+
+    if (!use_counters)
+    {
+        return;
+    }
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        if (r->counters[i] < 0.0)
+        {
+            printf(" %8s", "-");
+            continue;
+        }
+        printf(" %8.2f", r->counters[i]);
+    }
+}
+
+/*
+ * Writes `r` as a CSV row, leaving the counters not counted empty.
+ */
+static void write_csv_row(FILE *out, const struct bench_case *c,
+                          const struct result *r)
+{
+    int i;
+
+    fprintf(out, "%s,%s,%zu,%zu,%zu,%.3f,%.0f,%.3f,%.3f,%.3f", c->adt, c->op,
+            r->ws_bytes, r->nelems, r->nops, r->ns_per_op, 1e9 / r->ns_per_op,
+            r->p50, r->p99, r->p999);
+    for (i = 0; i < BENCH_NCOUNTERS; i++)
+    {
+        if (r->counters[i] < 0.0)
+        {
+            fprintf(out, ",");
+            continue;
+        }
+        fprintf(out, ",%.4f", r->counters[i]);
+    }
+    fprintf(out, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+    static struct baseline_row baseline[MAX_BASELINE];
+    const char *out_path = NULL, *base_path = NULL, *filter = NULL;
+    double threshold = DEFAULT_THRESHOLD, overhead;
+    size_t max_bytes = (size_t) DEFAULT_MAX_MIB << 20, nbase = 0, i, s;
+    int opt, nslower = 0;
+    FILE *out = NULL;
+
+    while ((opt = getopt(argc, argv, "o:b:t:m:f:p")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o': out_path = optarg; break;
+        case 'b': base_path = optarg; break;
+        case 't': threshold = atof(optarg); break;
+        case 'm': max_bytes = (size_t) strtoul(optarg, NULL, 10) << 20; break;
+        case 'f': filter = optarg; break;
+        case 'p': use_counters = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-o results.csv] [-b baseline.csv] "
+                    "[-t percent] [-m max MiB] [-f filter] [-p]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (base_path != NULL)
+    {
+        nbase = read_baseline(base_path, baseline);
+    }
+    if (use_counters && bench_counters_open(&counters) == 0)
+    {
+        printf("hardware counters unavailable (%s), timings only\n",
+               strerror(errno));
+        use_counters = 0;
+    }
+    if (out_path != NULL)
+    {
+        if ((out = fopen(out_path, "w")) == NULL)
+        {
+            fail("main fopen failed");
+        }
+        fprintf(out, "adt,op,ws_bytes,nelems,ops,ns_per_op,ops_per_sec,"
+                "p50_ns,p99_ns,p999_ns");
+        for (i = 0; i < BENCH_NCOUNTERS; i++)
+        {
+            fprintf(out, ",%s_per_op", bench_counter_names[i]);
+        }
+        fprintf(out, "\n");
+    }
+
+    overhead = clock_overhead_ns();
+    printf("clock read: %.0f ns, subtracted from every batch of %d ops and "
+           "every single op timed for p50/p99/p999\n", overhead, BATCH);
+    printf("%-10s %-12s %7s %10s %8s %9s %8s %8s %8s", "adt", "op", "ws",
+           "nelems", "ns/op", "Mops/s", "p50", "p99", "p999");
+    if (use_counters)
+    {
+        printf(" %8s %8s %8s %8s %8s", "cyc/op", "ins/op", "llc/op", "dtlb/op",
+               "brm/op");
+    }
+    printf("%s\n", nbase != 0 ? "   vs base" : "");
+
+    for (i = 0; i < NCASES; i++)
+    {
+        const struct bench_case *c = &cases[i];
+        char name[64];
+
+        snprintf(name, sizeof(name), "%s/%s", c->adt, c->op);
+        if (filter != NULL && strstr(name, filter) == NULL)
+        {
+            continue;
+        }
+        for (s = 0; s < NSIZES; s++)
+        {
+            size_t ws_bytes = MIN_WS << (3 * s);
+            const struct baseline_row *base;
+            struct result r;
+
+            if (ws_bytes > max_bytes)
+            {
+                break;
+            }
+            r = run_case(c, ws_bytes, overhead);
+
+            printf("%-10s %-12s ", c->adt, c->op);
+            print_size(ws_bytes);
+            printf(" %10zu %8.2f %9.2f %8.2f %8.2f %8.2f", r.nelems,
+                   r.ns_per_op, 1e3 / r.ns_per_op, r.p50, r.p99, r.p999);
+            print_counters(&r);
+            base = find_baseline(baseline, nbase, c, ws_bytes);
+            if (base != NULL && base->ns_per_op > 0.0)
+            {
+                double delta = (r.ns_per_op / base->ns_per_op - 1.0) * 100.0;
+
+                printf(" %+8.1f%%%s", delta, delta > threshold ? " !" : "");
+                nslower += delta > threshold;
+            }
+            printf("\n");
+            fflush(stdout);
+
+            if (out != NULL)
+            {
+                write_csv_row(out, c, &r);
+            }
+        }
+    }
+
+    if (nbase != 0)
+    {
+        printf("%d result(s) slower than the baseline by more than %.1f%%\n",
+               nslower, threshold);
+    }
+    if (out != NULL)
+    {
+        fclose(out);
+    }
+    if (use_counters)
+    {
+        bench_counters_close(&counters);
+    }
+    return EXIT_SUCCESS;
+}
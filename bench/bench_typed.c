@@ -0,0 +1,273 @@
+/*
+ * Compares the containers of typed_adt.h against the `Element` ones, on
+ * `uint32_t` elements and 16-byte values.  The `Element` containers hold a
+ * pointer to each value, allocated on its own, as a client storing values
+ * would have to.
+ */
+#include "bench.h"
+#include "flathashtable_adt.h"
+#include "hashing.h"
+#include "queue_adt.h"
+#include "stack_adt.h"
+#include "typed_adt.h"
+
+#define NITEMS (1 << 20)
+#define NKEYS (1 << 20)
+#define NLOOKUPS (1 << 22)
+
+typedef struct point
+{
+    double x;
+    double y;
+} Point;
+
+static size_t hash_u32(const uint32_t *key)
+{
+    return *key;
+}
+
+static int eq_u32(const uint32_t *a, const uint32_t *b)
+{
+    return *a == *b;
+}
+
+CADT_STACK_DEFINE(U32Stack, uint32_t);
+CADT_QUEUE_DEFINE(U32Queue, uint32_t);
+CADT_HASHTABLE_DEFINE(PointMap, uint32_t, Point, hash_u32, eq_u32);
+
+static uint32_t *new_u32(uint32_t value)
+{
+    uint32_t *p;
+
+    if ((p = malloc(sizeof(*p))) == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    *p = value;
+    return p;
+}
+
+/*
+ * Returns the nanoseconds per item pushed then popped.
+ */
+static double run_stack(int typed)
+{
+    StackADT *s = NULL;
+    U32Stack *ts = NULL;
+    uint32_t *p, sum = 0;
+    uint64_t start, end;
+    uint32_t i;
+
+    if ((typed && (ts = U32Stack_new(16)) == NULL)
+        || (!typed && (s = cadtstack_new(16)) == NULL))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    start = bench_now_ns();
+    for (i = 0; i < NITEMS; i++)
+    {
+        if (typed)
+        {
+            U32Stack_push(ts, i);
+            continue;
+        }
+        cadtstack_push(s, new_u32(i));
+    }
+    for (i = 0; i < NITEMS; i++)
+    {
+        if (typed)
+        {
+            sum += *U32Stack_pop(ts);
+            continue;
+        }
+        p = cadtstack_pop(s);
+        sum += *p;
+        free(p);
+    }
+    end = bench_now_ns();
+    bench_keep(sum);
+
+    if (typed)
+    {
+        U32Stack_destroy(ts);
+    }
+    else
+    {
+        cadtstack_destroy(s);
+    }
+
+    return (double) (end - start) / NITEMS;
+}
+
+/*
+ * Returns the nanoseconds per item enqueued then dequeued.
+ */
+static double run_queue(int typed)
+{
+    QueueADT *q = NULL;
+    U32Queue *tq = NULL;
+    uint32_t *p, sum = 0;
+    uint64_t start, end;
+    uint32_t i;
+
+    if ((typed && (tq = U32Queue_new(16)) == NULL)
+        || (!typed && (q = cadtqueue_new(16)) == NULL))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    start = bench_now_ns();
+    for (i = 0; i < NITEMS; i++)
+    {
+        if (typed)
+        {
+            U32Queue_enqueue(tq, i);
+            continue;
+        }
+        cadtqueue_enqueue(q, new_u32(i));
+    }
+    for (i = 0; i < NITEMS; i++)
+    {
+        if (typed)
+        {
+            sum += *U32Queue_dequeue(tq);
+            continue;
+        }
+        p = cadtqueue_dequeue(q);
+        sum += *p;
+        free(p);
+    }
+    end = bench_now_ns();
+    bench_keep(sum);
+
+    if (typed)
+    {
+        U32Queue_destroy(tq);
+    }
+    else
+    {
+        cadtqueue_destroy(q);
+    }
+
+    return (double) (end - start) / NITEMS;
+}
+
+/*
+ * Fills a table with `NKEYS` points, then returns the nanoseconds per random
+ * lookup reading the point found.
+ */
+static double run_hashtable(int typed, const uint32_t *keys,
+                            const uint32_t *order)
+{
+    FlatHashTableADT *ht = NULL;
+    PointMap *tht = NULL;
+    Point p, *found, **values = NULL;
+    double sum = 0;
+    uint64_t start, end;
+    size_t i;
+
+    if (typed)
+    {
+        tht = PointMap_new(NKEYS);
+    }
+    else
+    {
+        ht = cadtflathashtable_new(NKEYS, cadthash_int);
+        values = malloc(NKEYS * sizeof(*values));
+    }
+    if (typed ? tht == NULL : ht == NULL || values == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < NKEYS; i++)
+    {
+        p.x = (double) i;
+        p.y = (double) keys[i];
+        if (typed)
+        {
+            PointMap_insert(tht, keys[i], p);
+            continue;
+        }
+        if ((values[i] = malloc(sizeof(Point))) == NULL)
+        {
+            exit(EXIT_FAILURE);
+        }
+        *values[i] = p;
+        cadtflathashtable_insert(ht, &keys[i], sizeof(*keys), values[i]);
+    }
+
+    start = bench_now_ns();
+    for (i = 0; i < NLOOKUPS; i++)
+    {
+        found = typed
+                    ? PointMap_lookup(tht, order[i])
+                    : cadtflathashtable_lookup(ht, &order[i], sizeof(*order));
+        sum += found->x;
+    }
+    end = bench_now_ns();
+    bench_keep((size_t) sum);
+
+    if (typed)
+    {
+        PointMap_destroy(tht);
+    }
+    else
+    {
+        for (i = 0; i < NKEYS; i++)
+        {
+            free(values[i]);
+        }
+        free(values);
+        cadtflathashtable_destroy(ht);
+    }
+
+    return (double) (end - start) / NLOOKUPS;
+}
+
+int main(void)
+{
+    uint32_t *keys, *order;
+    uint64_t state = 0x243f6a8885a308d3u;
+    double elem, typed;
+    size_t i;
+
+    if ((keys = malloc(NKEYS * sizeof(*keys))) == NULL
+        || (order = malloc(NLOOKUPS * sizeof(*order))) == NULL)
+    {
+        perror("main malloc failed allocating keys");
+        exit(EXIT_FAILURE);
+    }
+    /* Distinct keys: the multiplier is odd, so i -> i * m is a bijection */
+    for (i = 0; i < NKEYS; i++)
+    {
+        keys[i] = (uint32_t) i * 2654435761u;
+    }
+    for (i = 0; i < NLOOKUPS; i++)
+    {
+        order[i] = keys[bench_rand(&state) % NKEYS];
+    }
+
+    printf("%-10s %-16s %14s %14s %8s\n", "container", "op", "Element ns/op",
+           "typed ns/op", "speedup");
+
+    elem = run_stack(0);
+    typed = run_stack(1);
+    printf("%-10s %-16s %14.2f %14.2f %7.1fx\n", "stack", "push+pop", elem,
+           typed, elem / typed);
+
+    elem = run_queue(0);
+    typed = run_queue(1);
+    printf("%-10s %-16s %14.2f %14.2f %7.1fx\n", "queue", "enqueue+dequeue",
+           elem, typed, elem / typed);
+
+    elem = run_hashtable(0, keys, order);
+    typed = run_hashtable(1, keys, order);
+    printf("%-10s %-16s %14.2f %14.2f %7.1fx\n", "hashtable", "lookup", elem,
+           typed, elem / typed);
+
+    free(order);
+    free(keys);
+
+    return EXIT_SUCCESS;
+}
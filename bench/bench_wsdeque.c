@@ -0,0 +1,229 @@
+/*
+ * Measures a fork-join computation, a task-parallel Fibonacci, scheduled by
+ * workers each owning a `WSDequeADT` and stealing from one another, against
+ * workers sharing a single `StackADT` behind a mutex, from one thread up to
+ * the number of cores.
+ */
+#include "bench.h"
+#include "stack_adt.h"
+#include "wsdeque_adt.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define FIB_N 40
+/* Tasks for smaller numbers are computed serially, in a single task */
+#define FIB_CUTOFF 22
+#define MAX_THREADS 64
+
+static WSDequeADT *deques[MAX_THREADS];
+static StackADT *locked;
+static pthread_mutex_t stack_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t start_barrier;
+static size_t nworkers;
+
+/* Tasks pushed and not yet run, workers stop once it drops to zero */
+static size_t npending;
+
+struct worker_args
+{
+    size_t id;
+    int use_ws;
+    uint64_t sum;
+};
+
+/*
+ * A task computes the Fibonacci number of `n`, encoded as `n + 1` so that no
+ * task is `NULL`.
+ */
+static inline Element task_of(unsigned n)
+{
+    return (Element) (uintptr_t) (n + 1);
+}
+
+static uint64_t fib(unsigned n)
+{
+    return (n < 2) ? n : fib(n - 1) + fib(n - 2);
+}
+
+static void push(struct worker_args *args, unsigned n)
+{
+    if (args->use_ws)
+    {
+        cadtwsdeque_push(deques[args->id], task_of(n));
+        return;
+    }
+    pthread_mutex_lock(&stack_mutex);
+    cadtstack_push(locked, task_of(n));
+    pthread_mutex_unlock(&stack_mutex);
+}
+
+/*
+ * Returns a task from the worker's own deque, or stolen from the others, or
+ * from the shared stack.  `NULL` if none was found.
+ */
+static Element take(struct worker_args *args, uint64_t *seed)
+{
+    Element task;
+    size_t i, victim;
+
+    if (!args->use_ws)
+    {
+        pthread_mutex_lock(&stack_mutex);
+        task = cadtstack_pop(locked);
+        pthread_mutex_unlock(&stack_mutex);
+        return task;
+    }
+    if ((task = cadtwsdeque_pop(deques[args->id])) != NULL)
+    {
+        return task;
+    }
+    /* starting at a random victim spreads the thieves */
+    victim = (size_t) bench_rand(seed) % nworkers;
+    for (i = 0; i < nworkers; i++, victim = (victim + 1) % nworkers)
+    {
+        if (victim != args->id
+            && (task = cadtwsdeque_steal(deques[victim])) != NULL)
+        {
+            return task;
+        }
+    }
+    return NULL;
+}
+
+static void *worker(void *arg)
+{
+    struct worker_args *args = arg;
+    uint64_t seed = 0x9e3779b97f4a7c15u + args->id;
+    Element task;
+
+    pthread_barrier_wait(&start_barrier);
+    while (__atomic_load_n(&npending, __ATOMIC_ACQUIRE) != 0)
+    {
+        unsigned n;
+
+        if ((task = take(args, &seed)) == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        n = (unsigned) ((uintptr_t) task - 1);
+        if (n <= FIB_CUTOFF)
+        {
+            args->sum += fib(n);
+            __atomic_fetch_sub(&npending, 1, __ATOMIC_RELEASE);
+            continue;
+        }
+        /* fork: one task becomes two */
+        __atomic_fetch_add(&npending, 1, __ATOMIC_RELAXED);
+        push(args, n - 2);
+        push(args, n - 1);
+    }
+    return NULL;
+}
+
+/*
+ * Returns the seconds `nthreads` workers take to compute the Fibonacci number
+ * of `FIB_N`, and checks it against `expected`.
+ */
+static double run(size_t nthreads, int use_ws, uint64_t expected)
+{
+    pthread_t threads[MAX_THREADS];
+    struct worker_args args[MAX_THREADS];
+    uint64_t start, end, sum = 0;
+    size_t i;
+
+    nworkers = nthreads;
+    npending = 1;
+    if (use_ws)
+    {
+        cadtwsdeque_push(deques[0], task_of(FIB_N));
+    }
+    else
+    {
+        cadtstack_push(locked, task_of(FIB_N));
+    }
+
+    pthread_barrier_init(&start_barrier, NULL, (unsigned) (nthreads + 1));
+    for (i = 0; i < nthreads; i++)
+    {
+        args[i].id = i;
+        args[i].use_ws = use_ws;
+        args[i].sum = 0;
+        if (pthread_create(&threads[i], NULL, worker, &args[i]) != 0)
+        {
+            perror("run pthread_create failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    pthread_barrier_wait(&start_barrier);
+    start = bench_now_ns();
+    for (i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+        sum += args[i].sum;
+    }
+    end = bench_now_ns();
+    pthread_barrier_destroy(&start_barrier);
+
+    if (sum != expected)
+    {
+        fprintf(stderr, "run: fib(%d) = %llu, expected %llu\n", FIB_N,
+                (unsigned long long) sum, (unsigned long long) expected);
+        exit(EXIT_FAILURE);
+    }
+
+    return (double) (end - start) / 1e9;
+}
+
+int main(void)
+{
+    long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t maxthreads = ncores < 1 ? 1 : ncores > MAX_THREADS ? MAX_THREADS
+                                                              : (size_t) ncores;
+    size_t nthreads, i;
+    uint64_t start, expected;
+    double serial, ws, mutex;
+
+    for (i = 0; i < maxthreads; i++)
+    {
+        if ((deques[i] = cadtwsdeque_new(64)) == NULL)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+    if ((locked = cadtstack_new(64)) == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    start = bench_now_ns();
+    expected = fib(FIB_N);
+    serial = (double) (bench_now_ns() - start) / 1e9;
+    printf("fib(%d), serial %.3f s\n", FIB_N, serial);
+
+    printf("%-8s %12s %12s %12s %12s\n", "threads", "mutex s", "speedup",
+           "ws-deque s", "speedup");
+    /* Powers of two, then the core count itself */
+    for (nthreads = 1; ; nthreads = nthreads * 2 < maxthreads ? nthreads * 2
+                                                              : maxthreads)
+    {
+        mutex = run(nthreads, 0, expected);
+        ws = run(nthreads, 1, expected);
+        printf("%-8zu %12.3f %12.2f %12.3f %12.2f\n", nthreads, mutex,
+               serial / mutex, ws, serial / ws);
+        if (nthreads == maxthreads)
+        {
+            break;
+        }
+    }
+
+    for (i = 0; i < maxthreads; i++)
+    {
+        cadtwsdeque_destroy(deques[i]);
+    }
+    cadtstack_destroy(locked);
+
+    return EXIT_SUCCESS;
+}
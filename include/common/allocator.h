@@ -0,0 +1,152 @@
+/**
+ * @file allocator.h
+ * @brief The client-defined allocator type, common to the stack, the queue,
+ * the deque and the two single-threaded hash tables.
+ *
+ * An object created with an allocator makes every one of its allocations
+ * through it, and keeps its own copy of the `Allocator` structure.  The
+ * functions are handed the size of every block they free or reallocate, so
+ * that arena or size-class allocators need not record it, and so that a
+ * client can account for the memory of each object.
+ *
+ * Objects created without an allocator use @ref CADT_ALLOCATOR_DEFAULT, which
+ * forwards to `malloc`, `realloc` and `free`.
+ *
+ * The concurrent containers take no allocator.  Most of their blocks would do
+ * with the alignment `malloc` gives, but the functions of an `Allocator` need
+ * not be thread-safe: the concurrent hash table allocates entries and the
+ * lock-free stack allocates chunks from any thread at once.  The SPSC, MPMC
+ * and work-stealing queues only allocate from one thread, yet their objects
+ * must start on a cache line, which an `Allocator` does not promise, and an
+ * object split between two allocators would break the rule above.
+ */
+
+#ifndef ADT_ALLOCATOR_H
+#define ADT_ALLOCATOR_H
+
+/** @cond */
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+/** @endcond */
+
+/**
+ * @brief A set of allocation functions and the context they are called with.
+ *
+ * All three functions are required.  `alloc` and `realloc` return `NULL` on
+ * failure, `realloc` then leaving the block untouched.  Blocks only need the
+ * alignment `malloc` would give them.
+ */
+typedef struct allocator
+{
+    /** Returns a block of `size` bytes. */
+    void *(*alloc)(void *ctx, size_t size);
+    /** Resizes the block `ptr` of `old_size` bytes to `new_size` bytes. */
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+    /** Releases the block `ptr` of `size` bytes. */
+    void (*free)(void *ctx, void *ptr, size_t size);
+    /** Passed as is to every function. */
+    void *ctx;
+} Allocator;
+
+/** @cond */
+static inline void *cadt_system_alloc(void *ctx, size_t size)
+{
+    (void) ctx;
+    return malloc(size);
+}
+
+static inline void *cadt_system_realloc(void *ctx, void *ptr, size_t old_size,
+                                        size_t new_size)
+{
+    (void) ctx;
+    (void) old_size;
+    return realloc(ptr, new_size);
+}
+
+static inline void cadt_system_free(void *ctx, void *ptr, size_t size)
+{
+    (void) ctx;
+    (void) size;
+    free(ptr);
+}
+/** @endcond */
+
+/**
+ * @brief Initializer for the default allocator, the system's `malloc`,
+ * `realloc` and `free`.
+ */
+#define CADT_ALLOCATOR_DEFAULT \
+    { cadt_system_alloc, cadt_system_realloc, cadt_system_free, NULL }
+
+/** @cond */
+/*
+ * Returns non-zero if `a` has all three functions.
+ */
+static inline int cadt_is_valid_allocator(const Allocator *a)
+{
+    return a->alloc != NULL && a->realloc != NULL && a->free != NULL;
+}
+
+/*
+ * The wrappers below set `errno` to `ENOMEM` on failure, as `malloc` does,
+ * whatever the client's functions do.
+ */
+static inline void *cadt_alloc(const Allocator *a, size_t size)
+{
+    void *p = a->alloc(a->ctx, size);
+
+    if (p == NULL)
+    {
+        errno = ENOMEM;
+    }
+    return p;
+}
+
+/*
+ * Returns a zeroed block of `n` items of `size` bytes, `NULL` on failure or if
+ * the product overflows.
+ */
+static inline void *cadt_calloc(const Allocator *a, size_t n, size_t size)
+{
+    void *p;
+
+    if (size != 0 && n > SIZE_MAX / size)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if ((p = cadt_alloc(a, n * size)) != NULL)
+    {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+static inline void *cadt_realloc(const Allocator *a, void *ptr, size_t old_size,
+                                 size_t new_size)
+{
+    void *p = a->realloc(a->ctx, ptr, old_size, new_size);
+
+    if (p == NULL)
+    {
+        errno = ENOMEM;
+    }
+    return p;
+}
+
+/*
+ * Releases `ptr`, doing nothing if it is `NULL`.
+ */
+static inline void cadt_free(const Allocator *a, void *ptr, size_t size)
+{
+    if (ptr != NULL)
+    {
+        a->free(a->ctx, ptr, size);
+    }
+}
+/** @endcond */
+
+#endif
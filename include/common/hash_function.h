@@ -0,0 +1,53 @@
+/**
+ * @file hash_function.h
+ * @brief The client-defined hash function type, common to the hash tables,
+ * and the mixer the flat and concurrent tables run its results through.
+ */
+
+#ifndef ADT_HASH_FUNCTION_H
+#define ADT_HASH_FUNCTION_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+/**
+ * @brief Typedef for a _generic_ client-defined hash function.
+ *
+ * The `HashFunction` type is used to define generic hash functions that treats
+ * the parameter pointer as pointing to some data of a given size. 
+ * This allows the client side to define a custom hash function that operates on 
+ * data as a __region in memory__, whose size is determined by the second 
+ * parameter.
+ *
+ * @note The implementation stores a copy of the keys when elements are 
+ * inserted, so it's crucial to define the `HashFunction` function properly to
+ * ensure correct key retrieval and hashing behavior.
+ *
+ * @param data Pointer to the data to be hashed, treated as a region in memory.
+ * @param size The size of the data pointed to by data.
+ * @return The hash value generated by the hash function.
+ *
+ */
+typedef size_t HashFunction(const void*, size_t);
+
+/** @cond */
+/*
+ * Spreads the entropy of a client hash over all of its bits, for the tables
+ * that take more than one index from it: the tag and the group of the flat
+ * table, the bucket and the stripe of the concurrent one.
+ */
+static inline size_t cadt_hash_mix(size_t hash)
+{
+    uint64_t h = (uint64_t) hash;
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+
+    return (size_t) h;
+}
+/** @endcond */
+
+#endif
@@ -0,0 +1,31 @@
+/**
+ * @file inline.h
+ * @brief The `CADT_INLINE` build mode, and the attribute that keeps the slow
+ * paths out of line.
+ *
+ * With `CADT_INLINE` defined before including stack_adt.h or queue_adt.h, the
+ * push, pop, enqueue, dequeue and `_nelems` calls of the including file are
+ * compiled `static inline` into it, from stack_adt_inline.h and
+ * queue_adt_inline.h.  Only their common case is inlined.  Whatever resizes,
+ * links a segment or fails is handed to the function of the library, which
+ * stays out of line.  The library is linked in either mode, and must be built
+ * with the same `CADT_STATS` setting as its clients.
+ */
+
+#ifndef ADT_INLINE_H
+#define ADT_INLINE_H
+
+/** @cond */
+/*
+ * Keeps rare paths, such as resizes, out of the functions they are called
+ * from, even across translation units with link-time optimization, and
+ * quiets the warnings for unused ones.
+ */
+#if defined(__GNUC__)
+#define CADT_SLOW_PATH __attribute__((noinline, cold, unused))
+#else
+#define CADT_SLOW_PATH
+#endif
+/** @endcond */
+
+#endif
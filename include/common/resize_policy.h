@@ -0,0 +1,120 @@
+/**
+ * @file resize_policy.h
+ * @brief How a dynamic container grows and shrinks, common to the stack, the
+ * queue and the deque.
+ *
+ * A dynamic container grows by `growth` when it is full, and shrinks by the
+ * same factor when its usage falls below `shrink_usage`.  Keeping
+ * `shrink_usage * growth` below one leaves a gap between both thresholds, so a
+ * workload oscillating around either of them never reallocates twice in a row.
+ */
+
+#ifndef ADT_RESIZE_POLICY_H
+#define ADT_RESIZE_POLICY_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+/**
+ * @brief The growth and shrink settings of a dynamic container.
+ *
+ * A policy is valid when `growth` is greater than one, `shrink_usage` is not
+ * negative and `shrink_usage * growth` is less than one.
+ */
+typedef struct resize_policy
+{
+    /** Factor the size is multiplied by when full, greater than one. */
+    double growth;
+    /** Usage below which the size is divided by `growth`, zero never shrinks. */
+    double shrink_usage;
+    /** Size never shrunk below, zero for the size given at creation. */
+    size_t min_size;
+    /** If non-zero, removals never shrink, only an explicit trim does. */
+    int lazy;
+} ResizePolicy;
+
+/**
+ * @brief Initializer for the default policy: double when full, halve below 25%
+ * usage, never below the size given at creation.
+ */
+#define CADT_RESIZE_POLICY_DEFAULT { 2.0, 0.25, 0, 0 }
+
+/** @cond */
+/*
+ * The policy arithmetic shared by the containers.  `lowest` is the size a
+ * container never shrinks below, see `cadt_policy_floor`.
+ */
+
+/*
+ * Returns non-zero if `p` grows and shrinks with a gap between both
+ * thresholds.
+ */
+static inline int cadt_policy_is_valid(const ResizePolicy *p)
+{
+    return p->growth > 1.0 && p->shrink_usage >= 0.0
+           && p->shrink_usage * p->growth < 1.0;
+}
+
+/*
+ * Returns the size never shrunk below, for a container created with
+ * `min_size` elements.
+ */
+static inline size_t cadt_policy_floor(const ResizePolicy *p, size_t min_size)
+{
+    return (p->min_size != 0) ? p->min_size : min_size;
+}
+
+/*
+ * Returns the number of elements below which a removal shrinks an array of
+ * `size` elements, that is the usage threshold rounded up.  Zero if it never
+ * shrinks: under a lazy policy, or at its lowest already.
+ */
+static inline size_t cadt_policy_shrink_threshold(const ResizePolicy *p,
+                                                  size_t size, size_t lowest)
+{
+    double threshold = p->shrink_usage * (double) size;
+    size_t n = (size_t) threshold;
+
+    if (p->lazy || size <= lowest)
+    {
+        return 0;
+    }
+    return ((double) n < threshold) ? (n + 1) : n;
+}
+
+/*
+ * Returns the size a full array of `size` elements grows to.
+ */
+static inline size_t cadt_policy_grown_size(const ResizePolicy *p, size_t size)
+{
+    double grown = (double) size * p->growth;
+
+    if (grown >= (double) SIZE_MAX)
+    {
+        return SIZE_MAX;
+    }
+    /* a factor close to one still grows by one element */
+    return ((size_t) grown > size) ? (size_t) grown : (size + 1);
+}
+
+/*
+ * Returns the size an array of `size` elements holding `nelems` shrinks to,
+ * never below `lowest` nor `nelems`.
+ */
+static inline size_t cadt_policy_shrunk_size(const ResizePolicy *p,
+                                             size_t size, size_t lowest,
+                                             size_t nelems)
+{
+    size_t new_size = (size_t) ((double) size / p->growth);
+
+    if (new_size < lowest)
+    {
+        new_size = lowest;
+    }
+    return (new_size < nelems) ? nelems : new_size;
+}
+/** @endcond */
+
+#endif
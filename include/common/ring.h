@@ -0,0 +1,42 @@
+/**
+ * @file ring.h
+ * @brief Helpers for the circular arrays of the queue and the deque.
+ */
+
+#ifndef ADT_RING_H
+#define ADT_RING_H
+
+/** @cond */
+#include <stddef.h>
+#include <string.h>
+/** @endcond */
+#include "data_types.h"
+
+/** @cond */
+/*
+ * Copies the `n` elements of the circular array `src[]` of `size` slots,
+ * starting at index `first`, into `dst[]` from index zero.
+ */
+static inline void cadt_ring_unwrap(Element *dst, const Element *src,
+                                    size_t size, size_t first, size_t n)
+{
+    /*    <---                   --->            */
+    /* | x | x |   |   |   |   | x | x | x | x | */
+    /*                           first           */
+    /*
+     * The items run from the first one up to the end of the array, and wrap
+     * around to its start if there are more.
+     */
+    size_t nrun = size - first;
+
+    if (nrun > n)
+    {
+        nrun = n;
+    }
+
+    memcpy(&dst[0], &src[first], nrun * sizeof(Element));
+    memcpy(&dst[nrun], &src[0], (n - nrun) * sizeof(Element));
+}
+/** @endcond */
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file stats.h
+ * @brief Runtime statistics of the dynamic stack, the dynamic queue and the
+ * chained hash table, compiled in when `CADT_STATS` is defined.
+ *
+ * The stack and the queue fill a `ContainerStats`, defined below.  The hash
+ * table fills the `HashTableStats` of hashtable_adt.h, which adds the load
+ * factor, the rehash migrations and the chain lengths.
+ *
+ * Without `CADT_STATS` the counters are neither stored nor updated, and the
+ * `_stats` getters are not declared, so the statistics cost nothing.  The
+ * library and its clients must be built with the same setting, e.g. with
+ * `-DCADT_STATS` on the command line.
+ */
+
+#ifndef ADT_STATS_H
+#define ADT_STATS_H
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+/**
+ * @brief What a stack or queue did since its creation.
+ */
+typedef struct container_stats
+{
+    /** Number of elements held. */
+    size_t nelems;
+    /** Number of elements it has room for. */
+    size_t capacity;
+    /** Largest number of elements it held at once. */
+    size_t high_water;
+    /** Times it grew, a segmented stack linking a new segment included. */
+    size_t ngrows;
+    /** Times it shrank, on removals, clears and trims. */
+    size_t nshrinks;
+    /**
+     * Bytes of elements moved by the resizes.  A stack resizes in place with
+     * `realloc`, this is then the most that could have been copied.
+     */
+    size_t bytes_copied;
+} ContainerStats;
+
+/** @cond */
+/*
+ * Expands to `stmt` only when statistics are compiled in, for the updates
+ * sprinkled over the hot paths.
+ */
+#if defined(CADT_STATS)
+#define CADT_STATS_ONLY(stmt) stmt
+#else
+#define CADT_STATS_ONLY(stmt)
+#endif
+/** @endcond */
+
+#endif
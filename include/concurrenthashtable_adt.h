@@ -0,0 +1,192 @@
+#ifndef CONCURRENTHASHTABLE_ADT_H
+#define CONCURRENTHASHTABLE_ADT_H
+
+/** @cond */
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/** @endcond */
+#include "common/data_types.h"
+#include "common/hash_function.h"
+
+/** @cond */
+typedef struct concurrent_hash_table_type ConcurrentHashTableADT;
+/** @endcond */
+
+/**
+ * @brief Creates a new thread-safe hash table with the specified number of
+ * buckets and hash function.
+ *
+ * The actual number of buckets may _differ_, as it will be rounded up to a
+ * power of two no smaller than 64.  The table doubles its number of buckets
+ * when it holds more elements than buckets.  The hash table will use the
+ * provided hash function for hashing keys, which must be safe to call from
+ * several threads at once.  The signature has to match the `HashFuntion` type.
+ *
+ * If the memory allocation fails, the function sets `errno` to `ENOMEM` and
+ * outputs the interpreted error message to `stderr`. If the `nbuckets` argument
+ * passed is zero or the hash function pointer (`fp`) passed is NULL, `errno` is
+ * set to `EINVAL`, and the function returns `NULL`.
+ *
+ * @param nbuckets The number of buckets to allocate for the hash table.  An
+ *                 unsigned integer greater than zero.
+ *
+ * @param fp       The hash function used for hashing keys.  The function's type
+ *                 has to be explicitly `HashFunction`.  See @ref hashing.h for
+ *                 ready-made ones.
+ *
+ * @return A pointer to the newly created ConcurrentHashTableADT structure if
+ *         successful, or `NULL` on failure.
+ */
+ConcurrentHashTableADT *cadtconcurrenthashtable_new(size_t nbuckets,
+                                                    HashFunction *fp);
+
+/**
+ * @brief Deallocates a `ConcurrentHashTableADT` object, along with its entries
+ * and the copies of their keys.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by all
+ *       elements of in `ht`, and for making sure no other thread is still using
+ *       `ht`.
+ *
+ * @param ht Pointer to the `ConcurrentHashTableADT` object to be deallocated.
+ */
+void cadtconcurrenthashtable_destroy(ConcurrentHashTableADT *ht);
+
+/**
+ * @brief Returns the number of elements `ht` currently holds.
+ *
+ * The count is gathered stripe by stripe, so it may not reflect any single
+ * point in time while other threads insert or delete.
+ *
+ * @param ht The hash table to check.
+ * @return Returns the number of elements currently held by `ht`.
+ */
+size_t cadtconcurrenthashtable_nelems(ConcurrentHashTableADT *ht);
+
+/**
+ * @brief Inserts a new key-value pair into the hash table.
+ *
+ * Behaves as `cadthashtable_insert`, and may be called concurrently with any
+ * other operation but `cadtconcurrenthashtable_destroy`.
+ *
+ * If the `ht` pointer is `NULL`, the `key` pointer is `NULL`, the `keysize` is
+ * zero, or the `e` element is `NULL`, the function returns `NULL` and sets
+ * `errno` to `EINVAL`.
+ *
+ * If the specified key already exists in the hash table, the function sets
+ * errno to `EEXIST` and returns `NULL` without modifying the hash table.
+ *
+ * If memory allocation fails during the insertion process, the function outputs
+ * an error message to `stderr`, sets `errno` to `ENOMEM` and returns `NULL`.
+ *
+ * @param ht      Pointer to the `ConcurrentHashTableADT` object.
+ * @param key     Pointer to the key to be inserted into the hash table.
+ * @param keysize The size of the key data pointed to by `key`.
+ * @param e       The element to be associated with the specified key and
+ *                inserted into the hash table.
+ *
+ * @return The inserted element `e` if the operation is successful, or `NULL` on
+ *         failure.
+ */
+Element cadtconcurrenthashtable_insert(ConcurrentHashTableADT *ht,
+                                       const void *key, size_t keysize,
+                                       Element e);
+
+/**
+ * @brief Looks up and returns the element associated with the specified key.
+ *
+ * Behaves as `cadthashtable_lookup`, and may be called concurrently with any
+ * other operation but `cadtconcurrenthashtable_destroy`.  Lookups only take a
+ * stripe lock for reading, so they do not block each other.
+ *
+ * If the `ht` pointer is `NULL`, the `key` pointer is `NULL`, or the `keysize`
+ * is zero, the function returns `NULL` and sets `errno` to `EINVAL`.
+ *
+ * @param ht      Pointer to the `ConcurrentHashTableADT` object.
+ * @param key     Pointer to the key to be looked up in the hash table.
+ * @param keysize The size of the key data pointed to by `key`.
+ *
+ * @return The element associated with the specified `key`, if found, or `NULL`
+ *         if the `key` is not found or an error occurs during the lookup.
+ */
+Element cadtconcurrenthashtable_lookup(ConcurrentHashTableADT *ht,
+                                       const void *key, size_t keysize);
+
+/**
+ * @brief Removes an entry from the hash table and returns the associated
+ *        element.
+ *
+ * Behaves as `cadthashtable_delete`, and may be called concurrently with any
+ * other operation but `cadtconcurrenthashtable_destroy`.
+ *
+ * If the `ht` pointer is `NULL`, the `key` pointer is `NULL`, the `keysize` is
+ * zero, or the `e` element is `NULL`, the function returns `NULL` and sets
+ * `errno` to `EINVAL`.
+ *
+ * If the specified `key` is not found in the hash table, the function returns
+ * `NULL`.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by all
+ *       elements of in `ht`.
+ *
+ * @param ht      Pointer to the `ConcurrentHashTableADT` object.
+ * @param key     Pointer to the key whose associated entry is to be removed
+ *                from the hash table.
+ * @param keysize The size of the key data pointed to by `key`.
+ * @param e       The element to be returned on successful deletion of the
+ *                entry.
+ *
+ * @return The element associated with the deleted entry if the operation is
+ *         successful, or `NULL` if the `key` is not found or an error occurs
+ *         during the deletion.
+ */
+Element cadtconcurrenthashtable_delete(ConcurrentHashTableADT *ht,
+                                       const void *key, size_t keysize,
+                                       Element e);
+
+#endif
+
+/**
+ * @file concurrenthashtable_adt.h
+ *
+ * An opaque data structure that represents a hash table shared by several
+ * threads.  It should only be accessed through the `cadtconcurrenthashtable_`
+ * functions, which mirror the `cadthashtable_` ones.
+ *
+ * @code{.c}
+ * struct concurrent_hash_table_type ConcurrentHashTableADT
+ * {
+ *      // No available fields
+ * }
+ * @endcode
+ *
+ * @note To view the HTML rendered version of the C code for the implementation
+ * of this module, please visit:
+ * <a href="concurrenthashtable_adt_8c-example.html">concurrenthashtable_adt.c</a>.
+ *
+ * ---
+ *
+ * ### Key Points
+ *  + Relies on `void` pointers to allow manipulating elements of any type. See
+ *    @ref data_types.h.
+ *  + Uses `errno` to manage errors.
+ *  + Buckets are split into 64 stripes, each guarded by its own reader/writer
+ *    lock on its own cache line.  Operations on keys of different stripes
+ *    proceed in parallel, and lookups never block each other.
+ *  + A key's stripe does not change when the table grows, growing takes every
+ *    stripe lock at once.
+ *
+ * ### Considerations
+ *  + Clients are responsible for managing the memory space of the objects
+ *    loaded to the structure, and for synchronizing access to them.
+ *  + No type safety.
+ *  + Requires POSIX threads, link with `-pthread`.
+ *  + The table never shrinks.
+ *  + Allocates with `malloc`, as inserts from several threads allocate at
+ *    once, see @ref allocator.h.
+ *
+ */
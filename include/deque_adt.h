@@ -0,0 +1,269 @@
+#ifndef DEQUE_ADT_H
+#define DEQUE_ADT_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+/** @endcond */
+#include "common/data_types.h"
+#include "common/resize_policy.h"
+#include "common/ring.h"
+#include "common/allocator.h"
+
+/** @cond */
+typedef struct deque_type DequeADT;
+/** @endcond */
+
+/**
+ * @brief Creates a _non-circular_ (dynamic) deque.
+ *
+ * Allocates a deque with a minimum size of `size` that:
+ *  + __Doubles__ in size whenever _full_.
+ *  + __Halves__ if usage falls _below 25%_ and the shrinking leaves it at a
+ *    size at least _equal to_ its original definition.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM` and the
+ * interpreted error message is outputted to `stderr`. If the size argument
+ * passed is zero, `errno` is set to `EINVAL`. For both cases, `NULL` is
+ * returned.
+ *
+ * @param size The number of elements for initialization.
+ * @return Returns a `DequeADT` handle on success, `NULL` on failure.
+ */
+DequeADT *cadtdeque_new(size_t size);
+
+/**
+ * @brief Creates a _non-circular_ (dynamic) deque that allocates through `a`.
+ *
+ * Behaves as a deque created with `cadtdeque_new`, except that every block of
+ * memory of the deque, the `DequeADT` object included, is allocated and
+ * released through the functions of `a`.  The deque keeps its own copy of
+ * `*a`, whose context must stay valid until the deque is destroyed.  See
+ * @ref allocator.h.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM`. If the
+ * size argument passed is zero, or `a` is `NULL` or misses a function, `errno`
+ * is set to `EINVAL`. For both cases, `NULL` is returned.
+ *
+ * @param size The number of elements for initialization.
+ * @param a The allocator to allocate through.
+ * @return Returns a `DequeADT` handle on success, `NULL` on failure.
+ */
+DequeADT *cadtdeque_new_with_allocator(size_t size, const Allocator *a);
+
+/**
+ * @brief Creates a _circular_ (fixed-size) deque.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM` and the
+ * interpreted error message is outputted to `stderr`. If the size argument
+ * passed is zero, `errno` is set to `EINVAL`. For both cases, `NULL` is
+ * returned.
+ *
+ * @param size The maximum number of items the deque allows.
+ * @return Returns a `DequeADT` handle on success, `NULL` on failure.
+ */
+DequeADT *cadtdeque_new_circular(size_t size);
+
+/**
+ * @brief Deallocates a `DequeADT` object.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by all
+ *       elements of in `d`.
+ *
+ * @param d The deque to deallocate.
+ * @return Returns no value.
+ */
+void cadtdeque_destroy(DequeADT *d);
+
+/**
+ * @brief Returns the number of elements `d` currently holds.
+ *
+ * @param d The deque to check.
+ * @return Returns the number of elements currently held by `d`.
+ */
+size_t cadtdeque_nelems(DequeADT *d);
+
+/**
+ * @brief Empties the deque `d`.
+ *
+ * A non-circular deque is shrunk back to the minimum size of its policy,
+ * unless the policy is lazy.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by the
+ *       elements of the deque.
+ *
+ * @param d The deque to be emptied.
+ * @return Returns a `DequeADT` handle on success, `NULL` on failure.
+ */
+DequeADT *cadtdeque_clear(DequeADT *d);
+
+/**
+ * @brief Returns the front item in the deque without changing the deque.
+ *
+ * If `d` is empty (__Deque underflow__), `NULL` is returned and `errno` is set
+ * to `EPERM`.
+ *
+ * @param d The deque to peek from.
+ * @return Returns an `Element` on success, `NULL` on failure.
+ */
+Element cadtdeque_peek_front(DequeADT *d);
+
+/**
+ * @brief Returns the rear item in the deque without changing the deque.
+ *
+ * If `d` is empty (__Deque underflow__), `NULL` is returned and `errno` is set
+ * to `EPERM`.
+ *
+ * @param d The deque to peek from.
+ * @return Returns an `Element` on success, `NULL` on failure.
+ */
+Element cadtdeque_peek_rear(DequeADT *d);
+
+/**
+ * @brief Returns the item at position `i` of `d`, counting from the front.
+ *
+ * Runs in constant time. If `i` is not less than the number of elements in
+ * `d`, `NULL` is returned and `errno` is set to `EINVAL`.
+ *
+ * @param d The deque to peek from.
+ * @param i The position of the item, `0` being the front one.
+ * @return Returns an `Element` on success, `NULL` on failure.
+ */
+Element cadtdeque_at(DequeADT *d, size_t i);
+
+/**
+ * @brief Adds an element to the front of `d`.
+ *
+ * The behavior of the operation depends upon the type of deque object being
+ * pushed to:
+ *  + If `d` is circular and there is no room to add `e` (__Deque overflow__),
+ *    `NULL` is returned and `errno` is set to `EPERM`.
+ *  + If `d` is dynamic, has no room for `e` and the system fails to allocate
+ *    memory `NULL` is returned and `errno` is set to `ENOMEM`.
+ *
+ * @param d The deque to push to.
+ * @param e The element to prepend to `d`.
+ * @return Returns `e` on success, `NULL` on failure.
+ */
+Element cadtdeque_push_front(DequeADT *d, Element e);
+
+/**
+ * @brief Adds an element to the rear of `d`.
+ *
+ * Behaves as `cadtdeque_push_front`, on the other end of `d`.
+ *
+ * @param d The deque to push to.
+ * @param e The element to append to `d`.
+ * @return Returns `e` on success, `NULL` on failure.
+ */
+Element cadtdeque_push_rear(DequeADT *d, Element e);
+
+/**
+ * @brief Removes the element at the front of `d`.
+ *
+ * Returns and removes the front element in `d`. If `d` is empty (__Deque
+ * underflow__), `NULL` is returned and `errno` is set to `EPERM`.
+ *
+ * If the deque is non-circular and its usage is below 25% before the
+ * operation, the deque size is halved before removing the item, never below
+ * the size it was created with. See `cadtdeque_set_policy` to change both.
+ * If the reallocation of memory fails, `ENOMEM` is set, but the front element
+ * is still returned.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by the
+ *       elements of the deque `d`.
+ *
+ * @param d The deque to pop from.
+ * @return Returns an `Element` on success, `NULL` on underflow.
+ */
+Element cadtdeque_pop_front(DequeADT *d);
+
+/**
+ * @brief Removes the element at the rear of `d`.
+ *
+ * Behaves as `cadtdeque_pop_front`, on the other end of `d`.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by the
+ *       elements of the deque `d`.
+ *
+ * @param d The deque to pop from.
+ * @return Returns an `Element` on success, `NULL` on underflow.
+ */
+Element cadtdeque_pop_rear(DequeADT *d);
+
+/**
+ * @brief Sets how a non-circular deque grows and shrinks.
+ *
+ * A full deque grows by `policy->growth`, and shrinks by the same factor once
+ * its usage falls below `policy->shrink_usage`, never below
+ * `policy->min_size`. If `policy->lazy` is set, pops and `cadtdeque_clear`
+ * never shrink the deque, only `cadtdeque_trim` does.
+ *
+ * Passing `NULL` restores the default policy, see
+ * @ref CADT_RESIZE_POLICY_DEFAULT. If `policy` is not valid, see
+ * @ref resize_policy.h, `errno` is set to `EINVAL` and `d` is left unchanged.
+ * Circular deques accept a policy, but never resize.
+ *
+ * @param d The deque to configure.
+ * @param policy The policy to copy into `d`, or `NULL`.
+ * @return Returns a `DequeADT` handle on success, `NULL` on failure.
+ */
+DequeADT *cadtdeque_set_policy(DequeADT *d, const ResizePolicy *policy);
+
+/**
+ * @brief Releases the room a non-circular deque does not use.
+ *
+ * Shrinks `d` to its number of elements, never below the minimum size of its
+ * policy. If the reallocation of memory fails, `errno` is set to `ENOMEM` and
+ * `d` keeps its size.
+ *
+ * @param d The deque to trim.
+ * @return Returns a `DequeADT` handle on success, `NULL` on failure.
+ */
+DequeADT *cadtdeque_trim(DequeADT *d);
+
+#endif
+
+/**
+ * @file deque_adt.h
+ *
+ * An opaque data structure which represents a double-ended queue. It should
+ * only be accessed through the `cadtdeque_` functions.
+ *
+ * @code{.c}
+ * struct deque_type DequeADT
+ * {
+ *      // No available fields
+ * }
+ * @endcode
+ *
+ * @note To view the HTML rendered version of the C code for the implementation
+ * of this module, please visit:
+ * <a href="deque_adt_8c-example.html">deque_adt.c</a>.
+ *
+ * ---
+ *
+ * ### Key Points
+ *  + Relies on `void` pointers to allow manipulating elements of any type. See
+ *    @ref data_types.h.
+ *  + Uses `errno` for managing underflows/overflows.
+ *  + Same ring layout as a `QueueADT`: items are pushed and popped at both
+ *    ends in constant time, and any item is reached by its position in
+ *    constant time.
+ *  + Clients can allocate __circular__ (fixed-size) and __non-circular__
+ *    (dynamic) deques. A dynamic deque unwraps its items into a fresh array
+ *    when it resizes, with at most two `memcpy` calls.
+ *  + How a variable-size object grows and shrinks is set per object, see
+ *    @ref resize_policy.h.
+ *  + A non-circular deque can take its memory from a client-defined
+ *    allocator, see @ref allocator.h.
+ *
+ * ### Considerations
+ *  + Clients are responsible for managing the memory space of the objects
+ *    loaded to the structure.
+ *  + No type safety.
+ *
+ */
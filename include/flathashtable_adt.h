@@ -0,0 +1,211 @@
+#ifndef FLATHASHTABLE_ADT_H
+#define FLATHASHTABLE_ADT_H
+
+/** @cond */
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/** @endcond */
+#include "common/data_types.h"
+#include "common/hash_function.h"
+#include "common/allocator.h"
+
+/** @cond */
+typedef struct flat_hash_table_type FlatHashTableADT;
+/** @endcond */
+
+/**
+ * @brief Creates a new open-addressing hash table with room for at least the
+ * specified number of slots.
+ *
+ * The actual number of slots may _differ_, as it will be rounded up to a power
+ * of two no smaller than 16.  The table doubles its number of slots when more
+ * than 7/8 of them are in use.  The hash table will use the provided hash
+ * function for hashing keys.  The signature has to match the `HashFuntion`
+ * type.
+ *
+ * If the memory allocation fails, the function sets `errno` to `ENOMEM` and
+ * outputs the interpreted error message to `stderr`. If the `nslots` argument
+ * passed is zero or the hash function pointer (`fp`) passed is NULL, `errno` is
+ * set to `EINVAL`, and the function returns `NULL`.
+ *
+ * @param nslots The number of slots to allocate for the hash table.  An
+ *               unsigned integer greater than zero.
+ *
+ * @param fp     The hash function used for hashing keys.  The function's type
+ *               has to be explicitly `HashFunction`.  See @ref hashing.h for
+ *               ready-made ones.
+ *
+ * @return A pointer to the newly created FlatHashTableADT structure if
+ *         successful, or `NULL` on failure.
+ */
+FlatHashTableADT *cadtflathashtable_new(size_t nslots, HashFunction *fp);
+
+/**
+ * @brief Creates a new open-addressing hash table that allocates through `a`.
+ *
+ * Behaves as `cadtflathashtable_new`, except that every block of memory of the
+ * table is allocated and released through the functions of `a`: the
+ * `FlatHashTableADT` object, its control bytes and slots, and the copies of
+ * keys larger than 16 bytes.  The table keeps its own copy of `*a`, whose
+ * context must stay valid until the table is destroyed.  See
+ * @ref allocator.h.
+ *
+ * If the memory allocation fails, the function sets `errno` to `ENOMEM`. If
+ * the `nslots` argument passed is zero, or either the hash function pointer
+ * (`fp`) or `a` passed is NULL, or `a` misses a function, `errno` is set to
+ * `EINVAL`, and the function returns `NULL`.
+ *
+ * @param nslots The number of slots to allocate for the hash table.  An
+ *               unsigned integer greater than zero.
+ *
+ * @param fp     The hash function used for hashing keys.  The function's type
+ *               has to be explicitly `HashFunction`.
+ *
+ * @param a      The allocator to allocate through.
+ *
+ * @return A pointer to the newly created FlatHashTableADT structure if
+ *         successful, or `NULL` on failure.
+ */
+FlatHashTableADT *cadtflathashtable_new_with_allocator(size_t nslots,
+                                                       HashFunction *fp,
+                                                       const Allocator *a);
+
+/**
+ * @brief Deallocates a `FlatHashTableADT` object, along with the copies of the
+ * keys it holds.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by all
+ *       elements of in `ht`.
+ *
+ * @param ht Pointer to the `FlatHashTableADT` object to be deallocated.
+ */
+void cadtflathashtable_destroy(FlatHashTableADT *ht);
+
+/**
+ * @brief Returns the number of elements `ht` currently holds.
+ *
+ * @param ht The hash table to check.
+ * @return Returns the number of elements currently held by `ht`.
+ */
+size_t cadtflathashtable_nelems(FlatHashTableADT *ht);
+
+/**
+ * @brief Inserts a new key-value pair into the hash table.
+ *
+ * Behaves as `cadthashtable_insert`.
+ *
+ * If the `ht` pointer is `NULL`, the `key` pointer is `NULL`, the `keysize` is
+ * zero, or the `e` element is `NULL`, the function returns `NULL` and sets
+ * `errno` to `EINVAL`.
+ *
+ * If the specified key already exists in the hash table, the function sets
+ * errno to `EEXIST` and returns `NULL` without modifying the hash table.
+ *
+ * If memory allocation fails during the insertion process, the function outputs
+ * an error message to `stderr`, sets `errno` to `ENOMEM` and returns `NULL`.
+ *
+ * @param ht      Pointer to the `FlatHashTableADT` object.
+ * @param key     Pointer to the key to be inserted into the hash table.
+ * @param keysize The size of the key data pointed to by `key`.
+ * @param e       The element to be associated with the specified key and
+ *                inserted into the hash table.
+ *
+ * @return The inserted element `e` if the operation is successful, or `NULL` on
+ *         failure.
+ */
+Element cadtflathashtable_insert(FlatHashTableADT *ht, const void *key,
+                                 size_t keysize, Element e);
+
+/**
+ * @brief Looks up and returns the element associated with the specified key.
+ *
+ * Behaves as `cadthashtable_lookup`.
+ *
+ * If the `ht` pointer is `NULL`, the `key` pointer is `NULL`, or the `keysize`
+ * is zero, the function returns `NULL` and sets `errno` to `EINVAL`.
+ *
+ * @param ht      Pointer to the `FlatHashTableADT` object.
+ * @param key     Pointer to the key to be looked up in the hash table.
+ * @param keysize The size of the key data pointed to by `key`.
+ *
+ * @return The element associated with the specified `key`, if found, or `NULL`
+ *         if the `key` is not found or an error occurs during the lookup.
+ */
+Element cadtflathashtable_lookup(FlatHashTableADT *ht, const void *key,
+                                 size_t keysize);
+
+/**
+ * @brief Removes an entry from the hash table and returns the associated
+ *        element.
+ *
+ * Behaves as `cadthashtable_delete`.
+ *
+ * If the `ht` pointer is `NULL`, the `key` pointer is `NULL`, the `keysize` is
+ * zero, or the `e` element is `NULL`, the function returns `NULL` and sets
+ * `errno` to `EINVAL`.
+ *
+ * If the specified `key` is not found in the hash table, the function returns
+ * `NULL`.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by all
+ *       elements of in `ht`.
+ *
+ * @param ht      Pointer to the `FlatHashTableADT` object.
+ * @param key     Pointer to the key whose associated entry is to be removed
+ *                from the hash table.
+ * @param keysize The size of the key data pointed to by `key`.
+ * @param e       The element to be returned on successful deletion of the
+ *                entry.
+ *
+ * @return The element associated with the deleted entry if the operation is
+ *         successful, or `NULL` if the `key` is not found or an error occurs
+ *         during the deletion.
+ */
+Element cadtflathashtable_delete(FlatHashTableADT *ht, const void *key,
+                                 size_t keysize, Element e);
+
+#endif
+
+/**
+ * @file flathashtable_adt.h
+ *
+ * An opaque data structure that represents an open-addressing hash table.  It
+ * should only be accessed through the `cadtflathashtable_` functions, which
+ * mirror the `cadthashtable_` ones.
+ *
+ * @code{.c}
+ * struct flat_hash_table_type FlatHashTableADT
+ * {
+ *      // No available fields
+ * }
+ * @endcode
+ *
+ * @note To view the HTML rendered version of the C code for the implementation
+ * of this module, please visit:
+ * <a href="flathashtable_adt_8c-example.html">flathashtable_adt.c</a>.
+ *
+ * ---
+ *
+ * ### Key Points
+ *  + Relies on `void` pointers to allow manipulating elements of any type. See
+ *    @ref data_types.h.
+ *  + Uses `errno` to manage errors.
+ *  + Entries live in a single flat array of slots, with no per-entry
+ *    allocation.  Keys up to 16 bytes are stored inside the slot.
+ *  + A parallel array of control bytes holds a 7-bit tag of each key's hash.
+ *    Lookups compare 16 tags at once (with SSE2 when available), and only
+ *    compare keys whose tag matches.
+ *  + Can take its memory from a client-defined allocator, see
+ *    @ref allocator.h.
+ *
+ * ### Considerations
+ *  + Clients are responsible for managing the memory space of the objects
+ *    loaded to the structure.
+ *  + No type safety.
+ *  + Growing rehashes the whole table at once.
+ *
+ */
@@ -0,0 +1,87 @@
+#ifndef HASHING_H
+#define HASHING_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+/** @endcond */
+#include "common/hash_function.h"
+
+/**
+ * @brief Hashes a region in memory of any size.
+ *
+ * A wyhash-style hash: keys are read 8 bytes at a time and mixed with 64x64 to
+ * 128 bit multiplications.  Fast on short and long keys alike, with good
+ * distribution over all of its bits.  Its signature matches `HashFunction`,
+ * so it can be passed as is to the hash table constructors.
+ *
+ * @param data Pointer to the data to be hashed.
+ * @param size The size of the data pointed to by `data`, may be zero.
+ * @return The hash value of the `size` bytes pointed to by `data`.
+ */
+size_t cadthash_bytes(const void *data, size_t size);
+
+/**
+ * @brief Hashes a 4 or 8 byte integer key.
+ *
+ * Reads the key as a single integer and runs it through a multiply-xorshift
+ * finalizer, which is cheaper than `cadthash_bytes` for keys of these sizes.
+ * Keys of any other size are hashed with `cadthash_bytes`.
+ *
+ * @param data Pointer to the integer to be hashed.
+ * @param size The size of the integer, `4` or `8` for the fast path.
+ * @return The hash value of the integer pointed to by `data`.
+ */
+size_t cadthash_int(const void *data, size_t size);
+
+/**
+ * @brief Hashes a region in memory mixing in a secret seed.
+ *
+ * Behaves as `cadthash_bytes`, but the result also depends on the seed set
+ * through `cadthash_set_seed`.  Keeping the seed secret prevents an attacker
+ * from crafting keys that collide (hash flooding).
+ *
+ * @param data Pointer to the data to be hashed.
+ * @param size The size of the data pointed to by `data`, may be zero.
+ * @return The hash value of the `size` bytes pointed to by `data`.
+ */
+size_t cadthash_bytes_seeded(const void *data, size_t size);
+
+/**
+ * @brief Sets the seed used by `cadthash_bytes_seeded`.
+ *
+ * The seed should be drawn from a random source (such as `getrandom` or
+ * `/dev/urandom`) at startup.  Changing it changes every hash value, so it
+ * must not be changed while a table hashed with it is in use.
+ *
+ * @note The seed is shared by the whole process and is not synchronized, set
+ *       it before any thread starts hashing.
+ *
+ * @param seed The new seed.
+ */
+void cadthash_set_seed(uint64_t seed);
+
+#endif
+
+/**
+ * @file hashing.h
+ *
+ * Ready-made hash functions with the `HashFunction` signature, to be passed to
+ * `cadthashtable_new` and `cadtflathashtable_new`.
+ *
+ * @code{.c}
+ * HashTableADT *ht = cadthashtable_new(1024, cadthash_bytes);
+ * @endcode
+ *
+ * ### Key Points
+ *  + `cadthash_bytes` is a good default for keys of any size.
+ *  + `cadthash_int` is faster for 4 and 8 byte integer keys.
+ *  + `cadthash_bytes_seeded` should be preferred for keys coming from untrusted
+ *    sources.
+ *
+ * ### Considerations
+ *  + Hash values depend on the byte order of the platform, they are meant for
+ *    in-memory tables and should not be stored.
+ *
+ */
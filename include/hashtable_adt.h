@@ -10,30 +10,73 @@
 #include <string.h>
 /** @endcond */
 #include "common/data_types.h"
+#include "common/hash_function.h"
+#include "common/allocator.h"
+#include "common/stats.h"
+
+/** @cond */
+typedef struct hash_table_type HashTableADT;
+/** @endcond */
 
 /**
- * @brief Typedef for a _generic_ client-defined hash function.
- *
- * The `HashFunction` type is used to define generic hash functions that treats
- * the parameter pointer as pointing to some data of a given size. 
- * This allows the client side to define a custom hash function that operates on 
- * data as a __region in memory__, whose size is determined by the second 
- * parameter.
- *
- * @note The implementation stores a copy of the keys when elements are 
- * inserted, so it's crucial to define the `HashFunction` function properly to
- * ensure correct key retrieval and hashing behavior.
+ * @brief The type of the functions called on every element by
+ * `cadthashtable_foreach` and `cadthashtable_destroy_with`.
  *
- * @param data Pointer to the data to be hashed, treated as a region in memory.
- * @param size The size of the data pointed to by data.
- * @return The hash value generated by the hash function.
+ * Receives the table's copy of the key, its size, the element associated with
+ * it, and the context pointer passed along with the function.
+ */
+typedef void HashTableVisitor(const void *key, size_t keysize, Element e, 
+                              void *ctx);
+
+/**
+ * @brief A cursor over the entries of a hash table.
  *
+ * Meant to be declared by the client, typically on the stack, and set up with
+ * `cadthashtable_iter_init`.  Its fields are private.
  */
-typedef size_t HashFunction(const void*, size_t);
+typedef struct hash_table_iterator
+{
+    /** @cond */
+    HashTableADT *ht;
+    size_t index;
+    void *next;
+    /** @endcond */
+} HashTableIterator;
 
-/** @cond */
-typedef struct hash_table_type HashTableADT;
-/** @endcond */
+/**
+ * @brief Buckets counted by the chain-length histogram of `HashTableStats`.
+ */
+#define CADT_CHAIN_HISTOGRAM_SIZE 8
+
+/**
+ * @brief What a hash table did since its creation, and the shape of its
+ * buckets.  See `cadthashtable_stats`.
+ */
+typedef struct hash_table_stats
+{
+    /** Number of elements held. */
+    size_t nelems;
+    /** Number of buckets of the current array. */
+    size_t nbuckets;
+    /** Elements per bucket of the current array. */
+    double load_factor;
+    /** Largest number of elements held at once. */
+    size_t high_water;
+    /** Times a rehash to more buckets started. */
+    size_t ngrows;
+    /** Times a rehash to fewer buckets started. */
+    size_t nshrinks;
+    /** Entries moved from one bucket array to the next by the rehashes. */
+    size_t nmigrated;
+    /** Length of the longest chain. */
+    size_t max_chain;
+    /**
+     * Number of buckets whose chain is `i` entries long, the last counting
+     * those of `CADT_CHAIN_HISTOGRAM_SIZE - 1` entries or more.  While
+     * rehashing, the buckets of both arrays not yet migrated are counted.
+     */
+    size_t chain_lengths[CADT_CHAIN_HISTOGRAM_SIZE];
+} HashTableStats;
 
 /**
  * @brief Creates a new hash table with the specified number of buckets and hash
@@ -45,6 +88,15 @@ typedef struct hash_table_type HashTableADT;
  * provided hash function for hashing keys.  The signature has to match the 
  * `HashFuntion` type.  
  *
+ * The table:
+ *  + __Doubles__ its number of buckets whenever it holds more elements than 
+ *    buckets.
+ *  + __Halves__ it if less than one in eight buckets would be in use, but never
+ *    below the number of buckets it was created with.
+ *
+ * Entries are migrated to the resized bucket array a few buckets at a time on
+ * every insert, lookup and delete, so no single call pays for a full rehash.
+ *
  * If the memory allocation fails, the function sets `errno` to `ENOMEM` and
  * outputs the interpreted error message to `stderr`. If the `nbuckets` argument
  * passed is zero or the hash function pointer (`fp`) passed is NULL, `errno` is
@@ -54,7 +106,8 @@ typedef struct hash_table_type HashTableADT;
  *                 unsigned integer greater than zero.
  *
  * @param fp       The hash function used for hashing keys.  The function's type
- *                 has to be explicitly `HashFunction`.
+ *                 has to be explicitly `HashFunction`.  See @ref hashing.h for
+ *                 ready-made ones.
  *
  * @return A pointer to the newly created HashTableADT structure if successful,
  *         or `NULL` on failure.
@@ -62,7 +115,64 @@ typedef struct hash_table_type HashTableADT;
 HashTableADT *cadthashtable_new(size_t nbuckets, HashFunction *fp);
 
 /**
- * @brief Deallocates a `HashTableADT` object.
+ * @brief Creates a new hash table with a power of two number of buckets.
+ *
+ * Behaves as `cadthashtable_new`, but the number of buckets is rounded up to a
+ * power of two no smaller than two, and kept a power of two on resize.  Keys
+ * are assigned a bucket with Fibonacci hashing, a multiplication by a 64-bit
+ * constant keeping the top bits of the product, instead of a modulo by a prime.
+ * This takes the integer division off every insert, lookup and delete, while
+ * the multiplication still spreads hashes whose low bits are poor.
+ *
+ * If the memory allocation fails, the function sets `errno` to `ENOMEM` and
+ * outputs the interpreted error message to `stderr`. If the `nbuckets` argument
+ * passed is zero or the hash function pointer (`fp`) passed is NULL, `errno` is
+ * set to `EINVAL`, and the function returns `NULL`.
+ *
+ * @param nbuckets The number of buckets to allocate for the hash table.  An
+ *                 unsigned integer greater than zero.
+ *
+ * @param fp       The hash function used for hashing keys.  The function's type
+ *                 has to be explicitly `HashFunction`.
+ *
+ * @return A pointer to the newly created HashTableADT structure if successful,
+ *         or `NULL` on failure.
+ */
+HashTableADT *cadthashtable_new_pow2(size_t nbuckets, HashFunction *fp);
+
+/**
+ * @brief Creates a new hash table that allocates through `a`.
+ *
+ * Behaves as `cadthashtable_new`, except that every block of memory of the
+ * table is allocated and released through the functions of `a`: the
+ * `HashTableADT` object, its bucket arrays, the chunks its entries are carved
+ * from and the copies of keys larger than 16 bytes.  The table keeps its own
+ * copy of `*a`, whose context must stay valid until the table is destroyed.
+ * See @ref allocator.h.
+ *
+ * If the memory allocation fails, the function sets `errno` to `ENOMEM`. If
+ * the `nbuckets` argument passed is zero, or either the hash function pointer
+ * (`fp`) or `a` passed is NULL, or `a` misses a function, `errno` is set to
+ * `EINVAL`, and the function returns `NULL`.
+ *
+ * @param nbuckets The number of buckets to allocate for the hash table.  An
+ *                 unsigned integer greater than zero.
+ *
+ * @param fp       The hash function used for hashing keys.  The function's type
+ *                 has to be explicitly `HashFunction`.
+ *
+ * @param a        The allocator to allocate through.
+ *
+ * @return A pointer to the newly created HashTableADT structure if successful,
+ *         or `NULL` on failure.
+ */
+HashTableADT *cadthashtable_new_with_allocator(size_t nbuckets,
+                                               HashFunction *fp,
+                                               const Allocator *a);
+
+/**
+ * @brief Deallocates a `HashTableADT` object, along with its entries and the
+ * copies of their keys.
  *
  * @note Client-side is responsible for deallocating the memory in-use by all 
  *       elements of in `q`.  
@@ -71,6 +181,79 @@ HashTableADT *cadthashtable_new(size_t nbuckets, HashFunction *fp);
  */
 void cadthashtable_destroy(HashTableADT *ht);
 
+/**
+ * @brief Deallocates a `HashTableADT` object as `cadthashtable_destroy` does,
+ * calling `fp` on every element before its key is released.
+ *
+ * Entries are visited in a single linear pass over the memory they are
+ * allocated from, not bucket by bucket, so this is the cheapest way of
+ * releasing the elements along with the table.
+ *
+ * @param ht  Pointer to the `HashTableADT` object to be deallocated.
+ * @param fp  Function called on every element, e.g. to free it.  May be 
+ *            `NULL`.
+ * @param ctx Pointer passed as is to every call of `fp`.
+ */
+void cadthashtable_destroy_with(HashTableADT *ht, HashTableVisitor *fp, 
+                                void *ctx);
+
+/**
+ * @brief Returns the number of elements `ht` currently holds.
+ *
+ * @param ht The hash table to check.
+ * @return Returns the number of elements currently held by `ht`.
+ */
+size_t cadthashtable_nelems(HashTableADT *ht);
+
+/**
+ * @brief Calls `fp` on every element of the hash table.
+ *
+ * Buckets are visited in memory order, each chain from its head.  The table
+ * must not be modified by `fp`.
+ *
+ * If the `ht` pointer or the `fp` pointer is `NULL`, the function sets `errno`
+ * to `EINVAL` and returns.
+ *
+ * @param ht  Pointer to the `HashTableADT` object.
+ * @param fp  Function called on every element.
+ * @param ctx Pointer passed as is to every call of `fp`.
+ */
+void cadthashtable_foreach(HashTableADT *ht, HashTableVisitor *fp, void *ctx);
+
+/**
+ * @brief Sets up `it` to iterate over the entries of `ht`.
+ *
+ * Completes any rehash in progress, so that the iteration walks a single
+ * bucket array in memory order.  The iteration is invalidated by any insertion
+ * or deletion on `ht`.
+ *
+ * If the `ht` pointer or the `it` pointer is `NULL`, the function sets `errno`
+ * to `EINVAL`, and iterating over `it` yields nothing.
+ *
+ * @param ht Pointer to the `HashTableADT` object to iterate over.
+ * @param it Pointer to the `HashTableIterator` to set up.
+ */
+void cadthashtable_iter_init(HashTableADT *ht, HashTableIterator *it);
+
+/**
+ * @brief Advances `it` to the next entry of its hash table.
+ *
+ * Stores the table's copy of the key, its size and the associated element
+ * through the `key`, `keysize` and `e` pointers, any of which may be `NULL`.
+ *
+ * If the `it` pointer is `NULL` or was not successfully set up, the function
+ * sets `errno` to `EINVAL` and returns false.
+ *
+ * @param it      Pointer to the `HashTableIterator`.
+ * @param key     Where to store a pointer to the key of the entry.
+ * @param keysize Where to store the size of the key of the entry.
+ * @param e       Where to store the element of the entry.
+ *
+ * @return True if an entry was returned, false once all of them were.
+ */
+bool cadthashtable_iter_next(HashTableIterator *it, const void **key, 
+                             size_t *keysize, Element *e);
+
 /**
  * @brief Inserts a new key-value pair into the hash table.
  *
@@ -127,6 +310,34 @@ Element cadthashtable_insert(HashTableADT *ht, const void *key, size_t keysize,
  */
 Element cadthashtable_lookup(HashTableADT *ht, const void *key, size_t keysize);
 
+/**
+ * @brief Looks up a batch of keys, storing the element associated with each one
+ *        in `results`.
+ *
+ * Behaves as `n` calls to `cadthashtable_lookup`, with `results[i]` set to the
+ * element associated with `keys[i]`, or `NULL` if it is not found.  Keys are
+ * processed in small groups: all of their hashes are computed first and their
+ * buckets and first entries prefetched, before any of them is compared, so the
+ * memory latency of the lookups overlaps instead of adding up.
+ *
+ * If the `ht`, `keys`, `keysizes` or `results` pointers are `NULL`, the
+ * function returns zero and sets `errno` to `EINVAL`.  A `NULL` key or a zero
+ * key size gets a `NULL` result and also sets `errno` to `EINVAL`, without
+ * stopping the rest of the batch.
+ *
+ * @param ht       Pointer to the `HashTableADT` object.
+ * @param keys     Array of `n` pointers to the keys to be looked up.
+ * @param keysizes Array of the `n` sizes of the key data pointed to by `keys`.
+ * @param n        The number of keys to be looked up.
+ * @param results  Array of `n` elements, filled with the element associated
+ *                 with each key.
+ *
+ * @return The number of keys found.
+ */
+size_t cadthashtable_lookup_n(HashTableADT *ht, const void *const *keys, 
+                              const size_t *keysizes, size_t n, 
+                              Element *results);
+
 /**
  * @brief Removes an entry from the hash table and returns the associated
  *        element.
@@ -164,6 +375,21 @@ Element cadthashtable_lookup(HashTableADT *ht, const void *key, size_t keysize);
 Element cadthashtable_delete(HashTableADT *ht, void *key, size_t keysize, 
 							 Element e);
 
+#if defined(CADT_STATS)
+/**
+ * @brief Returns what `ht` did since its creation, and the shape of its
+ * buckets.
+ *
+ * Only available with `CADT_STATS` defined, see @ref stats.h.  The resize and
+ * high-water counters are kept up to date by every operation, the chain-length
+ * histogram is computed by this call, walking every bucket.
+ *
+ * @param ht The hash table to check.
+ * @return Returns the statistics of `ht`.
+ */
+HashTableStats cadthashtable_stats(HashTableADT *ht);
+#endif
+
 #endif
 
 /**
@@ -189,14 +415,22 @@ Element cadthashtable_delete(HashTableADT *ht, void *key, size_t keysize,
  *  + Relies on `void` pointers to allow manipulating elements of any type. See 
  *    @ref data_types.h.
  *  + Uses `errno` to manage errors.
- *  + Dynamically allocated, fixed size. 
+ *  + Dynamically allocated, resized according to its load factor. 
+ *  + Rehashing is incremental, spread over subsequent operations.
+ *  + Bucket counts are primes, or powers of two indexed with Fibonacci 
+ *    hashing when created through `cadthashtable_new_pow2`.
+ *  + Keys up to 16 bytes are copied into their entry, larger keys are copied
+ *    to a separate allocation.
+ *  + Entries are carved from chunks owned by the table and recycled on 
+ *    deletion, chunks are released all at once when the table is destroyed.
+ *  + Entries can be enumerated through an iterator or a visitor function, and
+ *    handed to a visitor function when the table is destroyed.
+ *  + Can take its memory from a client-defined allocator, see 
+ *    @ref allocator.h.
  *
  * ### Considerations
  *  + Clients are responsible for managing the memory space of the objects 
  *    loaded to the structure.  
  *  + No type safety.
  *
- * ### Future Improvements
- *  + Implement resizing according to load factor.
- *
  */
@@ -0,0 +1,126 @@
+#ifndef LFSTACK_ADT_H
+#define LFSTACK_ADT_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+/** @endcond */
+#include "common/data_types.h"
+
+/** @cond */
+typedef struct lf_stack_type LFStackADT;
+/** @endcond */
+
+/**
+ * @brief Creates a stack shared by any number of threads.
+ *
+ * The stack behaves as one created with `cadtstack_new`, but any thread may
+ * push or pop at any time without locking.  Room for at least `size` elements
+ * is allocated up front, more is added as needed and kept until the stack is
+ * destroyed.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM` and the
+ * interpreted error message is outputted to `stderr`. If the size argument
+ * passed is zero, `errno` is set to `EINVAL`. For both cases, `NULL` is
+ * returned.
+ *
+ * @param size The number of elements for initialization.
+ * @return Returns a `LFStackADT` handle on success, `NULL` on failure.
+ */
+LFStackADT *cadtlfstack_new(size_t size);
+
+/**
+ * @brief Deallocates a `LFStackADT` object.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by all
+ *       elements of in `s`, and for making sure no thread still uses `s`.
+ *
+ * @param s The stack to deallocate.
+ * @return Returns no value.
+ */
+void cadtlfstack_destroy(LFStackADT *s);
+
+/**
+ * @brief Returns the number of elements `s` currently holds.
+ *
+ * While other threads are operating on `s` the count is only a snapshot.
+ *
+ * @param s The stack to check.
+ * @return Returns the number of elements currently held by `s`.
+ */
+size_t cadtlfstack_nelems(LFStackADT *s);
+
+/**
+ * @brief Pushes an element onto the top of `s`.
+ *
+ * If `s` has no room for `e` and the system fails to allocate memory `NULL`
+ * is returned and `errno` is set to `ENOMEM`.
+ *
+ * @param s The stack to push to.
+ * @param e The element to push onto `s`.
+ * @return Returns `e` on success, `NULL` on failure.
+ */
+Element cadtlfstack_push(LFStackADT *s, Element e);
+
+/**
+ * @brief Pops the element at the top of `s`.
+ *
+ * Returns and removes the top element of `s`. If `s` is empty (__Stack
+ * underflow__), `NULL` is returned and `errno` is set to `EPERM`.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by the
+ *       elements of the stack `s`.
+ *
+ * @param s The stack to pop from.
+ * @return Returns an `Element` on success, `NULL` on underflow.
+ */
+Element cadtlfstack_pop(LFStackADT *s);
+
+#endif
+
+/**
+ * @file lfstack_adt.h
+ *
+ * An opaque data structure which represents a lock-free stack. It should only
+ * be accessed through the `cadtlfstack_` functions.
+ *
+ * @code{.c}
+ * struct lf_stack_type LFStackADT
+ * {
+ *      // No available fields
+ * }
+ * @endcode
+ *
+ * @note To view the HTML rendered version of the C code for the implementation
+ * of this module, please visit:
+ * <a href="lfstack_adt_8c-example.html">lfstack_adt.c</a>.
+ *
+ * ---
+ *
+ * ### Key Points
+ *  + Relies on `void` pointers to allow manipulating elements of any type. See
+ *    @ref data_types.h.
+ *  + Uses `errno` for managing underflows.
+ *  + A Treiber stack: a linked list of nodes whose top is swapped in and out
+ *    with a single compare-and-swap.
+ *  + The top packs a node index with a generation counter bumped on every
+ *    change, so a node popped and pushed back in between cannot fool a
+ *    compare-and-swap (the ABA problem).
+ *  + Nodes are carved from chunks owned by the stack and recycled, first
+ *    through a few small caches, threads striped over them, then through a
+ *    shared lock-free free list.  Once warm, pushes never call `malloc`.
+ *
+ * ### Considerations
+ *  + Clients are responsible for managing the memory space of the objects
+ *    loaded to the structure.
+ *  + No type safety.
+ *  + Memory is only returned to the system by `cadtlfstack_destroy`.
+ *  + Takes no client allocator, pushes from several threads may add chunks
+ *    at once.
+ *  + Relies on the GCC `__atomic` builtins and `__thread` storage, also
+ *    provided by Clang.
+ *
+ */
@@ -0,0 +1,131 @@
+#ifndef MPMCQUEUE_ADT_H
+#define MPMCQUEUE_ADT_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+/** @endcond */
+#include "common/data_types.h"
+
+/** @cond */
+typedef struct mpmc_queue_type MPMCQueueADT;
+/** @endcond */
+
+/**
+ * @brief Creates a bounded queue shared by any number of producer and consumer
+ * threads.
+ *
+ * The queue behaves as one created with `cadtqueue_new_circular`, but any
+ * thread may enqueue or dequeue at any time without locking.  The actual size
+ * may _differ_, as it will be rounded up to a power of two no smaller than two.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM` and the
+ * interpreted error message is outputted to `stderr`. If the size argument
+ * passed is zero, `errno` is set to `EINVAL`. For both cases, `NULL` is
+ * returned.
+ *
+ * @param size The minimum number of items the queue allows.
+ * @return Returns a `MPMCQueueADT` handle on success, `NULL` on failure.
+ */
+MPMCQueueADT *cadtmpmcqueue_new(size_t size);
+
+/**
+ * @brief Deallocates a `MPMCQueueADT` object.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by all
+ *       elements of in `q`, and for making sure no thread still uses `q`.
+ *
+ * @param q The queue to deallocate.
+ * @return Returns no value.
+ */
+void cadtmpmcqueue_destroy(MPMCQueueADT *q);
+
+/**
+ * @brief Returns the number of elements `q` currently holds.
+ *
+ * While other threads are operating on `q` the count is only an estimate.
+ *
+ * @param q The queue to check.
+ * @return Returns the number of elements currently held by `q`.
+ */
+size_t cadtmpmcqueue_nelems(MPMCQueueADT *q);
+
+/**
+ * @brief Returns the maximum number of elements `q` can hold.
+ *
+ * @param q The queue to check.
+ * @return Returns the size of `q`, after rounding to a power of two.
+ */
+size_t cadtmpmcqueue_capacity(MPMCQueueADT *q);
+
+/**
+ * @brief Adds an element to the rear of `q`.
+ *
+ * If there is no room to add `e` (__Queue overflow__), `NULL` is returned and
+ * `errno` is set to `EPERM`.
+ *
+ * @param q The queue to push to.
+ * @param e The element to append to `q`.
+ * @return Returns `e` on success, `NULL` on failure.
+ */
+Element cadtmpmcqueue_enqueue(MPMCQueueADT *q, Element e);
+
+/**
+ * @brief Removes the element at the front of `q`.
+ *
+ * Returns and removes the front element in `q`. If `q` is empty (__Queue
+ * underflow__), `NULL` is returned and `errno` is set to `EPERM`.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by the
+ *       elements of the queue `q`.
+ *
+ * @param q The queue to dequeue from.
+ * @return Returns an `Element` on success, `NULL` on underflow.
+ */
+Element cadtmpmcqueue_dequeue(MPMCQueueADT *q);
+
+#endif
+
+/**
+ * @file mpmcqueue_adt.h
+ *
+ * An opaque data structure which represents a lock-free bounded
+ * multi-producer multi-consumer queue. It should only be accessed through the
+ * `cadtmpmcqueue_` functions.
+ *
+ * @code{.c}
+ * struct mpmc_queue_type MPMCQueueADT
+ * {
+ *      // No available fields
+ * }
+ * @endcode
+ *
+ * @note To view the HTML rendered version of the C code for the implementation
+ * of this module, please visit:
+ * <a href="mpmcqueue_adt_8c-example.html">mpmcqueue_adt.c</a>.
+ *
+ * ---
+ *
+ * ### Key Points
+ *  + Relies on `void` pointers to allow manipulating elements of any type. See
+ *    @ref data_types.h.
+ *  + Uses `errno` for managing underflows/overflows.
+ *  + Every cell of the ring carries a sequence number telling whether it is
+ *    ready to be written or read in the current lap (Dmitry Vyukov's design).
+ *    An enqueue or a dequeue is a single compare-and-swap on its position,
+ *    producers and consumers do not contend with each other.
+ *  + The enqueue and dequeue positions sit on cache lines of their own.
+ *
+ * ### Considerations
+ *  + Clients are responsible for managing the memory space of the objects
+ *    loaded to the structure.
+ *  + No type safety.
+ *  + A thread stalled between claiming a cell and publishing it holds back
+ *    the threads on the opposite side that reach that cell.
+ *  + Takes no client allocator, its object is cache-line aligned.
+ *  + Relies on the GCC `__atomic` builtins, also provided by Clang.
+ *
+ */
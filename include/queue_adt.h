@@ -9,6 +9,11 @@
 #include <string.h>
 /** @endcond */
 #include "common/data_types.h"
+#include "common/resize_policy.h"
+#include "common/ring.h"
+#include "common/allocator.h"
+#include "common/stats.h"
+#include "common/inline.h"
 
 /** @cond */
 typedef struct queue_type QueueADT;
@@ -32,6 +37,25 @@ typedef struct queue_type QueueADT;
  */
 QueueADT *cadtqueue_new(size_t size);
 
+/**
+ * @brief Creates a _non-circular_ (dynamic) queue that allocates through `a`.
+ *
+ * Behaves as a queue created with `cadtqueue_new`, except that every block of
+ * memory of the queue, the `QueueADT` object included, is allocated and 
+ * released through the functions of `a`.  The queue keeps its own copy of 
+ * `*a`, whose context must stay valid until the queue is destroyed.  See 
+ * @ref allocator.h.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM`. If the 
+ * size argument passed is zero, or `a` is `NULL` or misses a function, `errno`
+ * is set to `EINVAL`. For both cases, `NULL` is returned.
+ *
+ * @param size The number of elements for initialization.
+ * @param a The allocator to allocate through.
+ * @return Returns a `QueueADT` handle on success, `NULL` on failure.
+ */
+QueueADT *cadtqueue_new_with_allocator(size_t size, const Allocator *a);
+
 /**
  * @brief Creates a _circular_ (fixed-size) queue.
  *
@@ -45,6 +69,41 @@ QueueADT *cadtqueue_new(size_t size);
  */
 QueueADT *cadtqueue_new_circular(size_t size);
 
+/**
+ * @brief Creates a _non-circular_ (dynamic) queue whose size is a power of two.
+ *
+ * Behaves as `cadtqueue_new`, but `size` is rounded up to a power of two, and
+ * stays one as the queue doubles and halves.  The queue then keeps ever
+ * increasing head and tail counters and masks them into indexes, so enqueue
+ * and dequeue wrap around without branching and the number of elements is a 
+ * subtraction.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM` and the 
+ * interpreted error message is outputted to `stderr`. If the size argument 
+ * passed is zero or has no power of two above it, `errno` is set to `EINVAL`. 
+ * For both cases, `NULL` is returned.
+ *
+ * @param size The number of elements for initialization.
+ * @return Returns a `QueueADT` handle on success, `NULL` on failure.
+ */
+QueueADT *cadtqueue_new_pow2(size_t size);
+
+/**
+ * @brief Creates a _circular_ (fixed-size) queue whose size is a power of two.
+ *
+ * Behaves as `cadtqueue_new_circular`, with the indexing of 
+ * `cadtqueue_new_pow2`.  The queue may thus hold more items than `size`.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM` and the 
+ * interpreted error message is outputted to `stderr`. If the size argument 
+ * passed is zero or has no power of two above it, `errno` is set to `EINVAL`. 
+ * For both cases, `NULL` is returned.
+ *
+ * @param size The minimum number of items the queue allows.
+ * @return Returns a `QueueADT` handle on success, `NULL` on failure.
+ */
+QueueADT *cadtqueue_new_circular_pow2(size_t size);
+
 /**
  * @brief Deallocates a `QueueADT` object.
  *
@@ -120,7 +179,8 @@ Element cadtqueue_enqueue(QueueADT *q, Element e);
  * underflow__), `NULL` is returned and `errno` is set to `EPERM`. 
  *
  * If the queue is non-circular and its usage is below 25% before the dequeue 
- * operation, the queue size is halved before removing the item. 
+ * operation, the queue size is halved before removing the item, never below 
+ * the size it was created with. See `cadtqueue_set_policy` to change both. 
  * If the reallocation of memory fails, `ENOMEM` is set, but the front element 
  * is still returned.
  *
@@ -132,6 +192,100 @@ Element cadtqueue_enqueue(QueueADT *q, Element e);
  */
 Element cadtqueue_dequeue(QueueADT *q);
 
+/**
+ * @brief Adds the `n` elements of `src` to the rear of `q`, in order.
+ *
+ * Equivalent to `n` calls to `cadtqueue_enqueue`, but the elements are copied 
+ * as whole runs and a dynamic queue is resized at most once:
+ *  + If `q` is circular, only as many elements as there is room for are 
+ *    added. If there is none (__Queue overflow__), `errno` is set to `EPERM`.
+ *  + If `q` is dynamic, it grows to fit all `n` elements. If the system fails 
+ *    to allocate memory none is added and `errno` is set to `ENOMEM`.
+ *
+ * If `src` is `NULL` and `n` is non-zero, `errno` is set to `EINVAL`.
+ *
+ * @param q The queue to push to.
+ * @param src The elements to append to `q`, first to last.
+ * @param n The number of elements in `src`.
+ * @return Returns the number of elements added, `0` on failure.
+ */
+size_t cadtqueue_enqueue_n(QueueADT *q, const Element *src, size_t n);
+
+/**
+ * @brief Removes up to `n` elements at the front of `q` into `dst`.
+ *
+ * Equivalent to `n` calls to `cadtqueue_dequeue`, but the elements are copied 
+ * as whole runs. If `q` holds fewer than `n` elements, all are removed. If `q` 
+ * is empty (__Queue underflow__), `errno` is set to `EPERM`.
+ *
+ * If the queue is non-circular and its usage falls below the shrink threshold 
+ * of its policy, it is shrunk once, dividing its size as many times as needed, 
+ * never below the minimum size of its policy. If the reallocation of memory 
+ * fails, `ENOMEM` is set, but the elements are still removed.
+ *
+ * If `dst` is `NULL` and `n` is non-zero, `errno` is set to `EINVAL`.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by the 
+ *       elements of the queue `q`.  
+ *
+ * @param q The queue to dequeue from.
+ * @param dst Room for at least `n` elements, filled first to last.
+ * @param n The maximum number of elements to remove.
+ * @return Returns the number of elements removed, `0` on failure.
+ */
+size_t cadtqueue_dequeue_n(QueueADT *q, Element *dst, size_t n);
+
+/**
+ * @brief Sets how a non-circular queue grows and shrinks.
+ *
+ * A full queue grows by `policy->growth`, and shrinks by the same factor once 
+ * its usage falls below `policy->shrink_usage`, never below 
+ * `policy->min_size`. If `policy->lazy` is set, dequeues and 
+ * `cadtqueue_clear` never shrink the queue, only `cadtqueue_trim` does. In 
+ * power of two mode sizes are rounded up to a power of two.
+ *
+ * Passing `NULL` restores the default policy, see 
+ * @ref CADT_RESIZE_POLICY_DEFAULT. If `policy` is not valid, see 
+ * @ref resize_policy.h, `errno` is set to `EINVAL` and `q` is left unchanged. 
+ * Circular queues accept a policy, but never resize.
+ *
+ * @param q The queue to configure.
+ * @param policy The policy to copy into `q`, or `NULL`.
+ * @return Returns a `QueueADT` handle on success, `NULL` on failure.
+ */
+QueueADT *cadtqueue_set_policy(QueueADT *q, const ResizePolicy *policy);
+
+/**
+ * @brief Releases the room a non-circular queue does not use.
+ *
+ * Shrinks `q` to its number of elements, never below the minimum size of its 
+ * policy. Meant for queues with a lazy policy, once a burst is over. If the 
+ * reallocation of memory fails, `errno` is set to `ENOMEM` and `q` keeps its 
+ * size.
+ *
+ * @param q The queue to trim.
+ * @return Returns a `QueueADT` handle on success, `NULL` on failure.
+ */
+QueueADT *cadtqueue_trim(QueueADT *q);
+
+#if defined(CADT_STATS)
+/**
+ * @brief Returns what `q` did since its creation.
+ *
+ * Only available with `CADT_STATS` defined, see @ref stats.h.  A circular
+ * queue never resizes, its counts stay at zero.
+ *
+ * @param q The queue to check.
+ * @return Returns the statistics of `q`.
+ */
+ContainerStats cadtqueue_stats(QueueADT *q);
+#endif
+
+/* The inline fast paths, see inline.h */
+#if defined(CADT_INLINE)
+#include "queue_adt_inline.h"
+#endif
+
 #endif
 
 /**
@@ -162,6 +316,17 @@ Element cadtqueue_dequeue(QueueADT *q);
  *      + Circular queue (fixed-size): Predefined size that remains constant. 
  *      + Non-circular queue (dynamic/variable-size): Can dynamically adjust its 
  *        size based on the number of elements it holds.
+ *  + Either kind can be given a power of two size, trading the exact size for
+ *    branch-free index wrap-around.
+ *  + Elements can be enqueued and dequeued in batches, copied with at most 
+ *    two `memcpy` calls across the wrap-around point.
+ *  + How a variable-size object grows and shrinks is set per object, see 
+ *    @ref resize_policy.h. The default policy leaves a gap between both 
+ *    thresholds, so usage oscillating around either does not reallocate.
+ *  + A non-circular queue can take its memory from a client-defined 
+ *    allocator, see @ref allocator.h.
+ *  + With `CADT_INLINE` defined, the common case of enqueue and dequeue is 
+ *    inlined into the caller, see @ref inline.h.
  *
  * ### Considerations
  *  + Clients are responsible for managing the memory space of the objects 
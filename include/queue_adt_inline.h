@@ -0,0 +1,137 @@
+/**
+ * @file queue_adt_inline.h
+ * @brief The completion of `QueueADT`, and the inline fast paths of its
+ * enqueue and dequeue.
+ *
+ * Included by queue_adt.h when `CADT_INLINE` is defined, see @ref inline.h.
+ * `cadtqueue_enqueue`, `cadtqueue_dequeue` and `cadtqueue_nelems` then expand
+ * to the functions below, which do the common case in place and call the
+ * function of the library for the rest.  They behave as documented in
+ * queue_adt.h.
+ *
+ * The fields of `QueueADT` are not part of the interface, and should still
+ * only be accessed through the `cadtqueue_` functions.
+ */
+
+#ifndef ADT_QUEUE_INLINE_H
+#define ADT_QUEUE_INLINE_H
+
+#include "queue_adt.h"
+
+/** @cond */
+/*
+ * # Datatype completion
+ *
+ * A `QueueADT` object is:  
+ *  + A dynamically allocated array of void pointers.
+ *  + The index of the first item that arrived in the queue.
+ *  + The index of the last item that arrived in the queue.
+ *  + The number of elements currently in the queue.
+ *  + The array's minimum size.
+ *  + The array's current maximum size.
+ *  + A flag that determines whether the queue is dynamic or not.
+ *  + A flag that determines whether the array's size is a power of two.
+ *  + The policy a dynamic queue grows and shrinks by.
+ *  + The number of elements below which a dequeue shrinks the array, derived
+ *    from the policy on every resize so dequeues compare integers only.  Zero
+ *    if dequeues never shrink.
+ *  + The allocator every block of the queue comes from.
+ *  + With `CADT_STATS`, the counters of its resizes and its high-water mark.
+ *
+ * In power of two mode `head` and `tail` are instead ever increasing counters
+ * of the items dequeued and enqueued, masked into indexes on access.  `tail`
+ * is then one past the last item, the number of elements is `tail - head` and
+ * `nelems` is left unused.
+ */
+struct queue_type
+{
+    Element *contents;
+    size_t head;
+    size_t tail;
+    size_t nelems;
+    size_t min_size;
+    size_t curr_max_size;
+    int is_fix;
+    int is_pow2;
+    ResizePolicy policy;
+    size_t shrink_at;
+    Allocator allocator;
+#if defined(CADT_STATS)
+    ContainerStats stats;
+#endif
+};
+
+/*
+ * queue_adt.c defines `CADT_QUEUE_SOURCE`, it completes the type only.
+ */
+#if !defined(CADT_QUEUE_SOURCE)
+/*
+ * The library functions are called by their parenthesized names, which the
+ * macros below do not expand.
+ */
+static inline size_t cadtqueue_nelems_inline(QueueADT *q)
+{
+    return q->is_pow2 ? (q->tail - q->head) : q->nelems;
+}
+
+static inline Element cadtqueue_enqueue_inline(QueueADT *q, Element e)
+{
+    /* overflow and growth are left to the library */
+    if (cadtqueue_nelems_inline(q) == q->curr_max_size)
+    {
+        return (cadtqueue_enqueue)(q, e);
+    }
+
+    if (q->is_pow2)
+    {
+        q->contents[q->tail++ & (q->curr_max_size - 1)] = e;
+    }
+    else
+    {
+        if (q->nelems >= 1)
+        {
+            q->tail = (q->tail == q->curr_max_size - 1) ? 0 : (q->tail + 1);
+        }
+        q->contents[q->tail] = e;
+        q->nelems++;
+    }
+#if defined(CADT_STATS)
+    if (cadtqueue_nelems_inline(q) > q->stats.high_water)
+    {
+        q->stats.high_water = cadtqueue_nelems_inline(q);
+    }
+#endif
+    return e;
+}
+
+static inline Element cadtqueue_dequeue_inline(QueueADT *q)
+{
+    size_t nelems = cadtqueue_nelems_inline(q);
+    Element ret;
+
+    /* underflow and shrinking are left to the library */
+    if (nelems == 0 || (!q->is_fix && nelems < q->shrink_at))
+    {
+        return (cadtqueue_dequeue)(q);
+    }
+
+    if (q->is_pow2)
+    {
+        return q->contents[q->head++ & (q->curr_max_size - 1)];
+    }
+    ret = q->contents[q->head];
+    q->nelems--;
+    if (q->nelems != 0)
+    {
+        q->head = (q->head == q->curr_max_size - 1) ? 0 : (q->head + 1);
+    }
+    return ret;
+}
+
+#define cadtqueue_nelems(q) cadtqueue_nelems_inline(q)
+#define cadtqueue_enqueue(q, e) cadtqueue_enqueue_inline(q, e)
+#define cadtqueue_dequeue(q) cadtqueue_dequeue_inline(q)
+#endif
+/** @endcond */
+
+#endif
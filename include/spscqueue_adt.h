@@ -0,0 +1,123 @@
+#ifndef SPSCQUEUE_ADT_H
+#define SPSCQUEUE_ADT_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+/** @endcond */
+#include "common/data_types.h"
+
+/** @cond */
+typedef struct spsc_queue_type SPSCQueueADT;
+/** @endcond */
+
+/**
+ * @brief Creates a fixed-size queue shared by one producer thread and one
+ * consumer thread.
+ *
+ * The queue behaves as one created with `cadtqueue_new_circular`, but one
+ * thread may enqueue while another dequeues without any locking.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM` and the
+ * interpreted error message is outputted to `stderr`. If the size argument
+ * passed is zero, `errno` is set to `EINVAL`. For both cases, `NULL` is
+ * returned.
+ *
+ * @param size The maximum number of items the queue allows.
+ * @return Returns a `SPSCQueueADT` handle on success, `NULL` on failure.
+ */
+SPSCQueueADT *cadtspscqueue_new(size_t size);
+
+/**
+ * @brief Deallocates a `SPSCQueueADT` object.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by all
+ *       elements of in `q`, and for making sure neither thread still uses `q`.
+ *
+ * @param q The queue to deallocate.
+ * @return Returns no value.
+ */
+void cadtspscqueue_destroy(SPSCQueueADT *q);
+
+/**
+ * @brief Returns the number of elements `q` currently holds.
+ *
+ * May be called from either thread.  While the other thread is operating on
+ * `q` the count is only a snapshot, exact for neither side.
+ *
+ * @param q The queue to check.
+ * @return Returns the number of elements currently held by `q`.
+ */
+size_t cadtspscqueue_nelems(SPSCQueueADT *q);
+
+/**
+ * @brief Adds an element to the rear of `q`.
+ *
+ * Must only be called from the producer thread.  If there is no room to add
+ * `e` (__Queue overflow__), `NULL` is returned and `errno` is set to `EPERM`.
+ *
+ * @param q The queue to push to.
+ * @param e The element to append to `q`.
+ * @return Returns `e` on success, `NULL` on failure.
+ */
+Element cadtspscqueue_enqueue(SPSCQueueADT *q, Element e);
+
+/**
+ * @brief Removes the element at the front of `q`.
+ *
+ * Must only be called from the consumer thread.  Returns and removes the front
+ * element in `q`. If `q` is empty (__Queue underflow__), `NULL` is returned and
+ * `errno` is set to `EPERM`.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by the
+ *       elements of the queue `q`.
+ *
+ * @param q The queue to dequeue from.
+ * @return Returns an `Element` on success, `NULL` on underflow.
+ */
+Element cadtspscqueue_dequeue(SPSCQueueADT *q);
+
+#endif
+
+/**
+ * @file spscqueue_adt.h
+ *
+ * An opaque data structure which represents a lock-free single-producer
+ * single-consumer queue. It should only be accessed through the
+ * `cadtspscqueue_` functions.
+ *
+ * @code{.c}
+ * struct spsc_queue_type SPSCQueueADT
+ * {
+ *      // No available fields
+ * }
+ * @endcode
+ *
+ * @note To view the HTML rendered version of the C code for the implementation
+ * of this module, please visit:
+ * <a href="spscqueue_adt_8c-example.html">spscqueue_adt.c</a>.
+ *
+ * ---
+ *
+ * ### Key Points
+ *  + Relies on `void` pointers to allow manipulating elements of any type. See
+ *    @ref data_types.h.
+ *  + Uses `errno` for managing underflows/overflows.
+ *  + Same ring layout as a circular `QueueADT`, with the head and tail indexes
+ *    read and written atomically, each on its own cache line.
+ *  + Each side keeps a copy of the other side's index and only reloads it when
+ *    the queue looks full (producer) or empty (consumer), so most handoffs
+ *    touch no cache line written by the other thread.
+ *
+ * ### Considerations
+ *  + Clients are responsible for managing the memory space of the objects
+ *    loaded to the structure.
+ *  + No type safety.
+ *  + Exactly one thread may enqueue and one thread may dequeue at a time.
+ *  + Takes no client allocator, its object is cache-line aligned.
+ *  + Relies on the GCC `__atomic` builtins, also provided by Clang.
+ *
+ */
@@ -8,6 +8,10 @@
 #include <errno.h>
 /** @endcond */
 #include "common/data_types.h"
+#include "common/resize_policy.h"
+#include "common/allocator.h"
+#include "common/stats.h"
+#include "common/inline.h"
 
 /** @cond */
 typedef struct stack_type StackADT;
@@ -30,6 +34,25 @@ typedef struct stack_type StackADT;
  */
 StackADT *cadtstack_new(size_t size);
 
+/**
+ * @brief Creates a variable-size stack that allocates through `a`.
+ *
+ * Behaves as a stack created with `cadtstack_new`, except that every block of
+ * memory of the stack, the `StackADT` object included, is allocated, resized
+ * and released through the functions of `a`.  The stack keeps its own copy of
+ * `*a`, whose context must stay valid until the stack is destroyed.  See
+ * @ref allocator.h.
+ *
+ * If the size argument passed is zero, or `a` is `NULL` or misses a function,
+ * `errno` is set to `EINVAL`. In case of failure to allocate memory `errno` is
+ * set to `ENOMEM`. For both cases `NULL` is returned.
+ *
+ * @param size The number of elements for initialization.
+ * @param a The allocator to allocate through.
+ * @return Returns a `StackADT` handle on success, `NULL` on failure.
+ */
+StackADT *cadtstack_new_with_allocator(size_t size, const Allocator *a);
+
 /**
  * @brief Creates a fixed-size stack.
  *
@@ -42,6 +65,44 @@ StackADT *cadtstack_new(size_t size);
  */
 StackADT *cadtstack_new_fix(size_t size);
 
+/**
+ * @brief Creates a segmented stack.
+ *
+ * Allocates a variable-size stack made of segments of `size` elements each. 
+ * A full stack links a new segment on top instead of reallocating, and a pop 
+ * that finds the top segment empty unlinks it. The last segment unlinked is 
+ * kept for the next one needed, so a stack going up and down across a 
+ * segment boundary does not allocate. Elements never move, and both push and 
+ * pop copy no element besides the one pushed or popped.
+ *
+ * If the size argument passed is zero, `errno` is set to `EINVAL`. In case of 
+ * failure to allocate memory `errno` is set to `ENOMEM`. For both cases the 
+ * interpreted error message is outputted to `stderr`, and `NULL` is returned.
+ *
+ * @param size The number of elements of each segment.
+ * @return Returns a `StackADT` handle on success, `NULL` on failure.
+ */
+StackADT *cadtstack_new_segmented(size_t size);
+
+/**
+ * @brief Creates a segmented stack that allocates through `a`.
+ *
+ * Behaves as a stack created with `cadtstack_new_segmented`, except that the
+ * `StackADT` object and every segment are allocated and released through the
+ * functions of `a`.  The stack keeps its own copy of `*a`, whose context must
+ * stay valid until the stack is destroyed.  See @ref allocator.h.
+ *
+ * If the size argument passed is zero, or `a` is `NULL` or misses a function,
+ * `errno` is set to `EINVAL`. In case of failure to allocate memory `errno` is
+ * set to `ENOMEM`. For both cases `NULL` is returned.
+ *
+ * @param size The number of elements of each segment.
+ * @param a The allocator to allocate through.
+ * @return Returns a `StackADT` handle on success, `NULL` on failure.
+ */
+StackADT *cadtstack_new_segmented_with_allocator(size_t size,
+                                                 const Allocator *a);
+
 /**
  * @brief Deallocates a `StackADT`.
  *
@@ -95,7 +156,8 @@ Element cadtstack_push(StackADT *s, Element e);
  * (__Stack underflow__), `NULL` is returned and `errno` is set to `EPERM`. 
  *
  * + If `s` is a variable-size stack and its usage is below 25%, the stack size 
- *   is halved.  
+ *   is halved, never below the size it was created with. See 
+ *   `cadtstack_set_policy` to change both.
  * + If the reallocation of memory fails, `ENOMEM` is set, but the top element 
  *   is still popped from the stack.
  *
@@ -107,6 +169,56 @@ Element cadtstack_push(StackADT *s, Element e);
  */
 Element cadtstack_pop(StackADT *s);
 
+/**
+ * @brief Sets how a variable-size stack grows and shrinks.
+ *
+ * A full stack grows by `policy->growth`, and shrinks by the same factor once 
+ * its usage falls below `policy->shrink_usage`, never below 
+ * `policy->min_size`. If `policy->lazy` is set, pops and `cadtstack_clear` 
+ * never shrink the stack, only `cadtstack_trim` does.
+ *
+ * Passing `NULL` restores the default policy, see 
+ * @ref CADT_RESIZE_POLICY_DEFAULT. If `policy` is not valid, see 
+ * @ref resize_policy.h, `errno` is set to `EINVAL` and `s` is left unchanged. 
+ * Fixed-size and segmented stacks accept a policy, but never resize.
+ *
+ * @param s The stack to configure.
+ * @param policy The policy to copy into `s`, or `NULL`.
+ * @return Returns a `StackADT` handle on success, `NULL` on failure.
+ */
+StackADT *cadtstack_set_policy(StackADT *s, const ResizePolicy *policy);
+
+/**
+ * @brief Releases the room a variable-size stack does not use.
+ *
+ * Shrinks `s` to its number of elements, never below the minimum size of its 
+ * policy. Meant for stacks with a lazy policy, once a burst is over. If the 
+ * reallocation of memory fails, `errno` is set to `ENOMEM` and `s` keeps its 
+ * size. A segmented stack frees the segment it keeps spare.
+ *
+ * @param s The stack to trim.
+ * @return Returns a `StackADT` handle on success, `NULL` on failure.
+ */
+StackADT *cadtstack_trim(StackADT *s);
+
+#if defined(CADT_STATS)
+/**
+ * @brief Returns what `s` did since its creation.
+ *
+ * Only available with `CADT_STATS` defined, see @ref stats.h.  A fixed-size
+ * stack never resizes, its counts stay at zero.
+ *
+ * @param s The stack to check.
+ * @return Returns the statistics of `s`.
+ */
+ContainerStats cadtstack_stats(StackADT *s);
+#endif
+
+/* The inline fast paths, see inline.h */
+#if defined(CADT_INLINE)
+#include "stack_adt_inline.h"
+#endif
+
 #endif
 
 /**
@@ -132,6 +244,16 @@ Element cadtstack_pop(StackADT *s);
  *  + Uses `errno` for managing stack underflows/overflows. 
  *  + Dynamically allocated. 
  *  + Stack object size can be __fixed__ or __variable__.  
+ *  + A variable-size stack can be __segmented__, growing by linking fixed-size 
+ *    segments rather than reallocating, so that no push or pop ever copies 
+ *    the stack.
+ *  + How a variable-size object grows and shrinks is set per object, see 
+ *    @ref resize_policy.h. The default policy leaves a gap between both 
+ *    thresholds, so usage oscillating around either does not reallocate.
+ *  + A variable-size stack can take its memory from a client-defined 
+ *    allocator, see @ref allocator.h.
+ *  + With `CADT_INLINE` defined, the common case of push and pop is inlined 
+ *    into the caller, see @ref inline.h.
  *
  * ### Considerations
  *  + Clients are responsible for managing the memory space of the objects 
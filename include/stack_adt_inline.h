@@ -0,0 +1,126 @@
+/**
+ * @file stack_adt_inline.h
+ * @brief The completion of `StackADT`, and the inline fast paths of its
+ * push and pop.
+ *
+ * Included by stack_adt.h when `CADT_INLINE` is defined, see @ref inline.h.
+ * `cadtstack_push`, `cadtstack_pop` and `cadtstack_nelems` then expand to the
+ * functions below, which do the common case in place and call the function
+ * of the library for the rest.  They behave as documented in stack_adt.h.
+ *
+ * The fields of `StackADT` are not part of the interface, and should still
+ * only be accessed through the `cadtstack_` functions.
+ */
+
+#ifndef ADT_STACK_INLINE_H
+#define ADT_STACK_INLINE_H
+
+#include "stack_adt.h"
+
+/** @cond */
+/*
+ * A `StackSegment` is:
+ * + The segment below it, `NULL` for the bottom one.
+ * + The slots, as many as the stack's minimum size.
+ */
+typedef struct stack_segment
+{
+    struct stack_segment *prev;
+    Element slots[];
+} StackSegment;
+
+/*
+ * # Datatype completion
+ *
+ * A `StackADT` object is:  
+ *  + A dynamically allocated array of void pointers.
+ *  + The array's minimum size.
+ *  + The array's current maximum size.
+ *  + The index of its top element.
+ *  + A flag that determines whether the stack is of fixed size or may possibly
+ *    grow 
+ *  + The policy a variable-size stack grows and shrinks by.
+ *  + The number of elements below which a pop shrinks the array, derived from
+ *    the policy on every resize so pops compare integers only.  Zero if pops
+ *    never shrink.
+ *  + A flag that determines whether the stack is segmented.
+ *  + The index of the element held in `contents[0]`.
+ *  + The top segment, and an empty segment kept for the next one needed.
+ *  + The allocator every block of the stack comes from.
+ *  + With `CADT_STATS`, the counters of its resizes and its high-water mark.
+ *
+ * A segmented stack is a list of segments of `min_size` slots each, never
+ * reallocated.  `contents` points to the slots of the top segment, holding
+ * the elements from `base` up, and `curr_max_size` is the room of all the
+ * segments, so the array code paths reach the top segment unchanged.  The
+ * other kinds of stack keep `base` at zero and no segments.
+ */
+struct stack_type
+{
+    Element *contents;
+    size_t min_size;
+    size_t curr_max_size;
+    size_t top;
+    int is_fix;
+    ResizePolicy policy;
+    size_t shrink_at;
+    int is_seg;
+    size_t base;
+    StackSegment *seg;
+    StackSegment *spare;
+    Allocator allocator;
+#if defined(CADT_STATS)
+    ContainerStats stats;
+#endif
+};
+
+/*
+ * stack_adt.c defines `CADT_STACK_SOURCE`, it completes the type only.
+ */
+#if !defined(CADT_STACK_SOURCE)
+/*
+ * The library functions are called by their parenthesized names, which the
+ * macros below do not expand.
+ */
+static inline size_t cadtstack_nelems_inline(StackADT *s)
+{
+    return s->top;
+}
+
+static inline Element cadtstack_push_inline(StackADT *s, Element e)
+{
+    /* overflow, growth and new segments are left to the library */
+    if (s->top == s->curr_max_size)
+    {
+        return (cadtstack_push)(s, e);
+    }
+
+    s->contents[s->top++ - s->base] = e;
+#if defined(CADT_STATS)
+    if (s->top > s->stats.high_water)
+    {
+        s->stats.high_water = s->top;
+    }
+#endif
+    return e;
+}
+
+static inline Element cadtstack_pop_inline(StackADT *s)
+{
+    /* underflow, shrinking and empty top segments are left to the library */
+    if (s->top == 0 || (s->is_seg ? s->top == s->base
+                                  : !s->is_fix && s->top < s->shrink_at))
+    {
+        return (cadtstack_pop)(s);
+    }
+
+    return s->contents[--s->top - s->base];
+}
+
+#define cadtstack_nelems(s) cadtstack_nelems_inline(s)
+#define cadtstack_push(s, e) cadtstack_push_inline(s, e)
+#define cadtstack_pop(s) cadtstack_pop_inline(s)
+#endif
+/** @endcond */
+
+#endif
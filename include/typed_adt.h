@@ -0,0 +1,573 @@
+/**
+ * @file typed_adt.h
+ * @brief Type-specialized stack, queue and hash table, generated by macros.
+ *
+ * Each `CADT_*_DEFINE` macro expands, at file scope, to a container type named
+ * `name` and to its `static inline` functions, prefixed by `name_`.  Values
+ * are stored inline, in arrays of their own type, so a container of
+ * `uint32_t` takes four bytes per element and no allocation per element.  The
+ * hash and compare functions of a hash table are called directly, and are
+ * inlined along with the fast paths of every operation into the caller.
+ * Resizes are kept out of line.
+ *
+ * @code{.c}
+ * CADT_STACK_DEFINE(u32stack, uint32_t);
+ * CADT_QUEUE_DEFINE(u32queue, uint32_t);
+ * CADT_HASHTABLE_DEFINE(u32map, uint32_t, Point, hash_u32, eq_u32);
+ * @endcode
+ *
+ * Types must be named with a single identifier, use a `typedef` for pointers,
+ * arrays and tagged types.
+ */
+
+#ifndef ADT_TYPED_H
+#define ADT_TYPED_H
+
+/** @cond */
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/** @endcond */
+#include "common/inline.h"
+
+/** @cond */
+#define CADT_FIBONACCI_MULTIPLIER UINT64_C(0x9e3779b97f4a7c15)
+
+/*
+ * Returns the base 2 logarithm of the power of two `n`.
+ */
+static inline unsigned int cadt_log2(size_t n)
+{
+    unsigned int log = 0;
+
+    while (n >>= 1)
+    {
+        log++;
+    }
+    return log;
+}
+/** @endcond */
+
+/**
+ * @brief Defines the stack `name` of elements of type `T`.
+ *
+ * Generates:
+ *  + `name *name_new(size_t size)` creates a stack with room for `size`
+ *    elements, that __doubles__ whenever _full_ and __halves__ if usage falls
+ *    _below 25%_, never below `size`.  If `size` is zero `errno` is set to
+ *    `EINVAL`, if allocating fails to `ENOMEM`, and `NULL` is returned.
+ *  + `void name_destroy(name *s)` deallocates `s`.
+ *  + `size_t name_nelems(const name *s)` returns the number of elements.
+ *  + `T *name_push(name *s, T value)` copies `value` on top of `s` and returns
+ *    its slot, or `NULL` with `errno` set to `ENOMEM` if growing fails.
+ *  + `T *name_pop(name *s)` removes the top element and returns its slot,
+ *    valid until the next push.  On underflow `NULL` is returned and `errno`
+ *    is set to `EPERM`.
+ *  + `T *name_peek(name *s)` returns the slot of the top element, `NULL` with
+ *    `errno` set to `EPERM` if `s` is empty.
+ */
+#define CADT_STACK_DEFINE(name, T)                                             \
+typedef struct name                                                            \
+{                                                                              \
+    T *contents;                                                               \
+    size_t top;                                                                \
+    size_t size;                                                               \
+    size_t min_size;                                                           \
+} name;                                                                        \
+                                                                               \
+static CADT_SLOW_PATH name *name##_resize(name *s, size_t new_size)            \
+{                                                                              \
+    T *p;                                                                      \
+                                                                               \
+    if (new_size > SIZE_MAX / sizeof(T)                                        \
+        || (p = realloc(s->contents, new_size * sizeof(T))) == NULL)           \
+    {                                                                          \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    s->contents = p;                                                           \
+    s->size = new_size;                                                        \
+    return s;                                                                  \
+}                                                                              \
+                                                                               \
+static inline name *name##_new(size_t size)                                    \
+{                                                                              \
+    name *s;                                                                   \
+                                                                               \
+    if (size == 0 || size > SIZE_MAX / sizeof(T))                              \
+    {                                                                          \
+        errno = EINVAL;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    if ((s = malloc(sizeof(name))) == NULL)                                    \
+    {                                                                          \
+        perror(#name "_new() malloc failed allocating the stack");             \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    if ((s->contents = malloc(size * sizeof(T))) == NULL)                      \
+    {                                                                          \
+        perror(#name "_new() malloc failed allocating the contents");          \
+        free(s);                                                               \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    s->top = 0;                                                                \
+    s->size = size;                                                            \
+    s->min_size = size;                                                        \
+    return s;                                                                  \
+}                                                                              \
+                                                                               \
+static inline void name##_destroy(name *s)                                     \
+{                                                                              \
+    free(s->contents);                                                         \
+    free(s);                                                                   \
+}                                                                              \
+                                                                               \
+static inline size_t name##_nelems(const name *s)                              \
+{                                                                              \
+    return s->top;                                                             \
+}                                                                              \
+                                                                               \
+static inline T *name##_push(name *s, T value)                                 \
+{                                                                              \
+    if (s->top == s->size && name##_resize(s, s->size * 2) == NULL)            \
+    {                                                                          \
+        return NULL;                                                           \
+    }                                                                          \
+    s->contents[s->top] = value;                                               \
+    return &s->contents[s->top++];                                             \
+}                                                                              \
+                                                                               \
+static inline T *name##_pop(name *s)                                           \
+{                                                                              \
+    if (s->top == 0)                                                           \
+    {                                                                          \
+        errno = EPERM;                                                         \
+        return NULL;                                                           \
+    }                                                                          \
+    /* Shrinks first, the popped slot then stays valid */                      \
+    if (s->top <= s->size / 4 && s->size / 2 >= s->min_size)                   \
+    {                                                                          \
+        name##_resize(s, s->size / 2);                                         \
+    }                                                                          \
+    return &s->contents[--s->top];                                             \
+}                                                                              \
+                                                                               \
+static inline T *name##_peek(name *s)                                          \
+{                                                                              \
+    if (s->top == 0)                                                           \
+    {                                                                          \
+        errno = EPERM;                                                         \
+        return NULL;                                                           \
+    }                                                                          \
+    return &s->contents[s->top - 1];                                           \
+}                                                                              \
+/* Swallows the semicolon after the macro */                                   \
+typedef int name##_macro_end_
+
+/**
+ * @brief Defines the queue `name` of elements of type `T`.
+ *
+ * A ring buffer of a power-of-two size.  Generates:
+ *  + `name *name_new(size_t size)` creates a queue with room for `size`
+ *    elements, rounded up to a power of two, that __doubles__ whenever _full_
+ *    and __halves__ if usage falls _below 25%_, never below its initial size.
+ *    If `size` is zero `errno` is set to `EINVAL`, if allocating fails to
+ *    `ENOMEM`, and `NULL` is returned.
+ *  + `void name_destroy(name *q)` deallocates `q`.
+ *  + `size_t name_nelems(const name *q)` returns the number of elements.
+ *  + `T *name_enqueue(name *q, T value)` copies `value` at the rear of `q` and
+ *    returns its slot, or `NULL` with `errno` set to `ENOMEM` if growing
+ *    fails.
+ *  + `T *name_dequeue(name *q)` removes the first element and returns its
+ *    slot, valid until the next enqueue.  On underflow `NULL` is returned and
+ *    `errno` is set to `EPERM`.
+ *  + `T *name_peek_first(name *q)` returns the slot of the first element,
+ *    `NULL` with `errno` set to `EPERM` if `q` is empty.
+ */
+#define CADT_QUEUE_DEFINE(name, T)                                             \
+typedef struct name                                                            \
+{                                                                              \
+    T *contents;                                                               \
+    size_t head;                                                               \
+    size_t tail;                                                               \
+    size_t size;                                                               \
+    size_t min_size;                                                           \
+} name;                                                                        \
+                                                                               \
+static CADT_SLOW_PATH name *name##_resize(name *q, size_t new_size)            \
+{                                                                              \
+    size_t n = q->tail - q->head;                                              \
+    size_t first = q->head & (q->size - 1);                                    \
+    size_t run = n < q->size - first ? n : q->size - first;                    \
+    T *p;                                                                      \
+                                                                               \
+    if (new_size > SIZE_MAX / sizeof(T)                                        \
+        || (p = malloc(new_size * sizeof(T))) == NULL)                         \
+    {                                                                          \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    /* Unwraps the ring, the oldest element landing on slot zero */            \
+    memcpy(p, &q->contents[first], run * sizeof(T));                           \
+    memcpy(p + run, q->contents, (n - run) * sizeof(T));                       \
+    free(q->contents);                                                         \
+    q->contents = p;                                                           \
+    q->head = 0;                                                               \
+    q->tail = n;                                                               \
+    q->size = new_size;                                                        \
+    return q;                                                                  \
+}                                                                              \
+                                                                               \
+static inline name *name##_new(size_t size)                                    \
+{                                                                              \
+    name *q;                                                                   \
+    size_t pow2 = 1;                                                           \
+                                                                               \
+    if (size == 0 || size > (SIZE_MAX / 2 + 1) / sizeof(T))                    \
+    {                                                                          \
+        errno = EINVAL;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    while (pow2 < size)                                                        \
+    {                                                                          \
+        pow2 *= 2;                                                             \
+    }                                                                          \
+    if ((q = malloc(sizeof(name))) == NULL)                                    \
+    {                                                                          \
+        perror(#name "_new() malloc failed allocating the queue");             \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    if ((q->contents = malloc(pow2 * sizeof(T))) == NULL)                      \
+    {                                                                          \
+        perror(#name "_new() malloc failed allocating the contents");          \
+        free(q);                                                               \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    q->head = 0;                                                               \
+    q->tail = 0;                                                               \
+    q->size = pow2;                                                            \
+    q->min_size = pow2;                                                        \
+    return q;                                                                  \
+}                                                                              \
+                                                                               \
+static inline void name##_destroy(name *q)                                     \
+{                                                                              \
+    free(q->contents);                                                         \
+    free(q);                                                                   \
+}                                                                              \
+                                                                               \
+static inline size_t name##_nelems(const name *q)                              \
+{                                                                              \
+    return q->tail - q->head;                                                  \
+}                                                                              \
+                                                                               \
+static inline T *name##_enqueue(name *q, T value)                              \
+{                                                                              \
+    T *slot;                                                                   \
+                                                                               \
+    if (q->tail - q->head == q->size                                           \
+        && name##_resize(q, q->size * 2) == NULL)                              \
+    {                                                                          \
+        return NULL;                                                           \
+    }                                                                          \
+    slot = &q->contents[q->tail++ & (q->size - 1)];                            \
+    *slot = value;                                                             \
+    return slot;                                                               \
+}                                                                              \
+                                                                               \
+static inline T *name##_dequeue(name *q)                                       \
+{                                                                              \
+    if (q->tail == q->head)                                                    \
+    {                                                                          \
+        errno = EPERM;                                                         \
+        return NULL;                                                           \
+    }                                                                          \
+    /* Shrinks first, the dequeued slot then stays valid */                    \
+    if (q->tail - q->head <= q->size / 4 && q->size / 2 >= q->min_size)        \
+    {                                                                          \
+        name##_resize(q, q->size / 2);                                         \
+    }                                                                          \
+    return &q->contents[q->head++ & (q->size - 1)];                            \
+}                                                                              \
+                                                                               \
+static inline T *name##_peek_first(name *q)                                    \
+{                                                                              \
+    if (q->tail == q->head)                                                    \
+    {                                                                          \
+        errno = EPERM;                                                         \
+        return NULL;                                                           \
+    }                                                                          \
+    return &q->contents[q->head & (q->size - 1)];                              \
+}                                                                              \
+/* Swallows the semicolon after the macro */                                   \
+typedef int name##_macro_end_
+
+/**
+ * @brief Defines the hash table `name` mapping keys of type `K` to values of
+ * type `V`.
+ *
+ * An open-addressing table with linear probing, grown to twice its size past
+ * a load of 3/4.  Keys and values are stored side by side in one array of
+ * slots.  `hash_fn` and `eq_fn` must be functions, or function-like macros,
+ * of the form:
+ *
+ * @code{.c}
+ * size_t hash_fn(const K *key);
+ * int eq_fn(const K *a, const K *b);   // non-zero if equal
+ * @endcode
+ *
+ * The hash is multiplied by a Fibonacci constant and its top bits taken as
+ * the slot, so the identity is good enough for integers.  Generates:
+ *  + `name *name_new(size_t nslots)` creates a table with room for `nslots`
+ *    entries.  If `nslots` is zero `errno` is set to `EINVAL`, if allocating
+ *    fails to `ENOMEM`, and `NULL` is returned.
+ *  + `void name_destroy(name *ht)` deallocates `ht`.
+ *  + `size_t name_nelems(const name *ht)` returns the number of entries.
+ *  + `V *name_insert(name *ht, K key, V value)` adds the entry and returns the
+ *    slot of its value, valid until the next insert or delete.  If `key` is
+ *    already present `errno` is set to `EEXIST`, if growing fails to
+ *    `ENOMEM`, and `NULL` is returned.
+ *  + `V *name_lookup(name *ht, K key)` returns the slot of the value of `key`,
+ *    `NULL` if not found.
+ *  + `V *name_delete(name *ht, K key, V *out)` removes the entry of `key`,
+ *    copies its value to `*out` and returns `out`, or returns `NULL` if not
+ *    found.  If `out` is `NULL` the value is dropped, and a non-`NULL`
+ *    pointer, not to be dereferenced, is returned when the entry is removed.
+ */
+#define CADT_HASHTABLE_DEFINE(name, K, V, hash_fn, eq_fn)                      \
+typedef struct name##_slot                                                     \
+{                                                                              \
+    K key;                                                                     \
+    V value;                                                                   \
+} name##_slot;                                                                 \
+                                                                               \
+typedef struct name                                                            \
+{                                                                              \
+    name##_slot *slots;                                                        \
+    unsigned char *used;                                                       \
+    size_t capacity;                                                           \
+    size_t nelems;                                                             \
+    unsigned int shift;                                                        \
+} name;                                                                        \
+                                                                               \
+/* What name##_delete returns when given no `out`, never read nor written */   \
+static V name##_removed;                                                       \
+                                                                               \
+static inline size_t name##_home(const name *ht, const K *key)                 \
+{                                                                              \
+    return (size_t) (((uint64_t) hash_fn(key) * CADT_FIBONACCI_MULTIPLIER)     \
+                     >> ht->shift);                                            \
+}                                                                              \
+                                                                               \
+/* Returns the slot holding `key`, or the empty slot ending its probe run */   \
+static inline size_t name##_probe(const name *ht, const K *key, int *found)    \
+{                                                                              \
+    size_t mask = ht->capacity - 1;                                            \
+    size_t i = name##_home(ht, key);                                           \
+                                                                               \
+    while (ht->used[i])                                                        \
+    {                                                                          \
+        if (eq_fn(&ht->slots[i].key, key))                                     \
+        {                                                                      \
+            *found = 1;                                                        \
+            return i;                                                          \
+        }                                                                      \
+        i = (i + 1) & mask;                                                    \
+    }                                                                          \
+    *found = 0;                                                                \
+    return i;                                                                  \
+}                                                                              \
+                                                                               \
+static CADT_SLOW_PATH name *name##_rehash(name *ht, size_t capacity)           \
+{                                                                              \
+    name##_slot *slots = ht->slots;                                            \
+    unsigned char *used = ht->used;                                            \
+    size_t old_capacity = ht->capacity;                                        \
+    size_t i, j;                                                               \
+    int found;                                                                 \
+                                                                               \
+    if (capacity > SIZE_MAX / sizeof(name##_slot)                              \
+        || (ht->slots = malloc(capacity * sizeof(name##_slot))) == NULL)       \
+    {                                                                          \
+        ht->slots = slots;                                                     \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    if ((ht->used = calloc(capacity, 1)) == NULL)                              \
+    {                                                                          \
+        free(ht->slots);                                                       \
+        ht->slots = slots;                                                     \
+        ht->used = used;                                                       \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    ht->capacity = capacity;                                                   \
+    ht->shift = 64 - cadt_log2(capacity);                                      \
+    for (i = 0; i < old_capacity; i++)                                         \
+    {                                                                          \
+        if (used[i])                                                           \
+        {                                                                      \
+            j = name##_probe(ht, &slots[i].key, &found);                       \
+            ht->used[j] = 1;                                                   \
+            ht->slots[j] = slots[i];                                           \
+        }                                                                      \
+    }                                                                          \
+    free(slots);                                                               \
+    free(used);                                                                \
+    return ht;                                                                 \
+}                                                                              \
+                                                                               \
+static inline name *name##_new(size_t nslots)                                  \
+{                                                                              \
+    name *ht;                                                                  \
+    size_t capacity = 8;                                                       \
+                                                                               \
+    if (nslots == 0 || nslots > SIZE_MAX / 4 / sizeof(name##_slot))            \
+    {                                                                          \
+        errno = EINVAL;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    /* Room for `nslots` entries under the maximum load of 3/4 */              \
+    while (capacity / 4 * 3 < nslots)                                          \
+    {                                                                          \
+        capacity *= 2;                                                         \
+    }                                                                          \
+    if ((ht = malloc(sizeof(name))) == NULL)                                   \
+    {                                                                          \
+        perror(#name "_new() malloc failed allocating the table");             \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    ht->slots = NULL;                                                          \
+    ht->used = NULL;                                                           \
+    ht->capacity = 0;                                                          \
+    ht->nelems = 0;                                                            \
+    if (name##_rehash(ht, capacity) == NULL)                                   \
+    {                                                                          \
+        perror(#name "_new() malloc failed allocating the slots");             \
+        free(ht);                                                              \
+        errno = ENOMEM;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    return ht;                                                                 \
+}                                                                              \
+                                                                               \
+static inline void name##_destroy(name *ht)                                    \
+{                                                                              \
+    free(ht->slots);                                                           \
+    free(ht->used);                                                            \
+    free(ht);                                                                  \
+}                                                                              \
+                                                                               \
+static inline size_t name##_nelems(const name *ht)                             \
+{                                                                              \
+    return ht->nelems;                                                         \
+}                                                                              \
+                                                                               \
+static inline V *name##_insert(name *ht, K key, V value)                       \
+{                                                                              \
+    size_t i;                                                                  \
+    int found;                                                                 \
+                                                                               \
+    i = name##_probe(ht, &key, &found);                                        \
+    if (found)                                                                 \
+    {                                                                          \
+        errno = EEXIST;                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    if ((ht->nelems + 1) * 4 > ht->capacity * 3)                               \
+    {                                                                          \
+        if (name##_rehash(ht, ht->capacity * 2) == NULL)                       \
+        {                                                                      \
+            return NULL;                                                       \
+        }                                                                      \
+        i = name##_probe(ht, &key, &found);                                    \
+    }                                                                          \
+    ht->used[i] = 1;                                                           \
+    ht->slots[i].key = key;                                                    \
+    ht->slots[i].value = value;                                                \
+    ht->nelems++;                                                              \
+    return &ht->slots[i].value;                                                \
+}                                                                              \
+                                                                               \
+static inline V *name##_lookup(name *ht, K key)                                \
+{                                                                              \
+    size_t i;                                                                  \
+    int found;                                                                 \
+                                                                               \
+    i = name##_probe(ht, &key, &found);                                        \
+    return found ? &ht->slots[i].value : NULL;                                 \
+}                                                                              \
+                                                                               \
+static inline V *name##_delete(name *ht, K key, V *out)                        \
+{                                                                              \
+    size_t mask = ht->capacity - 1;                                            \
+    size_t i, j;                                                               \
+    int found;                                                                 \
+                                                                               \
+    i = name##_probe(ht, &key, &found);                                        \
+    if (!found)                                                                \
+    {                                                                          \
+        return NULL;                                                           \
+    }                                                                          \
+    if (out != NULL)                                                           \
+    {                                                                          \
+        *out = ht->slots[i].value;                                             \
+    }                                                                          \
+    /*                                                                         \
+     * Backward-shift deletion: moves back every entry of the run past the     \
+     * hole whose home slot is not between the hole and itself, so probes      \
+     * never need tombstones.                                                  \
+     */                                                                        \
+    for (j = (i + 1) & mask; ht->used[j]; j = (j + 1) & mask)                  \
+    {                                                                          \
+        if (((j - name##_home(ht, &ht->slots[j].key)) & mask)                  \
+            >= ((j - i) & mask))                                               \
+        {                                                                      \
+            ht->slots[i] = ht->slots[j];                                       \
+            i = j;                                                             \
+        }                                                                      \
+    }                                                                          \
+    ht->used[i] = 0;                                                           \
+    ht->nelems--;                                                              \
+    return (out != NULL) ? out : &name##_removed;                              \
+}                                                                              \
+/* Swallows the semicolon after the macro */                                   \
+typedef int name##_macro_end_
+
+#endif
+
+/**
+ * @file typed_adt.h
+ *
+ * Unlike the other modules, whose objects are opaque, the generated types are
+ * defined in full so that their operations can be inlined.  They should still
+ * only be accessed through their `name_` functions.
+ *
+ * ### Key Points
+ *  + Type safe: each container holds values of a single type, copied in and
+ *    out by assignment.
+ *  + Values are stored inline with the size and alignment of their type, with
+ *    no per-element allocation or pointer to follow.
+ *  + Every operation is `static inline`, with the hash and compare functions
+ *    of a hash table inlined into it.  Resizes are out-of-line functions.
+ *  + Uses `errno` for managing underflows and errors, as the other modules.
+ *  + Header only, nothing to link.
+ *
+ * ### Considerations
+ *  + Each container is defined once per translation unit using it, and its
+ *    code is compiled in each of them.
+ *  + The slot pointers returned are invalidated by resizes, see each
+ *    operation.
+ *  + Allocates with `malloc`, takes no client allocator, resize policy or
+ *    statistics.
+ *  + A hash table never shrinks.
+ *
+ */
@@ -0,0 +1,146 @@
+#ifndef WSDEQUE_ADT_H
+#define WSDEQUE_ADT_H
+
+/** @cond */
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+/** @endcond */
+#include "common/data_types.h"
+
+/** @cond */
+typedef struct ws_deque_type WSDequeADT;
+/** @endcond */
+
+/**
+ * @brief Creates a work-stealing deque, owned by one thread and stolen from by
+ * any other.
+ *
+ * The owner thread uses the deque as a variable-size stack, that __doubles__
+ * in size whenever _full_, as one created with `cadtstack_new`.  Any other
+ * thread may take the oldest item with `cadtwsdeque_steal`.  The actual size
+ * may _differ_, as it will be rounded up to a power of two.
+ *
+ * In case of failure to allocate memory `errno` is set to `ENOMEM` and the
+ * interpreted error message is outputted to `stderr`. If the size argument
+ * passed is zero or has no power of two above it, `errno` is set to `EINVAL`.
+ * For both cases, `NULL` is returned.
+ *
+ * @param size The number of elements for initialization.
+ * @return Returns a `WSDequeADT` handle on success, `NULL` on failure.
+ */
+WSDequeADT *cadtwsdeque_new(size_t size);
+
+/**
+ * @brief Deallocates a `WSDequeADT` object.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by all
+ *       elements of in `d`, and for making sure no thread still uses `d`.
+ *
+ * @param d The deque to deallocate.
+ * @return Returns no value.
+ */
+void cadtwsdeque_destroy(WSDequeADT *d);
+
+/**
+ * @brief Returns the number of elements `d` currently holds.
+ *
+ * May be called from any thread.  While other threads are operating on `d`
+ * the count is only a snapshot.
+ *
+ * @param d The deque to check.
+ * @return Returns the number of elements currently held by `d`.
+ */
+size_t cadtwsdeque_nelems(WSDequeADT *d);
+
+/**
+ * @brief Pushes an element onto the bottom of `d`.
+ *
+ * Must only be called from the owner thread.  If `d` has no room for `e` and
+ * the system fails to allocate memory `NULL` is returned and `errno` is set to
+ * `ENOMEM`.
+ *
+ * @param d The deque to push to.
+ * @param e The element to push onto `d`.
+ * @return Returns `e` on success, `NULL` on failure.
+ */
+Element cadtwsdeque_push(WSDequeADT *d, Element e);
+
+/**
+ * @brief Pops the element at the bottom of `d`, the newest one.
+ *
+ * Must only be called from the owner thread.  If `d` is empty (__Deque
+ * underflow__), or its last element was just stolen, `NULL` is returned and
+ * `errno` is set to `EPERM`.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by the
+ *       elements of the deque `d`.
+ *
+ * @param d The deque to pop from.
+ * @return Returns an `Element` on success, `NULL` on underflow.
+ */
+Element cadtwsdeque_pop(WSDequeADT *d);
+
+/**
+ * @brief Steals the element at the top of `d`, the oldest one.
+ *
+ * May be called from any thread.  If `d` is empty (__Deque underflow__),
+ * `NULL` is returned and `errno` is set to `EPERM`.  If another thread took
+ * the element first, `NULL` is returned and `errno` is set to `EAGAIN`, the
+ * caller may then try again or move on to another deque.
+ *
+ * @note Client-side is responsible for deallocating the memory in-use by the
+ *       elements of the deque `d`.
+ *
+ * @param d The deque to steal from.
+ * @return Returns an `Element` on success, `NULL` on failure.
+ */
+Element cadtwsdeque_steal(WSDequeADT *d);
+
+#endif
+
+/**
+ * @file wsdeque_adt.h
+ *
+ * An opaque data structure which represents a lock-free work-stealing deque,
+ * meant as a per-thread task stack in a work-stealing scheduler. It should
+ * only be accessed through the `cadtwsdeque_` functions.
+ *
+ * @code{.c}
+ * struct ws_deque_type WSDequeADT
+ * {
+ *      // No available fields
+ * }
+ * @endcode
+ *
+ * @note To view the HTML rendered version of the C code for the implementation
+ * of this module, please visit:
+ * <a href="wsdeque_adt_8c-example.html">wsdeque_adt.c</a>.
+ *
+ * ---
+ *
+ * ### Key Points
+ *  + Relies on `void` pointers to allow manipulating elements of any type. See
+ *    @ref data_types.h.
+ *  + Uses `errno` for managing underflows and lost races.
+ *  + Chase and Lev's dynamic circular work-stealing deque, with the memory
+ *    orderings of Lê, Pop, Cohen and Zappa Nardelli.
+ *  + The owner pushes with a plain release store, and pops with one fence
+ *    and no compare-and-swap unless a single element is left.
+ *    Thieves claim the top element with a compare-and-swap.
+ *  + The top and bottom indexes sit on cache lines of their own.
+ *
+ * ### Considerations
+ *  + Clients are responsible for managing the memory space of the objects
+ *    loaded to the structure.
+ *  + No type safety.
+ *  + Exactly one thread may push and pop.
+ *  + The deque never shrinks, and the arrays it outgrows are only released by
+ *    `cadtwsdeque_destroy`, as a thief may still be reading them.  This at
+ *    most doubles its memory use.
+ *  + Takes no client allocator, see @ref allocator.h.
+ *  + Relies on the GCC `__atomic` builtins, also provided by Clang.
+ *
+ */
@@ -0,0 +1,482 @@
+/* pthread_rwlock_t and posix_memalign() for pure c99 compilers */
+#if !defined(_POSIX_C_SOURCE) || _POSIX_C_SOURCE < 200112L
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "concurrenthashtable_adt.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+/* Number of locks, each guarding the buckets of equal index modulo NSTRIPES */
+#define NSTRIPES 64
+/* Keys up to this size are stored inside the entry */
+#define INLINE_KEY_SIZE 16
+/* Stripes are padded to a multiple of this size so no two share a line */
+#define CACHE_LINE_SIZE 64
+
+/*********************************************************** Data Definitions */
+
+/*
+ * A concurrent hash table `Entry` is a list in which each element is:
+ * + The (mixed) hash of the key, kept to rehash without calling the client.
+ * + The key size.
+ * + A copy of the key, inline if it fits, otherwise a pointer to a copy.
+ * + A void pointer to the item held.
+ * + A self-referential pointer.
+ */
+typedef struct entry
+{
+    size_t hash;
+    size_t keysize;
+    union
+    {
+        char bytes[INLINE_KEY_SIZE];
+        char *ptr;
+    } key;
+    Element item;
+    struct entry *next;
+} Entry;
+
+/*
+ * A `Stripe` is:
+ * + A reader/writer lock, taken for reading by lookups and for writing by
+ *   insertions and deletions on its buckets, and by resizes on all of them.
+ * + The number of elements held in its buckets.
+ *
+ * Padded to whole cache lines, so that threads working on different stripes do
+ * not invalidate each other's lines.
+ */
+struct stripe_state
+{
+    pthread_rwlock_t lock;
+    size_t nelems;
+};
+
+typedef union stripe
+{
+    struct stripe_state s;
+    char pad[(sizeof(struct stripe_state) + CACHE_LINE_SIZE - 1)
+             / CACHE_LINE_SIZE * CACHE_LINE_SIZE];
+} Stripe;
+
+/*
+ * # Datatype completion
+ *
+ * A `ConcurrentHashTableADT` is:
+ *  + The number of buckets, a power of two multiple of `NSTRIPES`.
+ *  + A pointer to a hash function with a compatible signature.
+ *  + An array of `nbuckets` pointers to `Entry`.
+ *  + An array of `NSTRIPES` stripes.
+ *
+ * The bucket of a key is given by the low bits of its mixed hash, and its
+ * stripe by the lowest of those.  A key thus stays in the same stripe when the
+ * table doubles, and a single stripe lock guards all the buckets it may be in.
+ * `nbuckets` and `entries` only change while every stripe lock is held, so
+ * holding any one of them is enough to read them.
+ */
+struct concurrent_hash_table_type
+{
+    size_t nbuckets;
+    HashFunction *hash;
+    Entry **entries;
+    Stripe *stripes;
+};
+
+/********************************************************** Private Functions */
+
+/*
+ * Returns the stripe guarding the buckets a key hashed to `hash` may be in.
+ */
+static inline struct stripe_state *get_stripe(ConcurrentHashTableADT *ht,
+                                              size_t hash)
+{
+    return &ht->stripes[hash & (NSTRIPES - 1)].s;
+}
+
+static inline const char *entry_key(const Entry *e)
+{
+    return e->keysize <= INLINE_KEY_SIZE ? e->key.bytes : e->key.ptr;
+}
+
+/*
+ * Returns the closest power of two greater than or equal to `n`, and no
+ * smaller than `NSTRIPES`.
+ */
+static inline size_t get_next_pow2(size_t n)
+{
+    size_t pow2 = NSTRIPES;
+
+    while (pow2 < n)
+    {
+        pow2 *= 2;
+    }
+    return pow2;
+}
+
+/*
+ * Returns a pointer to the link pointing to the entry holding `key` in the
+ * bucket of `hash`, or NULL if there is none.  The stripe lock of `hash` must
+ * be held.
+ */
+static Entry **find_link(ConcurrentHashTableADT *ht, size_t hash,
+                         const void *key, size_t keysize)
+{
+    Entry **pp = &ht->entries[hash & (ht->nbuckets - 1)];
+
+    for (; *pp != NULL; pp = &(*pp)->next)
+    {
+        if ((*pp)->hash == hash && (*pp)->keysize == keysize
+            && memcmp(entry_key(*pp), key, keysize) == 0)
+        {
+            return pp;
+        }
+    }
+    return NULL;
+}
+
+static void lock_all(ConcurrentHashTableADT *ht)
+{
+    size_t i;
+
+    /* Always in the same order, so that two resizes cannot deadlock */
+    for (i = 0; i < NSTRIPES; i++)
+    {
+        pthread_rwlock_wrlock(&ht->stripes[i].s.lock);
+    }
+}
+
+static void unlock_all(ConcurrentHashTableADT *ht)
+{
+    size_t i;
+
+    for (i = 0; i < NSTRIPES; i++)
+    {
+        pthread_rwlock_unlock(&ht->stripes[i].s.lock);
+    }
+}
+
+/*
+ * Doubles the number of buckets of `ht`, unless another thread already did so
+ * since `ht` was seen with `nbuckets` buckets.  Growing is best effort: if
+ * the new array cannot be allocated the table keeps its current one.
+ */
+static void grow(ConcurrentHashTableADT *ht, size_t nbuckets)
+{
+    Entry **new;
+    size_t i;
+
+    lock_all(ht);
+
+    if (ht->nbuckets != nbuckets)
+    {
+        unlock_all(ht);
+        return;
+    }
+
+    if ((new = calloc(nbuckets * 2, sizeof(Entry*))) == NULL)
+    {
+        perror("grow calloc failed allocating entry array");
+        unlock_all(ht);
+        return;
+    }
+
+    for (i = 0; i < nbuckets; i++)
+    {
+        Entry *e = ht->entries[i];
+
+        while (e != NULL)
+        {
+            Entry *next = e->next;
+            size_t index = e->hash & (nbuckets * 2 - 1);
+
+            e->next = new[index];
+            new[index] = e;
+            e = next;
+        }
+    }
+
+    free(ht->entries);
+    ht->entries = new;
+    ht->nbuckets = nbuckets * 2;
+
+    unlock_all(ht);
+}
+
+/***************************************************** Public Implementations */
+
+/*
+ * Create a hash table
+ */
+ConcurrentHashTableADT *cadtconcurrenthashtable_new(size_t nbuckets,
+                                                    HashFunction *fp)
+{
+    ConcurrentHashTableADT *new;
+    void *stripes;
+    size_t i;
+    int err;
+
+    if (nbuckets == 0 || fp == NULL)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if ((new = malloc(sizeof(struct concurrent_hash_table_type))) == NULL)
+    {
+        perror("cadtconcurrenthashtable_new malloc failed allocating struct concurrent_hash_table_type");
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    new->nbuckets = get_next_pow2(nbuckets);
+
+    if ((new->entries = calloc(new->nbuckets, sizeof(Entry*))) == NULL)
+    {
+        perror("cadtconcurrenthashtable_new calloc failed allocating entry array");
+        free(new);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    if ((err = posix_memalign(&stripes, CACHE_LINE_SIZE,
+                              NSTRIPES * sizeof(Stripe))) != 0)
+    {
+        errno = err;
+        perror("cadtconcurrenthashtable_new posix_memalign failed allocating stripes");
+        free(new->entries);
+        free(new);
+        errno = ENOMEM;
+        return NULL;
+    }
+    new->stripes = stripes;
+
+    for (i = 0; i < NSTRIPES; i++)
+    {
+        if ((err = pthread_rwlock_init(&new->stripes[i].s.lock, NULL)) != 0)
+        {
+            errno = err;
+            perror("cadtconcurrenthashtable_new pthread_rwlock_init failed");
+            while (i-- > 0)
+            {
+                pthread_rwlock_destroy(&new->stripes[i].s.lock);
+            }
+            free(new->stripes);
+            free(new->entries);
+            free(new);
+            errno = err;
+            return NULL;
+        }
+        new->stripes[i].s.nelems = 0;
+    }
+
+    new->hash = fp;
+
+    return new;
+}
+
+/*
+ * Destroy hash table
+ */
+void cadtconcurrenthashtable_destroy(ConcurrentHashTableADT *ht)
+{
+    size_t i;
+
+    for (i = 0; i < ht->nbuckets; i++)
+    {
+        Entry *e = ht->entries[i];
+
+        while (e != NULL)
+        {
+            Entry *next = e->next;
+
+            if (e->keysize > INLINE_KEY_SIZE)
+            {
+                free(e->key.ptr);
+            }
+            free(e);
+            e = next;
+        }
+    }
+    for (i = 0; i < NSTRIPES; i++)
+    {
+        pthread_rwlock_destroy(&ht->stripes[i].s.lock);
+    }
+    free(ht->stripes);
+    free(ht->entries);
+    free(ht);
+    return;
+}
+
+/*
+ * Return the number of elements `ht` currently holds
+ */
+size_t cadtconcurrenthashtable_nelems(ConcurrentHashTableADT *ht)
+{
+    size_t i, nelems = 0;
+
+    for (i = 0; i < NSTRIPES; i++)
+    {
+        pthread_rwlock_rdlock(&ht->stripes[i].s.lock);
+        nelems += ht->stripes[i].s.nelems;
+        pthread_rwlock_unlock(&ht->stripes[i].s.lock);
+    }
+    return nelems;
+}
+
+/*
+ * Insert operation
+ */
+Element cadtconcurrenthashtable_insert(ConcurrentHashTableADT *ht,
+                                       const void *key, size_t keysize,
+                                       Element e)
+{
+    struct stripe_state *stripe;
+    size_t hash, index, nbuckets;
+    Entry *new;
+    int overloaded;
+
+    if (ht == NULL || key == NULL || keysize == 0 || e == NULL)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    /* Allocate and fill the entry before taking the lock */
+    if ((new = malloc(sizeof(Entry))) == NULL)
+    {
+        perror("cadtconcurrenthashtable_insert malloc failed allocating struct entry");
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (keysize > INLINE_KEY_SIZE)
+    {
+        if ((new->key.ptr = malloc(keysize)) == NULL)
+        {
+            perror("cadtconcurrenthashtable_insert malloc failed allocating key");
+            free(new);
+            errno = ENOMEM;
+            return NULL;
+        }
+        memcpy(new->key.ptr, key, keysize);
+    }
+    else
+    {
+        memcpy(new->key.bytes, key, keysize);
+    }
+    hash = cadt_hash_mix(ht->hash(key, keysize));
+    new->hash = hash;
+    new->keysize = keysize;
+    new->item = e;
+
+    stripe = get_stripe(ht, hash);
+    pthread_rwlock_wrlock(&stripe->lock);
+
+    if (find_link(ht, hash, key, keysize) != NULL)
+    {
+        pthread_rwlock_unlock(&stripe->lock);
+        if (keysize > INLINE_KEY_SIZE)
+        {
+            free(new->key.ptr);
+        }
+        free(new);
+        errno = EEXIST;
+        return NULL;
+    }
+
+    index = hash & (ht->nbuckets - 1);
+    new->next = ht->entries[index];
+    ht->entries[index] = new;
+    stripe->nelems++;
+
+    /* Keep the average chain length of the stripe under one entry */
+    nbuckets = ht->nbuckets;
+    overloaded = stripe->nelems > nbuckets / NSTRIPES;
+
+    pthread_rwlock_unlock(&stripe->lock);
+
+    if (overloaded)
+    {
+        grow(ht, nbuckets);
+    }
+
+    return e;
+}
+
+/*
+ * Lookup and return item, no removal.
+ */
+Element cadtconcurrenthashtable_lookup(ConcurrentHashTableADT *ht,
+                                       const void *key, size_t keysize)
+{
+    struct stripe_state *stripe;
+    Element item = NULL;
+    Entry **pp;
+    size_t hash;
+
+    if (ht == NULL || key == NULL || keysize == 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    hash = cadt_hash_mix(ht->hash(key, keysize));
+    stripe = get_stripe(ht, hash);
+
+    pthread_rwlock_rdlock(&stripe->lock);
+    if ((pp = find_link(ht, hash, key, keysize)) != NULL)
+    {
+        item = (*pp)->item;
+    }
+    pthread_rwlock_unlock(&stripe->lock);
+
+    return item;
+}
+
+/*
+ * Removes an entry returning its item on success.
+ */
+Element cadtconcurrenthashtable_delete(ConcurrentHashTableADT *ht,
+                                       const void *key, size_t keysize,
+                                       Element e)
+{
+    struct stripe_state *stripe;
+    Entry **pp;
+    Entry *temp = NULL;
+    Element item = NULL;
+    size_t hash;
+
+    if (ht == NULL || key == NULL || keysize == 0 || e == NULL)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    hash = cadt_hash_mix(ht->hash(key, keysize));
+    stripe = get_stripe(ht, hash);
+
+    pthread_rwlock_wrlock(&stripe->lock);
+    if ((pp = find_link(ht, hash, key, keysize)) != NULL)
+    {
+        temp = *pp;
+        *pp = temp->next;
+        item = temp->item;
+        stripe->nelems--;
+    }
+    pthread_rwlock_unlock(&stripe->lock);
+
+    if (temp == NULL)
+    {
+        return NULL;
+    }
+
+    /* Free outside of the lock */
+    if (temp->keysize > INLINE_KEY_SIZE)
+    {
+        free(temp->key.ptr);
+    }
+    free(temp);
+
+    return item;
+}
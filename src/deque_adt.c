@@ -0,0 +1,461 @@
+#include "deque_adt.h"
+
+#include <stdint.h>
+
+/*********************************************************** Data Definitions */
+/*
+ * # Datatype completion
+ *
+ * A `DequeADT` object is:
+ *  + A dynamically allocated array of void pointers.
+ *  + The index of the front item.
+ *  + The number of elements currently in the deque.
+ *  + The array's minimum size.
+ *  + The array's current maximum size.
+ *  + A flag that determines whether the deque is dynamic or not.
+ *  + The policy a dynamic deque grows and shrinks by.
+ *  + The number of elements below which a pop shrinks the array, derived from
+ *    the policy on every resize so pops compare integers only.  Zero if pops
+ *    never shrink.
+ *  + The allocator every block of the deque comes from.
+ *
+ * The items run from `head` towards higher indexes, wrapping around to the
+ * start of the array.  Unlike `QueueADT` no rear index is kept: it is `nelems
+ * - 1` slots past `head`, so pushing and popping at either end moves a single
+ * index.
+ */
+struct deque_type
+{
+    Element *contents;
+    size_t head;
+    size_t nelems;
+    size_t min_size;
+    size_t curr_max_size;
+    int is_fix;
+    ResizePolicy policy;
+    size_t shrink_at;
+    Allocator allocator;
+};
+
+/********************************************************** Private Functions */
+
+/*
+ * Returns non-zero if `d` is full
+ */
+static inline int is_full(DequeADT *d)
+{
+    return (d->nelems == d->curr_max_size);
+}
+
+/*
+ * Returns non-zero if `d` is a fixed-size deque
+ */
+static inline int is_fix(DequeADT *d)
+{
+    return d->is_fix;
+}
+
+/*
+ * Returns the index `n` slots past index `i` (wrap-around), for `n` up to the
+ * size of `d`.
+ */
+static inline size_t index_after(DequeADT *d, size_t i, size_t n)
+{
+    i += n;
+    return (i >= d->curr_max_size) ? (i - d->curr_max_size) : i;
+}
+
+/*
+ * Returns the index one slot before index `i` (wrap-around).
+ */
+static inline size_t index_before(DequeADT *d, size_t i)
+{
+    return (i == 0) ? (d->curr_max_size - 1) : (i - 1);
+}
+
+/*
+ * Returns the index of the rear item of a non-empty `d`
+ */
+static inline size_t rear_index(DequeADT *d)
+{
+    return index_after(d, d->head, d->nelems - 1);
+}
+
+/*
+ * Returns the size `d` never shrinks below.
+ */
+static inline size_t floor_size(DequeADT *d)
+{
+    return cadt_policy_floor(&d->policy, d->min_size);
+}
+
+/*
+ * Returns the number of elements below which a pop shrinks an array of `size`
+ * elements, zero if it never does.
+ */
+static inline size_t shrink_threshold(DequeADT *d, size_t size)
+{
+    return cadt_policy_shrink_threshold(&d->policy, size, floor_size(d));
+}
+
+/*
+ * Returns the size a full `d` grows to.
+ */
+static inline size_t grown_size(DequeADT *d)
+{
+    return cadt_policy_grown_size(&d->policy, d->curr_max_size);
+}
+
+/*
+ * Returns the size `d` shrinks to, never below its floor nor its elements.
+ */
+static inline size_t shrunk_size(DequeADT *d)
+{
+    return cadt_policy_shrunk_size(&d->policy, d->curr_max_size, floor_size(d),
+                                   d->nelems);
+}
+
+/*
+ * Copies into `new[]` `d->contents[]` shifting to lower indexes if necessary.
+ */
+static inline void shift_elements(DequeADT *d, Element new[])
+{
+    cadt_ring_unwrap(new, d->contents, d->curr_max_size, d->head, d->nelems);
+}
+
+/*
+ * Reallocates `d->contents[]` to an array of `new_size` elements, which must be
+ * enough to hold those in `d`.  On failure `d` is left untouched.
+ */
+static Element *resize_contents_to(DequeADT *d, size_t new_size)
+{
+    Element *new;
+
+    if (new_size > SIZE_MAX / sizeof(Element))
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    new = cadt_alloc(&d->allocator, new_size * sizeof(Element));
+    if (new == NULL)
+    {
+        perror("resize_contents_to malloc failed allocating Element array");
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    shift_elements(d, new);
+    cadt_free(&d->allocator, d->contents, d->curr_max_size * sizeof(Element));
+
+    d->contents = new;
+    d->head = 0;
+    d->curr_max_size = new_size;
+    d->shrink_at = shrink_threshold(d, new_size);
+
+    return d->contents;
+}
+
+/*
+ * Makes room for one more element in `d`, returns `NULL` if there is none.
+ */
+static inline Element *make_room(DequeADT *d)
+{
+    /* handle deque overflow */
+    if (is_fix(d) && is_full(d))
+    {
+        errno = EPERM;
+        return NULL;
+    }
+    /* handle dynamic deque */
+    if (!is_fix(d) && is_full(d))
+    {
+        return resize_contents_to(d, grown_size(d));
+    }
+    return d->contents;
+}
+
+/*
+ * Shrinks `d` if its usage is below the policy's threshold, on failure `d`
+ * keeps its size.
+ */
+static inline void maybe_shrink(DequeADT *d)
+{
+    if (!is_fix(d) && d->nelems < d->shrink_at
+        && shrunk_size(d) < d->curr_max_size)
+    {
+        resize_contents_to(d, shrunk_size(d));
+    }
+}
+
+/***************************************************** Public Implementations */
+
+/*
+ * Create non-circular (dynamic) deque
+ */
+DequeADT *cadtdeque_new(size_t size)
+{
+    static const Allocator default_allocator = CADT_ALLOCATOR_DEFAULT;
+
+    return cadtdeque_new_with_allocator(size, &default_allocator);
+}
+
+/*
+ * Create non-circular (dynamic) deque, allocating through `a`
+ */
+DequeADT *cadtdeque_new_with_allocator(size_t size, const Allocator *a)
+{
+    DequeADT *new;
+
+    if (size == 0 || a == NULL || !cadt_is_valid_allocator(a))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    new = cadt_alloc(a, sizeof(struct deque_type));
+    if (new == NULL)
+    {
+        perror("cadtdeque_new malloc failed allocating struct deque_type");
+        return NULL;
+    }
+    new->allocator = *a;
+
+    new->contents = cadt_alloc(a, size * sizeof(Element));
+    if (new->contents == NULL)
+    {
+        perror("cadtdeque_new malloc failed allocating Element array");
+        cadt_free(a, new, sizeof(struct deque_type));
+        return NULL;
+    }
+
+    new->head = 0;
+    new->nelems = 0;
+    new->min_size = size;
+    new->curr_max_size = size;
+    new->is_fix = 0;
+    cadtdeque_set_policy(new, NULL);
+
+    return new;
+}
+
+/*
+ * Create circular (fixed-size) deque
+ */
+DequeADT *cadtdeque_new_circular(size_t size)
+{
+    DequeADT *new = cadtdeque_new(size);
+    if (new == NULL)
+    {
+        return NULL;
+    }
+    new->is_fix = 1;
+
+    return new;
+}
+
+/*
+ * Destroy deque
+ */
+void cadtdeque_destroy(DequeADT *d)
+{
+    cadt_free(&d->allocator, d->contents, d->curr_max_size * sizeof(Element));
+    cadt_free(&d->allocator, d, sizeof(struct deque_type));
+    return;
+}
+
+/*
+ * Return the number of elements `d` currently holds
+ */
+size_t cadtdeque_nelems(DequeADT *d)
+{
+    return d->nelems;
+}
+
+/*
+ * Make `d` empty
+ */
+DequeADT *cadtdeque_clear(DequeADT *d)
+{
+    /* d has grown, make a new deque for resizing*/
+    if (!is_fix(d) && !d->policy.lazy && d->curr_max_size > floor_size(d))
+    {
+        Element *new = cadt_alloc(&d->allocator,
+                                  floor_size(d) * sizeof(Element));
+        if (new == NULL)
+        {
+            perror("cadtdeque_clear malloc failed allocating Element array");
+            return NULL;
+        }
+
+        cadt_free(&d->allocator, d->contents,
+                  d->curr_max_size * sizeof(Element));
+        d->contents = new;
+        d->curr_max_size = floor_size(d);
+        d->shrink_at = shrink_threshold(d, d->curr_max_size);
+    }
+    /* d hasn't grown or is fixed in size */
+    d->head = 0;
+    d->nelems = 0;
+    return d;
+}
+
+/*
+ * Return the front item in the deque without changing the deque
+ */
+Element cadtdeque_peek_front(DequeADT *d)
+{
+    /* handle deque underflow */
+    if (d->nelems == 0)
+    {
+        errno = EPERM;
+        return NULL;
+    }
+
+    return d->contents[d->head];
+}
+
+/*
+ * Return the rear item in the deque without changing the deque
+ */
+Element cadtdeque_peek_rear(DequeADT *d)
+{
+    /* handle deque underflow */
+    if (d->nelems == 0)
+    {
+        errno = EPERM;
+        return NULL;
+    }
+
+    return d->contents[rear_index(d)];
+}
+
+/*
+ * Return the item `i` positions past the front of `d`
+ */
+Element cadtdeque_at(DequeADT *d, size_t i)
+{
+    if (i >= d->nelems)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    return d->contents[index_after(d, d->head, i)];
+}
+
+/*
+ * Prepend element to `d`
+ */
+Element cadtdeque_push_front(DequeADT *d, Element e)
+{
+    if (make_room(d) == NULL)
+    {
+        return NULL;
+    }
+
+    d->head = index_before(d, d->head);
+    d->contents[d->head] = e;
+    d->nelems++;
+
+    return e;
+}
+
+/*
+ * Append element to `d`
+ */
+Element cadtdeque_push_rear(DequeADT *d, Element e)
+{
+    if (make_room(d) == NULL)
+    {
+        return NULL;
+    }
+
+    d->contents[index_after(d, d->head, d->nelems)] = e;
+    d->nelems++;
+
+    return e;
+}
+
+/*
+ * Remove element at the front of `d`
+ */
+Element cadtdeque_pop_front(DequeADT *d)
+{
+    Element ret;
+
+    /* handle deque underflow */
+    if (d->nelems == 0)
+    {
+        errno = EPERM;
+        return NULL;
+    }
+    maybe_shrink(d);
+
+    ret = d->contents[d->head];
+    d->head = index_after(d, d->head, 1);
+    d->nelems--;
+
+    return ret;
+}
+
+/*
+ * Remove element at the rear of `d`
+ */
+Element cadtdeque_pop_rear(DequeADT *d)
+{
+    Element ret;
+
+    /* handle deque underflow */
+    if (d->nelems == 0)
+    {
+        errno = EPERM;
+        return NULL;
+    }
+    maybe_shrink(d);
+
+    ret = d->contents[rear_index(d)];
+    d->nelems--;
+
+    return ret;
+}
+
+/*
+ * Set how `d` grows and shrinks
+ */
+DequeADT *cadtdeque_set_policy(DequeADT *d, const ResizePolicy *policy)
+{
+    static const ResizePolicy default_policy = CADT_RESIZE_POLICY_DEFAULT;
+
+    if (policy == NULL)
+    {
+        policy = &default_policy;
+    }
+    if (!cadt_policy_is_valid(policy))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    d->policy = *policy;
+    d->shrink_at = shrink_threshold(d, d->curr_max_size);
+
+    return d;
+}
+
+/*
+ * Release the room `d` does not use
+ */
+DequeADT *cadtdeque_trim(DequeADT *d)
+{
+    size_t new_size = (d->nelems > floor_size(d)) ? d->nelems : floor_size(d);
+
+    if (!is_fix(d) && new_size < d->curr_max_size)
+    {
+        if (resize_contents_to(d, new_size) == NULL)
+        {
+            return NULL;
+        }
+    }
+    return d;
+}
@@ -0,0 +1,508 @@
+#include "flathashtable_adt.h"
+
+#include <stdint.h>
+#if defined(__SSE2__) && !defined(CADT_NO_SIMD)
+#include <emmintrin.h>
+#endif
+
+/* Number of control bytes probed at once */
+#define GROUP_WIDTH 16
+/* Keys up to this size are stored inside the slot */
+#define INLINE_KEY_SIZE 16
+
+/* Control byte values, a full slot holds its 7-bit hash tag instead */
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
+
+/*********************************************************** Data Definitions */
+
+/*
+ * A `Slot` is:
+ * + The (mixed) hash of the key, kept to rehash without calling the client.
+ * + The key size.
+ * + A copy of the key, inline if it fits, otherwise a pointer to a copy.
+ * + A void pointer to the item held.
+ */
+typedef struct slot
+{
+    size_t hash;
+    size_t keysize;
+    union
+    {
+        char bytes[INLINE_KEY_SIZE];
+        char *ptr;
+    } key;
+    Element item;
+} Slot;
+
+/*
+ * # Datatype completion
+ *
+ * A `FlatHashTableADT` is:
+ *  + The number of slots, a power of two multiple of `GROUP_WIDTH`.
+ *  + The number of elements held.
+ *  + The number of slots holding a deletion marker (tombstones).
+ *  + A pointer to a hash function with a compatible signature.
+ *  + An array of `capacity` control bytes, one per slot.
+ *  + An array of `capacity` slots.
+ *  + The allocator every block of the table comes from.
+ *
+ * Slots are probed a group of `GROUP_WIDTH` control bytes at a time.  The probe
+ * sequence visits whole aligned groups in triangular order, and stops at the
+ * first group with an empty slot.
+ */
+struct flat_hash_table_type
+{
+    size_t capacity;
+    size_t nelems;
+    size_t ndeleted;
+    HashFunction *hash;
+    unsigned char *ctrl;
+    Slot *slots;
+    Allocator allocator;
+};
+
+/********************************************************** Private Functions */
+
+/*
+ * Returns the 7-bit tag stored in the control byte of a full slot.
+ */
+static inline unsigned char hash_tag(size_t hash)
+{
+    return (unsigned char) (hash & 0x7F);
+}
+
+/*
+ * Returns the first group of the probe sequence of `hash`.
+ */
+static inline size_t hash_group(FlatHashTableADT *ht, size_t hash)
+{
+    return (hash >> 7) & (ht->capacity / GROUP_WIDTH - 1);
+}
+
+/*
+ * Returns a bitmask with bit `i` set if `ctrl[i] == byte`, for the group of
+ * `GROUP_WIDTH` control bytes starting at `ctrl`.
+ */
+static inline unsigned int group_match_scalar(const unsigned char *ctrl,
+                                              unsigned char byte)
+{
+    unsigned int mask = 0;
+    unsigned int i;
+
+    for (i = 0; i < GROUP_WIDTH; i++)
+    {
+        mask |= (unsigned int) (ctrl[i] == byte) << i;
+    }
+    return mask;
+}
+
+static inline unsigned int group_match(const unsigned char *ctrl,
+                                       unsigned char byte)
+{
+#if defined(__SSE2__) && !defined(CADT_NO_SIMD)
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+    __m128i match = _mm_cmpeq_epi8(group, _mm_set1_epi8((char) byte));
+
+    return (unsigned int) _mm_movemask_epi8(match);
+#else
+    return group_match_scalar(ctrl, byte);
+#endif
+}
+
+/*
+ * Returns a bitmask of the empty or deleted slots of a group.  Both have their
+ * high bit set, while tags of full slots do not.
+ */
+static inline unsigned int group_match_free(const unsigned char *ctrl)
+{
+#if defined(__SSE2__) && !defined(CADT_NO_SIMD)
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+
+    return (unsigned int) _mm_movemask_epi8(group);
+#else
+    unsigned int mask = 0;
+    unsigned int i;
+
+    for (i = 0; i < GROUP_WIDTH; i++)
+    {
+        mask |= (unsigned int) (ctrl[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+/*
+ * Returns the index of the lowest bit set in a non-zero `mask`.
+ */
+static inline unsigned int lowest_bit(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return (unsigned int) __builtin_ctz(mask);
+#else
+    unsigned int i = 0;
+
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+/*
+ * Returns a pointer to the stored copy of the key of `s`.
+ */
+static inline const char *slot_key(const Slot *s)
+{
+    return s->keysize <= INLINE_KEY_SIZE ? s->key.bytes : s->key.ptr;
+}
+
+/*
+ * Returns the index of the slot holding `key`, or `ht->capacity` if absent.
+ */
+static size_t find_slot(FlatHashTableADT *ht, size_t hash,
+                        const void *key, size_t keysize)
+{
+    size_t groupmask = ht->capacity / GROUP_WIDTH - 1;
+    size_t group = hash_group(ht, hash);
+    size_t stride = 0;
+    unsigned char tag = hash_tag(hash);
+
+    for (;;)
+    {
+        const unsigned char *ctrl = &ht->ctrl[group * GROUP_WIDTH];
+        unsigned int match = group_match(ctrl, tag);
+
+        while (match != 0)
+        {
+            size_t index = group * GROUP_WIDTH + lowest_bit(match);
+            const Slot *s = &ht->slots[index];
+
+            if (s->hash == hash && s->keysize == keysize
+                    && memcmp(slot_key(s), key, keysize) == 0)
+            {
+                return index;
+            }
+            match &= match - 1;
+        }
+
+        if (group_match(ctrl, CTRL_EMPTY) != 0)
+        {
+            return ht->capacity;
+        }
+
+        stride++;
+        group = (group + stride) & groupmask;
+    }
+}
+
+/*
+ * Returns the index of the first empty or deleted slot in the probe sequence
+ * of `hash`.  There is always one, the table is never allowed to fill up.
+ */
+static size_t find_free_slot(const unsigned char *ctrl, size_t capacity,
+                             size_t hash)
+{
+    size_t groupmask = capacity / GROUP_WIDTH - 1;
+    size_t group = (hash >> 7) & groupmask;
+    size_t stride = 0;
+    unsigned int free_mask;
+
+    while ((free_mask = group_match_free(&ctrl[group * GROUP_WIDTH])) == 0)
+    {
+        stride++;
+        group = (group + stride) & groupmask;
+    }
+
+    return group * GROUP_WIDTH + lowest_bit(free_mask);
+}
+
+/*
+ * Moves every element of `ht` into freshly allocated arrays of `capacity`
+ * slots, dropping all deletion markers.  Returns `NULL` if allocation fails,
+ * leaving `ht` untouched.
+ */
+static FlatHashTableADT *rehash(FlatHashTableADT *ht, size_t capacity)
+{
+    unsigned char *ctrl;
+    Slot *slots;
+    size_t i;
+
+    if ((ctrl = cadt_alloc(&ht->allocator, capacity)) == NULL)
+    {
+        perror("rehash malloc failed allocating control bytes");
+        return NULL;
+    }
+    if ((slots = cadt_alloc(&ht->allocator, capacity * sizeof(Slot))) == NULL)
+    {
+        perror("rehash malloc failed allocating slot array");
+        cadt_free(&ht->allocator, ctrl, capacity);
+        return NULL;
+    }
+    memset(ctrl, CTRL_EMPTY, capacity);
+
+    for (i = 0; i < ht->capacity; i++)
+    {
+        if (ht->ctrl[i] < CTRL_EMPTY)
+        {
+            size_t index = find_free_slot(ctrl, capacity, ht->slots[i].hash);
+
+            ctrl[index] = ht->ctrl[i];
+            slots[index] = ht->slots[i];
+        }
+    }
+
+    cadt_free(&ht->allocator, ht->ctrl, ht->capacity);
+    cadt_free(&ht->allocator, ht->slots, ht->capacity * sizeof(Slot));
+    ht->ctrl = ctrl;
+    ht->slots = slots;
+    ht->capacity = capacity;
+    ht->ndeleted = 0;
+
+    return ht;
+}
+
+/*
+ * Returns the smallest valid capacity holding at least `n` slots.
+ */
+static inline size_t round_capacity(size_t n)
+{
+    size_t capacity = GROUP_WIDTH;
+
+    while (capacity < n)
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/***************************************************** Public Implementations */
+
+/*
+ * Create a hash table
+ */
+FlatHashTableADT *cadtflathashtable_new(size_t nslots, HashFunction *fp)
+{
+    static const Allocator default_allocator = CADT_ALLOCATOR_DEFAULT;
+
+    return cadtflathashtable_new_with_allocator(nslots, fp, &default_allocator);
+}
+
+/*
+ * Create a hash table, allocating through `a`
+ */
+FlatHashTableADT *cadtflathashtable_new_with_allocator(size_t nslots,
+                                                       HashFunction *fp,
+                                                       const Allocator *a)
+{
+    FlatHashTableADT *new;
+
+    if (nslots == 0 || fp == NULL || a == NULL || !cadt_is_valid_allocator(a))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if ((new = cadt_alloc(a, sizeof(struct flat_hash_table_type))) == NULL)
+    {
+        perror("cadtflathashtable_new malloc failed allocating struct flat_hash_table_type");
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    new->allocator = *a;
+    new->capacity = round_capacity(nslots);
+
+    if ((new->ctrl = cadt_alloc(a, new->capacity)) == NULL)
+    {
+        perror("cadtflathashtable_new malloc failed allocating control bytes");
+        cadt_free(a, new, sizeof(struct flat_hash_table_type));
+        errno = ENOMEM;
+        return NULL;
+    }
+    if ((new->slots = cadt_alloc(a, new->capacity * sizeof(Slot))) == NULL)
+    {
+        perror("cadtflathashtable_new malloc failed allocating slot array");
+        cadt_free(a, new->ctrl, new->capacity);
+        cadt_free(a, new, sizeof(struct flat_hash_table_type));
+        errno = ENOMEM;
+        return NULL;
+    }
+    memset(new->ctrl, CTRL_EMPTY, new->capacity);
+
+    new->nelems = 0;
+    new->ndeleted = 0;
+    new->hash = fp;
+
+    return new;
+}
+
+/*
+ * Destroy hash table
+ */
+void cadtflathashtable_destroy(FlatHashTableADT *ht)
+{
+    size_t i;
+
+    for (i = 0; i < ht->capacity; i++)
+    {
+        if (ht->ctrl[i] < CTRL_EMPTY && ht->slots[i].keysize > INLINE_KEY_SIZE)
+        {
+            cadt_free(&ht->allocator, ht->slots[i].key.ptr,
+                      ht->slots[i].keysize);
+        }
+    }
+    cadt_free(&ht->allocator, ht->ctrl, ht->capacity);
+    cadt_free(&ht->allocator, ht->slots, ht->capacity * sizeof(Slot));
+    cadt_free(&ht->allocator, ht, sizeof(struct flat_hash_table_type));
+    return;
+}
+
+/*
+ * Return the number of elements `ht` currently holds
+ */
+size_t cadtflathashtable_nelems(FlatHashTableADT *ht)
+{
+    return ht->nelems;
+}
+
+/*
+ * Insert operation
+ */
+Element cadtflathashtable_insert(FlatHashTableADT *ht, const void *key,
+                                 size_t keysize, Element e)
+{
+    size_t hash;
+    size_t index;
+    Slot *s;
+
+    if (ht == NULL || key == NULL || keysize == 0 || e == NULL)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    hash = cadt_hash_mix(ht->hash(key, keysize));
+
+    if (find_slot(ht, hash, key, keysize) != ht->capacity)
+    {
+        errno = EEXIST;
+        return NULL;
+    }
+
+    /* Keep at least 1/8 of the slots empty so every probe terminates */
+    if ((ht->nelems + ht->ndeleted + 1) * 8 > ht->capacity * 7)
+    {
+        /* Grow, unless dropping the deletion markers frees enough room */
+        size_t capacity = (ht->nelems + 1) * 16 > ht->capacity * 7
+                        ? ht->capacity * 2 : ht->capacity;
+
+        if (rehash(ht, capacity) == NULL)
+        {
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+
+    index = find_free_slot(ht->ctrl, ht->capacity, hash);
+    s = &ht->slots[index];
+
+    if (keysize > INLINE_KEY_SIZE)
+    {
+        if ((s->key.ptr = cadt_alloc(&ht->allocator, keysize)) == NULL)
+        {
+            perror("cadtflathashtable_insert malloc failed allocating key");
+            errno = ENOMEM;
+            return NULL;
+        }
+        memcpy(s->key.ptr, key, keysize);
+    }
+    else
+    {
+        memcpy(s->key.bytes, key, keysize);
+    }
+
+    if (ht->ctrl[index] == CTRL_DELETED)
+    {
+        ht->ndeleted--;
+    }
+    ht->ctrl[index] = hash_tag(hash);
+    s->hash = hash;
+    s->keysize = keysize;
+    s->item = e;
+    ht->nelems++;
+
+    return e;
+}
+
+/*
+ * Lookup and return item, no removal.
+ */
+Element cadtflathashtable_lookup(FlatHashTableADT *ht, const void *key,
+                                 size_t keysize)
+{
+    size_t index;
+
+    if (ht == NULL || key == NULL || keysize == 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    index = find_slot(ht, cadt_hash_mix(ht->hash(key, keysize)), key, keysize);
+
+    if (index == ht->capacity)
+    {
+        return NULL;
+    }
+    return ht->slots[index].item;
+}
+
+/*
+ * Removes an entry returning its item on success.
+ */
+Element cadtflathashtable_delete(FlatHashTableADT *ht, const void *key,
+                                 size_t keysize, Element e)
+{
+    size_t index;
+    Slot *s;
+
+    if (ht == NULL || key == NULL || keysize == 0 || e == NULL)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    index = find_slot(ht, cadt_hash_mix(ht->hash(key, keysize)), key, keysize);
+
+    if (index == ht->capacity)
+    {
+        return NULL;
+    }
+
+    s = &ht->slots[index];
+    if (s->keysize > INLINE_KEY_SIZE)
+    {
+        cadt_free(&ht->allocator, s->key.ptr, s->keysize);
+    }
+
+    /*
+     * A group with an empty slot has never been full, so no probe sequence
+     * continues past it and the slot can simply be emptied.  Otherwise a
+     * deletion marker keeps the probe sequences going through it intact.
+     */
+    if (group_match(&ht->ctrl[index - index % GROUP_WIDTH], CTRL_EMPTY) != 0)
+    {
+        ht->ctrl[index] = CTRL_EMPTY;
+    }
+    else
+    {
+        ht->ctrl[index] = CTRL_DELETED;
+        ht->ndeleted++;
+    }
+    ht->nelems--;
+
+    return s->item;
+}
@@ -0,0 +1,201 @@
+#include "hashing.h"
+
+/*********************************************************** Data Definitions */
+
+/*
+ * Odd constants with balanced bits, mixed into every hash.
+ */
+static const uint64_t secret[4] =
+{
+    UINT64_C(0x2d358dccaa6c78a5), UINT64_C(0x8bb84b93962eacc9),
+    UINT64_C(0x4b33a62ed433d4a3), UINT64_C(0x4d5a2da51de1aa47),
+};
+
+/*
+ * Seed of `cadthash_bytes_seeded`, see `cadthash_set_seed`.
+ */
+static uint64_t seed = UINT64_C(0x9e3779b97f4a7c15);
+
+/********************************************************** Private Functions */
+
+/*
+ * Multiplies `*a` by `*b`, leaving the low half of the 128 bit product in `*a`
+ * and the high half in `*b`.
+ */
+static inline void mum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 r = (uint128) *a * *b;
+
+    *a = (uint64_t) r;
+    *b = (uint64_t) (r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t) *a, lb = (uint32_t) *b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+/*
+ * Folds the 128 bit product of `a` and `b` into 64 bits.
+ */
+static inline uint64_t mix(uint64_t a, uint64_t b)
+{
+    mum(&a, &b);
+    return a ^ b;
+}
+
+/*
+ * Unaligned reads of 8, 4 and 1 to 3 bytes.
+ */
+static inline uint64_t read8(const unsigned char *p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t read4(const unsigned char *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t read_small(const unsigned char *p, size_t k)
+{
+    return ((uint64_t) p[0] << 16) | ((uint64_t) p[k >> 1] << 8) | p[k - 1];
+}
+
+/*
+ * wyhash: 48 byte blocks feed three independent lanes, then the tail is read
+ * as two (possibly overlapping) 8 byte words.  Keys of up to 16 bytes are read
+ * with at most four loads and no loop.
+ */
+static uint64_t hash_bytes(const void *data, size_t size, uint64_t s)
+{
+    const unsigned char *p = data;
+    uint64_t a, b;
+
+    s ^= mix(s ^ secret[0], secret[1]);
+
+    if (size <= 16)
+    {
+        if (size >= 4)
+        {
+            size_t off = (size >> 3) << 2;
+
+            a = (read4(p) << 32) | read4(p + off);
+            b = (read4(p + size - 4) << 32) | read4(p + size - 4 - off);
+        }
+        else if (size > 0)
+        {
+            a = read_small(p, size);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = size;
+
+        if (i > 48)
+        {
+            uint64_t s1 = s, s2 = s;
+
+            do
+            {
+                s = mix(read8(p) ^ secret[1], read8(p + 8) ^ s);
+                s1 = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ s1);
+                s2 = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ s2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            s ^= s1 ^ s2;
+        }
+        while (i > 16)
+        {
+            s = mix(read8(p) ^ secret[1], read8(p + 8) ^ s);
+            p += 16;
+            i -= 16;
+        }
+        a = read8(p + i - 16);
+        b = read8(p + i - 8);
+    }
+
+    a ^= secret[1];
+    b ^= s;
+    mum(&a, &b);
+
+    return mix(a ^ secret[0] ^ size, b ^ secret[1]);
+}
+
+/***************************************************** Public Implementations */
+
+/*
+ * Hash any key
+ */
+size_t cadthash_bytes(const void *data, size_t size)
+{
+    return (size_t) hash_bytes(data, size, 0);
+}
+
+/*
+ * Hash a 4 or 8 byte integer key
+ */
+size_t cadthash_int(const void *data, size_t size)
+{
+    uint64_t x;
+
+    if (size == sizeof(uint64_t))
+    {
+        x = read8(data);
+    }
+    else if (size == sizeof(uint32_t))
+    {
+        x = read4(data);
+    }
+    else
+    {
+        return cadthash_bytes(data, size);
+    }
+
+    /* Multiply-xorshift finalizer, every input bit affects every output bit */
+    x ^= x >> 32;
+    x *= UINT64_C(0xd6e8feb86659fd93);
+    x ^= x >> 32;
+    x *= UINT64_C(0xd6e8feb86659fd93);
+    x ^= x >> 32;
+
+    return (size_t) x;
+}
+
+/*
+ * Hash any key with the secret seed
+ */
+size_t cadthash_bytes_seeded(const void *data, size_t size)
+{
+    return (size_t) hash_bytes(data, size, seed);
+}
+
+/*
+ * Set the secret seed
+ */
+void cadthash_set_seed(uint64_t s)
+{
+    seed = s;
+    return;
+}
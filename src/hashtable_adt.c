@@ -1,29 +1,93 @@
 #include "hashtable_adt.h"
 
+#include <stdint.h>
+
+/* Grow once the average chain length exceeds one entry per bucket */
+#define MAX_LOAD_FACTOR 1
+/* Shrink once less than one in eight buckets would be in use */
+#define MIN_LOAD_DIVISOR 8
+/* Buckets migrated from the old array on each insert, lookup or delete */
+#define REHASH_STEP 4
+/* Keys up to this size are stored inside the entry */
+#define INLINE_KEY_SIZE 16
+/* Entries carved out of each chunk of the entry pool */
+#define POOL_CHUNK_NENTRIES 256
+/* 2^64 divided by the golden ratio, the multiplier of Fibonacci hashing */
+#define FIBONACCI_MULTIPLIER UINT64_C(0x9e3779b97f4a7c15)
+/* Keys hashed and prefetched together by `cadthashtable_lookup_n` */
+#define LOOKUP_BATCH 16
+
+#if defined(__GNUC__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define PREFETCH(addr) ((void) (addr))
+#endif
+
 /*********************************************************** Data Definitions */
 
 /*
  * A hash table `Entry` is a list in which each element is:
+ * + The full hash of the key, compared before the key itself and used to
+ *   rehash without calling the client's hash function again.
  * + The key size.
- * + A copy of the key the client used at insertion.
+ * + A copy of the key the client used at insertion.  Keys of up to 
+ *   `INLINE_KEY_SIZE` bytes are copied into the entry itself, larger ones to a
+ *   separate allocation.
  * + A void pointer to the item held.
  * + A self-referential pointer.
  */
 typedef struct entry 
 {
+    size_t hash;
     size_t keysize;
-    char* key;
+    union
+    {
+        char bytes[INLINE_KEY_SIZE];
+        char *ptr;
+    } key;
     Element item;
     struct entry *next;
 } Entry;
 
+/*
+ * An `EntryChunk` is a block of entries allocated at once, linked to the chunk
+ * allocated before it.
+ */
+typedef struct entry_chunk
+{
+    struct entry_chunk *next;
+    Entry entries[POOL_CHUNK_NENTRIES];
+} EntryChunk;
+
 /*
  * # Datatype completion
  *
  * A `HashTableADT` is:  
- *  + The hash table' nbuckets.
+ *  + The number of buckets the table was created with, it never shrinks below.
+ *  + The number of buckets of the current entries array.
+ *  + The number of elements held, across both arrays while rehashing.
  *  + A pointer to a hash function with a compatible signature.
  *  + A dynamically allocated array of `Entry` structures.
+ *  + The array being migrated into `entries` while rehashing, `NULL` otherwise.
+ *  + The number of buckets of `oldentries`.
+ *  + The index of the next bucket of `oldentries` to be migrated. 
+ *  + A flag that determines whether bucket counts are powers of two, indexed
+ *    with Fibonacci hashing, or primes, indexed with a modulo.
+ *  + The shift of Fibonacci hashing for `entries` and `oldentries`, that is,
+ *    64 minus the base two logarithm of their number of buckets.
+ *  + The list of chunks entries are carved from, most recent first.
+ *  + The number of entries of the most recent chunk never handed out.
+ *  + A list of released entries, linked through their `next` pointer.
+ *  + The allocator every block of the table comes from.
+ *  + With `CADT_STATS`, the counters of its rehashes and its high-water mark.
+ *
+ * Resizing is incremental: a new array is allocated and every operation moves
+ * `REHASH_STEP` buckets from `oldentries` into it, so no single call pays for
+ * the whole rehash.  New entries always go to `entries`.
+ *
+ * Entries come from a pool owned by the table rather than from `malloc`.  A
+ * released entry goes to the free list to be reused by the next insert, and
+ * chunks are only returned to the system when the table is destroyed.
  */
 struct hash_table_type
 {
@@ -32,22 +96,157 @@ struct hash_table_type
     size_t nelems;
     HashFunction *hash;
     Entry **entries;
+    Entry **oldentries;
+    size_t noldbuckets;
+    size_t rehashidx;
+    int is_pow2;
+    unsigned int shift;
+    unsigned int oldshift;
+    EntryChunk *chunks;
+    size_t nfresh;
+    Entry *freelist;
+    Allocator allocator;
+#if defined(CADT_STATS)
+    HashTableStats stats;
+#endif
 };
 
 /********************************************************** Private Functions */ 
 
 /*
- * Returns the hash index for a given key using the hash function specified by
- * the client when creating the hash table.
+ * Returns a pointer to the copy of the key held by `e`.
  */
-static inline size_t calculate_key_hash(HashTableADT *ht, 
-                                     const void *key, size_t keysize)
+static inline const char *entry_key(const Entry *e)
 {
-    size_t index;
+    return e->keysize <= INLINE_KEY_SIZE ? e->key.bytes : e->key.ptr;
+}
+
+/*
+ * Returns non-zero if the key of `e` is stored in a separate allocation.
+ */
+static inline int has_spilled_key(const Entry *e)
+{
+    return e->keysize > INLINE_KEY_SIZE;
+}
+
+/*
+ * Takes an entry from the free list of `ht`, or from its most recent chunk,
+ * allocating a new chunk if both are exhausted.  Returns `NULL` if allocation
+ * fails.
+ */
+static Entry *entry_alloc(HashTableADT *ht)
+{
+    Entry *e;
+
+    if ((e = ht->freelist) != NULL)
+    {
+        ht->freelist = e->next;
+        return e;
+    }
+
+    if (ht->nfresh == 0)
+    {
+        EntryChunk *chunk;
+
+        if ((chunk = cadt_alloc(&ht->allocator, sizeof(EntryChunk))) == NULL)
+        {
+            perror("entry_alloc malloc failed allocating struct entry_chunk");
+            return NULL;
+        }
+        chunk->next = ht->chunks;
+        ht->chunks = chunk;
+        ht->nfresh = POOL_CHUNK_NENTRIES;
+    }
+
+    return &ht->chunks->entries[POOL_CHUNK_NENTRIES - ht->nfresh--];
+}
+
+/*
+ * Returns `e` to the free list of `ht`.  Its key size is cleared so that
+ * `free_pool` can tell it apart from the entries in use.
+ */
+static inline void entry_free(HashTableADT *ht, Entry *e)
+{
+    e->keysize = 0;
+    e->next = ht->freelist;
+    ht->freelist = e;
+}
+
+/*
+ * Releases every chunk of the pool of `ht` in a single pass over them, along
+ * with the keys the entries in use stored in a separate allocation.  If `fp` is
+ * not `NULL`, it is called on every entry in use before its key is released.
+ */
+static void free_pool(HashTableADT *ht, HashTableVisitor *fp, void *ctx)
+{
+    size_t nused = POOL_CHUNK_NENTRIES - ht->nfresh;
+
+    while (ht->chunks != NULL)
+    {
+        EntryChunk *next = ht->chunks->next;
+        size_t i;
+
+        for (i = 0; i < nused; i++)
+        {
+            Entry *e = &ht->chunks->entries[i];
+
+            /* Entries on the free list have a zero key size */
+            if (fp != NULL && e->keysize != 0)
+            {
+                fp(entry_key(e), e->keysize, e->item, ctx);
+            }
+            if (has_spilled_key(e))
+            {
+                cadt_free(&ht->allocator, e->key.ptr, e->keysize);
+            }
+        }
+        cadt_free(&ht->allocator, ht->chunks, sizeof(EntryChunk));
+        ht->chunks = next;
+        nused = POOL_CHUNK_NENTRIES;
+    }
+
+    ht->nfresh = 0;
+    ht->freelist = NULL;
+}
+
+/*
+ * Returns the index of the bucket a key hashed to `hash` falls into, out of
+ * `nbuckets` buckets.
+ */
+static inline size_t bucket_index(size_t hash, size_t nbuckets)
+{
+    return hash % nbuckets;
+}
+
+/*
+ * Returns the index of the bucket a key hashed to `hash` falls into, out of
+ * `2^(64 - shift)` buckets.  The multiplication carries every bit of the hash
+ * into the top bits of the product, so the hash needs no extra mixing and weak
+ * client hashes are not made worse by dropping their high bits.
+ */
+static inline size_t fibonacci_index(size_t hash, unsigned int shift)
+{
+    return (size_t) (((uint64_t) hash * FIBONACCI_MULTIPLIER) >> shift);
+}
 
-    index = (ht->hash(key, keysize)) % ht->nbuckets;
+/*
+ * Returns the index of the bucket of `entries` a key hashed to `hash` falls
+ * into.
+ */
+static inline size_t entries_index(const HashTableADT *ht, size_t hash)
+{
+    return ht->is_pow2 ? fibonacci_index(hash, ht->shift) 
+                       : bucket_index(hash, ht->nbuckets);
+}
 
-    return index;
+/*
+ * Returns the index of the bucket of `oldentries` a key hashed to `hash` falls
+ * into.
+ */
+static inline size_t oldentries_index(const HashTableADT *ht, size_t hash)
+{
+    return ht->is_pow2 ? fibonacci_index(hash, ht->oldshift) 
+                       : bucket_index(hash, ht->noldbuckets);
 }
 
 /*
@@ -90,62 +289,444 @@ static inline size_t get_next_prime(size_t n)
     return n;
 }
 
-/***************************************************** Public Implementations */
+/*
+ * Returns the closest power of two greater than or equal to `n`, and no
+ * smaller than two.
+ */
+static inline size_t get_next_pow2(size_t n)
+{
+    size_t pow2 = 2;
+
+    while (pow2 < n)
+    {
+        pow2 *= 2;
+    }
+    return pow2;
+}
 
 /*
- * Create a hash table 
+ * Returns the Fibonacci hashing shift for a power of two number of buckets.
  */
-HashTableADT *cadthashtable_new(size_t nbuckets, HashFunction *fp)
+static inline unsigned int pow2_shift(size_t nbuckets)
+{
+    unsigned int shift = 64;
+
+    while (nbuckets > 1)
+    {
+        nbuckets /= 2;
+        shift--;
+    }
+    return shift;
+}
+
+/*
+ * Returns the address of the link pointing to the entry matching `key` in the
+ * chain starting at `pp`, or `NULL` if there is no such entry.  Keys are only
+ * compared when their hashes are equal.
+ */
+static inline Entry **find_link(Entry **pp, size_t hash, 
+                                const void *key, size_t keysize)
+{
+    while (*pp != NULL)
+    {
+        if ((*pp)->hash == hash && (*pp)->keysize == keysize 
+                && memcmp(entry_key(*pp), key, keysize) == 0)
+        {
+            return pp;
+        }
+        pp = &((*pp)->next);
+    }
+    return NULL;
+}
+
+/*
+ * Returns the address of the link pointing to the entry matching `key`,
+ * searching the bucket of the not yet migrated part of `oldentries` too.
+ */
+static Entry **find_key(HashTableADT *ht, size_t hash, 
+                        const void *key, size_t keysize)
+{
+    Entry **pp;
+
+    pp = find_link(&(ht->entries[entries_index(ht, hash)]), hash, key, keysize);
+
+    if (pp == NULL && ht->oldentries != NULL)
+    {
+        size_t oldindex = oldentries_index(ht, hash);
+
+        if (oldindex >= ht->rehashidx)
+        {
+            pp = find_link(&(ht->oldentries[oldindex]), hash, key, keysize);
+        }
+    }
+
+    return pp;
+}
+
+#if defined(CADT_STATS)
+/*
+ * Counts the rehash of `ht` to `nbuckets` buckets, before it starts.
+ */
+static inline void count_rehash(HashTableADT *ht, size_t nbuckets)
+{
+    if (nbuckets > ht->nbuckets)
+    {
+        ht->stats.ngrows++;
+    }
+    else
+    {
+        ht->stats.nshrinks++;
+    }
+}
+
+/*
+ * Raises the high-water mark of `ht` to its number of elements.
+ */
+static inline void count_insert(HashTableADT *ht)
+{
+    if (ht->nelems > ht->stats.high_water)
+    {
+        ht->stats.high_water = ht->nelems;
+    }
+}
+#endif
+
+/*
+ * Allocates an entries array of (at least) `nbuckets` buckets and makes the
+ * current one the array to be migrated.  Returns `NULL` if allocation fails,
+ * leaving `ht` untouched.
+ */
+static Entry **start_rehash(HashTableADT *ht, size_t nbuckets)
+{
+    Entry **new;
+
+    nbuckets = ht->is_pow2 ? get_next_pow2(nbuckets) : get_next_prime(nbuckets);
+
+    if ((new = cadt_calloc(&ht->allocator, nbuckets, sizeof(Entry*))) == NULL)
+    {
+        perror("start_rehash calloc failed allocating entry array");
+        return NULL;
+    }
+
+    CADT_STATS_ONLY(count_rehash(ht, nbuckets));
+    ht->oldentries = ht->entries;
+    ht->noldbuckets = ht->nbuckets;
+    ht->oldshift = ht->shift;
+    ht->rehashidx = 0;
+    ht->entries = new;
+    ht->nbuckets = nbuckets;
+    ht->shift = pow2_shift(nbuckets);
+
+    return new;
+}
+
+/*
+ * Migrates up to `nsteps` non-empty buckets of `oldentries` into `entries`.
+ * Empty buckets are skipped, but only up to ten times `nsteps` of them per
+ * call to keep its cost bounded.  Frees `oldentries` once it is empty.
+ */
+static void rehash_step(HashTableADT *ht, size_t nsteps)
+{
+    size_t nempty = nsteps * 10;
+
+    while (nsteps > 0 && ht->rehashidx < ht->noldbuckets)
+    {
+        Entry *e = ht->oldentries[ht->rehashidx];
+
+        if (e == NULL)
+        {
+            ht->rehashidx++;
+            if (--nempty == 0)
+            {
+                break;
+            }
+            continue;
+        }
+
+        while (e != NULL)
+        {
+            Entry *next = e->next;
+            size_t index = entries_index(ht, e->hash);
+
+            e->next = ht->entries[index];
+            ht->entries[index] = e;
+            e = next;
+            CADT_STATS_ONLY(ht->stats.nmigrated++);
+        }
+        ht->oldentries[ht->rehashidx++] = NULL;
+        nsteps--;
+    }
+
+    if (ht->rehashidx == ht->noldbuckets)
+    {
+        cadt_free(&ht->allocator, ht->oldentries,
+                  ht->noldbuckets * sizeof(Entry*));
+        ht->oldentries = NULL;
+        ht->noldbuckets = 0;
+        ht->rehashidx = 0;
+    }
+}
+
+/*
+ * Starts growing or shrinking `ht` if its load factor went out of bounds.
+ * Failing to allocate the new array is not an error, `ht` keeps its size.
+ */
+static inline void resize_if_needed(HashTableADT *ht)
+{
+    if (ht->oldentries != NULL)
+    {
+        return;
+    }
+
+    if (ht->nelems > ht->nbuckets * MAX_LOAD_FACTOR)
+    {
+        start_rehash(ht, ht->nbuckets * 2);
+    }
+    else if (ht->nbuckets > ht->nbucketsinitial 
+            && ht->nelems < ht->nbuckets / MIN_LOAD_DIVISOR)
+    {
+        size_t half = ht->nbuckets / 2;
+
+        start_rehash(ht, half > ht->nbucketsinitial ? half : ht->nbucketsinitial);
+    }
+}
+
+/*
+ * Releases both entries arrays and the table itself, once its pool is freed.
+ */
+static void free_table(HashTableADT *ht)
+{
+    Allocator a = ht->allocator;
+
+    cadt_free(&a, ht->oldentries, ht->noldbuckets * sizeof(Entry*));
+    cadt_free(&a, ht->entries, ht->nbuckets * sizeof(Entry*));
+    cadt_free(&a, ht, sizeof(struct hash_table_type));
+}
+
+/*
+ * Creates a hash table whose bucket counts are either primes or powers of two,
+ * allocating through `a`.
+ */
+static HashTableADT *table_new(size_t nbuckets, HashFunction *fp, int is_pow2,
+                               const Allocator *a)
 {
     HashTableADT *new;
 
-    if (nbuckets == 0 || fp == NULL)
+    if (nbuckets == 0 || fp == NULL || a == NULL || !cadt_is_valid_allocator(a))
     {
         errno = EINVAL;
         return NULL;
     }
     
-    if ((new = malloc(sizeof(struct hash_table_type))) == NULL)
+    if ((new = cadt_alloc(a, sizeof(struct hash_table_type))) == NULL)
     { 
         perror("cadthashtable_new malloc failed allocating struct hash_table_type");
         errno = ENOMEM;
         return NULL;
     }
     
-    if ((new->entries = calloc(nbuckets, sizeof(Entry*))) == NULL)
+    nbuckets = is_pow2 ? get_next_pow2(nbuckets) : get_next_prime(nbuckets);
+
+    if ((new->entries = cadt_calloc(a, nbuckets, sizeof(Entry*))) == NULL)
     {
         perror("cadthashtable_new calloc failed allocating entry array");
-        free(new);
+        cadt_free(a, new, sizeof(struct hash_table_type));
         errno = ENOMEM;
         return NULL;
     }
 
-    nbuckets = get_next_prime(nbuckets);
-
     new->nbucketsinitial = nbuckets;
     new->nbuckets = nbuckets;
     new->nelems = 0;
     new->hash = fp;
+    new->oldentries = NULL;
+    new->noldbuckets = 0;
+    new->rehashidx = 0;
+    new->is_pow2 = is_pow2;
+    new->shift = pow2_shift(nbuckets);
+    new->oldshift = 0;
+    new->chunks = NULL;
+    new->nfresh = 0;
+    new->freelist = NULL;
+    new->allocator = *a;
+    CADT_STATS_ONLY(new->stats = (HashTableStats) { 0 });
 
     return new;
 }
+
+/***************************************************** Public Implementations */
+
+/*
+ * Create a hash table with a prime number of buckets
+ */
+HashTableADT *cadthashtable_new(size_t nbuckets, HashFunction *fp)
+{
+    static const Allocator default_allocator = CADT_ALLOCATOR_DEFAULT;
+
+    return table_new(nbuckets, fp, 0, &default_allocator);
+}
+
+/*
+ * Create a hash table with a power of two number of buckets
+ */
+HashTableADT *cadthashtable_new_pow2(size_t nbuckets, HashFunction *fp)
+{
+    static const Allocator default_allocator = CADT_ALLOCATOR_DEFAULT;
+
+    return table_new(nbuckets, fp, 1, &default_allocator);
+}
+
+/*
+ * Create a hash table with a prime number of buckets, allocating through `a`
+ */
+HashTableADT *cadthashtable_new_with_allocator(size_t nbuckets, 
+                                               HashFunction *fp,
+                                               const Allocator *a)
+{
+    return table_new(nbuckets, fp, 0, a);
+}
     
 /*
  * Destroy hash table
  */
 void cadthashtable_destroy(HashTableADT *ht) 
 {
-    free(ht->entries);
-    free(ht);
+    free_pool(ht, NULL, NULL);
+    free_table(ht);
+    return;
+}
+
+/*
+ * Deallocate a hash table, handing every element to `fp` on the way
+ */
+void cadthashtable_destroy_with(HashTableADT *ht, HashTableVisitor *fp, 
+                                void *ctx)
+{
+    free_pool(ht, fp, ctx);
+    free_table(ht);
+    return;
+}
+
+/*
+ * Number of elements
+ */
+size_t cadthashtable_nelems(HashTableADT *ht)
+{
+    return ht->nelems;
+}
+
+/*
+ * Visit every element, bucket by bucket
+ */
+void cadthashtable_foreach(HashTableADT *ht, HashTableVisitor *fp, void *ctx)
+{
+    size_t i;
+    Entry *e;
+
+    if (ht == NULL || fp == NULL)
+    {
+        errno = EINVAL;
+        return;
+    }
+
+    for (i = 0; i < ht->nbuckets; i++)
+    {
+        for (e = ht->entries[i]; e != NULL; e = e->next)
+        {
+            fp(entry_key(e), e->keysize, e->item, ctx);
+        }
+    }
+
+    /* Buckets not migrated yet */
+    for (i = ht->rehashidx; i < ht->noldbuckets; i++)
+    {
+        for (e = ht->oldentries[i]; e != NULL; e = e->next)
+        {
+            fp(entry_key(e), e->keysize, e->item, ctx);
+        }
+    }
+
+    return;
+}
+
+/*
+ * Start an iteration, finishing any pending rehash first
+ */
+void cadthashtable_iter_init(HashTableADT *ht, HashTableIterator *it)
+{
+    if (it == NULL)
+    {
+        errno = EINVAL;
+        return;
+    }
+
+    it->ht = ht;
+    it->index = 0;
+    it->next = NULL;
+
+    if (ht == NULL)
+    {
+        errno = EINVAL;
+        return;
+    }
+
+    while (ht->oldentries != NULL)
+    {
+        rehash_step(ht, ht->noldbuckets);
+    }
+
     return;
 }
 
+/*
+ * Advance an iteration
+ */
+bool cadthashtable_iter_next(HashTableIterator *it, const void **key, 
+                             size_t *keysize, Element *e)
+{
+    Entry *entry;
+
+    if (it == NULL || it->ht == NULL)
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    while (it->next == NULL)
+    {
+        if (it->index >= it->ht->nbuckets)
+        {
+            return false;
+        }
+        it->next = it->ht->entries[it->index++];
+    }
+
+    entry = it->next;
+    it->next = entry->next;
+
+    if (key != NULL)
+    {
+        *key = entry_key(entry);
+    }
+    if (keysize != NULL)
+    {
+        *keysize = entry->keysize;
+    }
+    if (e != NULL)
+    {
+        *e = entry->item;
+    }
+
+    return true;
+}
+
 /*
  * Insert operation
  */
 Element cadthashtable_insert(HashTableADT *ht, const void *key, size_t keysize, 
                             Element e)
 {
+    size_t hash;
     size_t index;
     Entry* new;
 
@@ -155,28 +736,43 @@ Element cadthashtable_insert(HashTableADT *ht, const void *key, size_t keysize,
         return NULL;
     }
 
-    if (cadthashtable_lookup(ht, key, keysize) != NULL)
+    if (ht->oldentries != NULL)
+    {
+        rehash_step(ht, REHASH_STEP);
+    }
+
+    /* Probe with the one hash, then link the new entry in place */
+    hash = ht->hash(key, keysize);
+
+    if (find_key(ht, hash, key, keysize) != NULL)
     {
         errno = EEXIST;
         return NULL;
     }
 
-    if ((new = malloc(sizeof(Entry))) == NULL)
+    if ((new = entry_alloc(ht)) == NULL)
     { 
-        perror("cadthashtable_insert malloc failed allocating struct entry");
         errno = ENOMEM;
         return NULL;
     }
-    if ((new->key = malloc(keysize)) == NULL)
+    if (keysize <= INLINE_KEY_SIZE)
+    {
+        memcpy(new->key.bytes, key, keysize);
+    }
+    else if ((new->key.ptr = cadt_alloc(&ht->allocator, keysize)) == NULL)
     {
         perror("cadthashtable_insert malloc failed allocating new->key");
-        free(new);
+        entry_free(ht, new);
         errno = ENOMEM;
         return NULL;
     }
+    else
+    {
+        memcpy(new->key.ptr, key, keysize);
+    }
 
-    index = calculate_key_hash(ht, key, keysize);
-    memcpy(new->key, key, keysize);
+    index = entries_index(ht, hash);
+    new->hash = hash;
     new->keysize = keysize; 
     new->item = e; 
 
@@ -184,6 +780,9 @@ Element cadthashtable_insert(HashTableADT *ht, const void *key, size_t keysize,
     new->next = ht->entries[index];
     ht->entries[index] = new;
     ht->nelems++;
+    CADT_STATS_ONLY(count_insert(ht));
+
+    resize_if_needed(ht);
 
     return e;
 }
@@ -193,8 +792,7 @@ Element cadthashtable_insert(HashTableADT *ht, const void *key, size_t keysize,
  */
 Element cadthashtable_lookup(HashTableADT *ht, const void *key, size_t keysize)
 {
-    size_t index;
-    Entry *e;
+    Entry **pp;
 
     if (ht == NULL || key == NULL || keysize == 0)
     {
@@ -202,31 +800,88 @@ Element cadthashtable_lookup(HashTableADT *ht, const void *key, size_t keysize)
         return NULL;
     }
 
-    index = calculate_key_hash(ht, key, keysize);
-    e = ht->entries[index];
+    if (ht->oldentries != NULL)
+    {
+        rehash_step(ht, REHASH_STEP);
+    }
 
-    if (e == NULL)
+    if ((pp = find_key(ht, ht->hash(key, keysize), key, keysize)) == NULL)
     {
         return NULL;
     }
+    else
+    {
+        return (*pp)->item;
+    }
+}
 
-    while (e != NULL) 
+/*
+ * Lookup a batch of keys, overlapping their cache misses.
+ */
+size_t cadthashtable_lookup_n(HashTableADT *ht, const void *const *keys, 
+                              const size_t *keysizes, size_t n, 
+                              Element *results)
+{
+    size_t hashes[LOOKUP_BATCH];
+    Entry **buckets[LOOKUP_BATCH];
+    size_t base, i, batch, nfound = 0;
+
+    if (ht == NULL || keys == NULL || keysizes == NULL || results == NULL)
     {
-        if (e->keysize == keysize && memcmp(e->key, key, keysize) == 0)
-        {
-            break;
-        }
-        e = e->next;
+        errno = EINVAL;
+        return 0;
     }
 
-    if (e == NULL)
+    if (ht->oldentries != NULL)
     {
-        return NULL;
+        rehash_step(ht, REHASH_STEP);
     }
-    else
+
+    for (base = 0; base < n; base += batch)
     {
-        return e->item;
+        batch = n - base < LOOKUP_BATCH ? n - base : LOOKUP_BATCH;
+
+        /* Hash every key and start loading its bucket */
+        for (i = 0; i < batch; i++)
+        {
+            buckets[i] = NULL;
+            if (keys[base + i] == NULL || keysizes[base + i] == 0)
+            {
+                continue;
+            }
+            hashes[i] = ht->hash(keys[base + i], keysizes[base + i]);
+            buckets[i] = &(ht->entries[entries_index(ht, hashes[i])]);
+            PREFETCH(buckets[i]);
+        }
+
+        /* By now the buckets have arrived, start loading their first entry */
+        for (i = 0; i < batch; i++)
+        {
+            if (buckets[i] != NULL && *buckets[i] != NULL)
+            {
+                PREFETCH(*buckets[i]);
+            }
+        }
+
+        for (i = 0; i < batch; i++)
+        {
+            Entry **pp;
+
+            results[base + i] = NULL;
+            if (buckets[i] == NULL)
+            {
+                errno = EINVAL;
+            }
+            else if ((pp = find_key(ht, hashes[i], keys[base + i], 
+                                    keysizes[base + i])) != NULL)
+            {
+                results[base + i] = (*pp)->item;
+                nfound++;
+            }
+        }
     }
+
+    return nfound;
 }
 
 /*
@@ -236,8 +891,8 @@ Element cadthashtable_lookup(HashTableADT *ht, const void *key, size_t keysize)
 Element cadthashtable_delete(HashTableADT *ht, void *key, size_t keysize, 
                             Element e)
 {
-	size_t index;
     Entry **pp;
+    Entry *temp;
     Element deleted_item;
 
     if (ht == NULL || key == NULL || keysize == 0 || e == NULL)
@@ -246,25 +901,84 @@ Element cadthashtable_delete(HashTableADT *ht, void *key, size_t keysize,
         return NULL;
     }
 
-    index = calculate_key_hash(ht, key, keysize);
-    pp = &(ht->entries[index]);
+    if (ht->oldentries != NULL)
+    {
+        rehash_step(ht, REHASH_STEP);
+    }
 
-	while (*pp)
+    if ((pp = find_key(ht, ht->hash(key, keysize), key, keysize)) == NULL)
     {
-        if ((*pp)->keysize == keysize && memcmp((*pp)->key, key, keysize) == 0)
-        {
-            Entry *temp = *pp;
-            *pp = temp->next;
-            deleted_item = temp->item;
+        return NULL;
+    }
 
-            free(temp);
-            ht->nelems--;
+    temp = *pp;
+    *pp = temp->next;
+    deleted_item = temp->item;
 
-            return deleted_item;
-        }
-        pp = &((*pp)->next);
+    if (has_spilled_key(temp))
+    {
+        cadt_free(&ht->allocator, temp->key.ptr, temp->keysize);
     }
+    entry_free(ht, temp);
+    ht->nelems--;
+
+    resize_if_needed(ht);
+
+    return deleted_item;
+}
 
-	return NULL;
+#if defined(CADT_STATS)
+/*
+ * Adds the chains of `nbuckets` buckets from `buckets` to the histogram of
+ * `stats`.
+ */
+static void count_chains(HashTableStats *stats, Entry **buckets, 
+                         size_t nbuckets)
+{
+    size_t i;
+
+    for (i = 0; i < nbuckets; i++)
+    {
+        size_t len = 0;
+        Entry *e;
+
+        for (e = buckets[i]; e != NULL; e = e->next)
+        {
+            len++;
+        }
+        if (len > stats->max_chain)
+        {
+            stats->max_chain = len;
+        }
+        stats->chain_lengths[len < CADT_CHAIN_HISTOGRAM_SIZE 
+                             ? len : CADT_CHAIN_HISTOGRAM_SIZE - 1]++;
+    }
 }
 
+/*
+ * Return the statistics of `ht`
+ */
+HashTableStats cadthashtable_stats(HashTableADT *ht)
+{
+    HashTableStats stats = ht->stats;
+    size_t i;
+
+    stats.nelems = ht->nelems;
+    stats.nbuckets = ht->nbuckets;
+    stats.load_factor = (double) ht->nelems / (double) ht->nbuckets;
+    stats.max_chain = 0;
+    for (i = 0; i < CADT_CHAIN_HISTOGRAM_SIZE; i++)
+    {
+        stats.chain_lengths[i] = 0;
+    }
+
+    count_chains(&stats, ht->entries, ht->nbuckets);
+    if (ht->oldentries != NULL)
+    {
+        count_chains(&stats, &ht->oldentries[ht->rehashidx], 
+                     ht->noldbuckets - ht->rehashidx);
+    }
+
+    return stats;
+}
+#endif
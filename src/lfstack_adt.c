@@ -0,0 +1,402 @@
+/* posix_memalign() for pure c99 compilers */
+#if !defined(_POSIX_C_SOURCE) || _POSIX_C_SOURCE < 200112L
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "lfstack_adt.h"
+
+#include <stdint.h>
+
+/* The top and the free list are padded to a whole line each */
+#define CACHE_LINE_SIZE 64
+
+/* The first chunk holds 2^FIRST_CHUNK_SHIFT nodes, each one twice the last */
+#define FIRST_CHUNK_SHIFT 6
+/* Enough chunks to index nearly 2^32 nodes */
+#define MAX_CHUNKS (32 - FIRST_CHUNK_SHIFT)
+
+/* Node caches per stack, threads are spread over them round-robin */
+#define NCACHES 16
+/* Nodes per cache, so that a `NodeCache` is exactly two lines */
+#define CACHE_NODES 30
+
+/* The node reference in the low half of a tagged word */
+#define REF_MASK 0xffffffffu
+
+/*********************************************************** Data Definitions */
+
+/*
+ * A `Node` is:
+ * + The item it holds.
+ * + A reference to the node below it, in the stack or in the free list.
+ * + The number of nodes from it to the bottom of the stack, itself included.
+ *
+ * A node is referred to by its index plus one, zero meaning no node.  A
+ * popped node may be recycled while a slower thread still reads it, so its
+ * fields are only ever accessed atomically.
+ */
+typedef struct node
+{
+    Element item;
+    uint32_t next;
+    uint32_t depth;
+} Node;
+
+/*
+ * A `NodeCache` is:
+ * + A flag telling whether a thread is using the cache.
+ * + The number of nodes held.
+ * + References to the nodes held.
+ *
+ * It spans exactly `2 * CACHE_LINE_SIZE` bytes, and the caches start on a line
+ * boundary, so two caches never share a line.
+ */
+typedef struct node_cache
+{
+    int busy;
+    uint32_t nrefs;
+    uint32_t refs[CACHE_NODES];
+} NodeCache;
+
+/* Fails to compile if a `NodeCache` is not a whole number of lines */
+typedef char node_cache_size_check[sizeof(NodeCache) % CACHE_LINE_SIZE == 0
+                                   ? 1 : -1];
+
+/*
+ * # Datatype completion
+ *
+ * A `LFStackADT` object is:
+ *  + The top of the stack, a tagged word: the reference to the top node in the
+ *    low 32 bits, the number of changes so far in the high 32 bits.
+ *  + The free list of nodes, a tagged word likewise.
+ *  + The node caches, a striped pool shared by all threads rather than
+ *    thread-local storage: each thread is given one of them, mod `NCACHES`, and
+ *    beyond `NCACHES` threads several share a cache.  A cache is taken with a
+ *    try-lock, a thread falling back on the free list if its cache is busy.
+ *    Right after the two padded lines, so each cache starts on a line.
+ *  + The chunks nodes are carved from, chunk `k` holding
+ *    `2^(FIRST_CHUNK_SHIFT + k)` nodes.  Never moved nor freed until the stack
+ *    is destroyed.
+ *  + The number of chunks allocated.
+ */
+struct lf_stack_type
+{
+    uint64_t top;
+    char pad0[CACHE_LINE_SIZE - sizeof(uint64_t)];
+
+    uint64_t free;
+    char pad1[CACHE_LINE_SIZE - sizeof(uint64_t)];
+
+    NodeCache caches[NCACHES];
+
+    Node *chunks[MAX_CHUNKS];
+    size_t nchunks;
+};
+
+/* The cache of each thread, the same in every stack, assigned on first use */
+static __thread unsigned thread_cache = NCACHES;
+static unsigned next_thread_cache;
+
+/********************************************************** Private Functions */
+
+/*
+ * Returns the node referred to by `ref`, non-zero.
+ */
+static inline Node *node_of(LFStackADT *s, uint32_t ref)
+{
+    /* index + first chunk size has its top bit at chunk + FIRST_CHUNK_SHIFT */
+    uint64_t i = (uint64_t) ref - 1 + ((uint64_t) 1 << FIRST_CHUNK_SHIFT);
+    int msb = 63 - __builtin_clzll(i);
+    Node *chunk = __atomic_load_n(&s->chunks[msb - FIRST_CHUNK_SHIFT],
+                                  __ATOMIC_ACQUIRE);
+
+    return &chunk[i - ((uint64_t) 1 << msb)];
+}
+
+/*
+ * Returns the word following `old` that refers to `ref`.
+ */
+static inline uint64_t next_tag(uint64_t old, uint32_t ref)
+{
+    return (((old >> 32) + 1) << 32) | ref;
+}
+
+/*
+ * Pushes the chain of nodes from `first` to `last` onto the list at `head`.
+ * Pushing onto the stack's top also sets the depth of `first`, which must then
+ * be `last`.
+ */
+static void list_push(LFStackADT *s, uint64_t *head, uint32_t first, Node *last)
+{
+    uint64_t old = __atomic_load_n(head, __ATOMIC_RELAXED);
+    uint32_t below;
+
+    do
+    {
+        below = (uint32_t) (old & REF_MASK);
+        __atomic_store_n(&last->next, below, __ATOMIC_RELAXED);
+        if (head == &s->top)
+        {
+            uint32_t depth = (below == 0) ? 0
+                : __atomic_load_n(&node_of(s, below)->depth, __ATOMIC_RELAXED);
+            __atomic_store_n(&last->depth, depth + 1, __ATOMIC_RELAXED);
+        }
+    }
+    /* publish the node fields along with the new head */
+    while (!__atomic_compare_exchange_n(head, &old, next_tag(old, first), 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*
+ * Pops a node off the list at `head`, returns its reference or zero if the
+ * list is empty.
+ */
+static uint32_t list_pop(LFStackADT *s, uint64_t *head)
+{
+    uint64_t old = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+    uint32_t ref, next;
+
+    do
+    {
+        ref = (uint32_t) (old & REF_MASK);
+        if (ref == 0)
+        {
+            return 0;
+        }
+        /*
+         * The node may have been popped and recycled since `old` was read, the
+         * generation in `old` then makes the swap fail.
+         */
+        next = __atomic_load_n(&node_of(s, ref)->next, __ATOMIC_RELAXED);
+    }
+    while (!__atomic_compare_exchange_n(head, &old, next_tag(old, next), 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+
+    return ref;
+}
+
+/*
+ * Allocates the next chunk of nodes and pushes them all onto the free list.
+ * Returns zero on success, non-zero if there is no room left.  A thread losing
+ * the race to install the chunk frees its own and helps the winner along.
+ */
+static int add_chunk(LFStackADT *s)
+{
+    size_t k = __atomic_load_n(&s->nchunks, __ATOMIC_ACQUIRE);
+    size_t nnodes, i;
+    Node *chunk, *expected = NULL;
+    uint32_t first;
+
+    if (k == MAX_CHUNKS)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+    nnodes = (size_t) 1 << (FIRST_CHUNK_SHIFT + k);
+    chunk = malloc(nnodes * sizeof(Node));
+    if (chunk == NULL)
+    {
+        perror("add_chunk malloc failed allocating Node chunk");
+        return -1;
+    }
+
+    if (!__atomic_compare_exchange_n(&s->chunks[k], &expected, chunk, 0,
+                                     __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    {
+        free(chunk);
+        __atomic_compare_exchange_n(&s->nchunks, &k, k + 1, 0,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    /* chain the nodes, then splice them onto the free list at once */
+    first = (uint32_t) (nnodes - ((size_t) 1 << FIRST_CHUNK_SHIFT) + 1);
+    for (i = 0; i < nnodes - 1; i++)
+    {
+        __atomic_store_n(&chunk[i].next, first + (uint32_t) i + 1,
+                         __ATOMIC_RELAXED);
+    }
+    __atomic_compare_exchange_n(&s->nchunks, &k, k + 1, 0,
+                                __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    list_push(s, &s->free, first, &chunk[nnodes - 1]);
+
+    return 0;
+}
+
+/*
+ * Returns the cache the calling thread is striped to, locked, or `NULL` if
+ * another thread sharing it holds it.
+ */
+static inline NodeCache *lock_cache(LFStackADT *s)
+{
+    NodeCache *c;
+
+    if (thread_cache == NCACHES)
+    {
+        thread_cache = __atomic_fetch_add(&next_thread_cache, 1,
+                                          __ATOMIC_RELAXED) % NCACHES;
+    }
+    c = &s->caches[thread_cache];
+    return __atomic_exchange_n(&c->busy, 1, __ATOMIC_ACQUIRE) ? NULL : c;
+}
+
+static inline void unlock_cache(NodeCache *c)
+{
+    __atomic_store_n(&c->busy, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Returns a free node, from the thread's cache, the free list or a new chunk,
+ * in that order.  Zero if no memory is left.
+ */
+static uint32_t alloc_node(LFStackADT *s)
+{
+    NodeCache *c = lock_cache(s);
+    uint32_t ref = 0;
+
+    if (c != NULL)
+    {
+        if (c->nrefs > 0)
+        {
+            ref = c->refs[--c->nrefs];
+        }
+        unlock_cache(c);
+    }
+    while (ref == 0 && (ref = list_pop(s, &s->free)) == 0)
+    {
+        if (add_chunk(s) != 0)
+        {
+            return 0;
+        }
+    }
+    return ref;
+}
+
+/*
+ * Hands the node `ref` back, to the thread's cache if it has room, else to
+ * the free list.
+ */
+static void free_node(LFStackADT *s, uint32_t ref)
+{
+    NodeCache *c = lock_cache(s);
+
+    if (c != NULL)
+    {
+        if (c->nrefs < CACHE_NODES)
+        {
+            c->refs[c->nrefs++] = ref;
+            unlock_cache(c);
+            return;
+        }
+        unlock_cache(c);
+    }
+    list_push(s, &s->free, ref, node_of(s, ref));
+}
+
+/***************************************************** Public Implementations */
+
+/*
+ * Create lock-free stack
+ */
+LFStackADT *cadtlfstack_new(size_t size)
+{
+    LFStackADT *new;
+    void *mem;
+    size_t capacity = 0;
+
+    if (size == 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (posix_memalign(&mem, CACHE_LINE_SIZE, sizeof(struct lf_stack_type)) != 0)
+    {
+        perror("cadtlfstack_new posix_memalign failed allocating struct lf_stack_type");
+        errno = ENOMEM;
+        return NULL;
+    }
+    new = mem;
+    memset(new, 0, sizeof(struct lf_stack_type));
+
+    /* room for `size` nodes up front */
+    while (capacity < size)
+    {
+        if (add_chunk(new) != 0)
+        {
+            cadtlfstack_destroy(new);
+            return NULL;
+        }
+        capacity = capacity * 2 + ((size_t) 1 << FIRST_CHUNK_SHIFT);
+    }
+
+    return new;
+}
+
+/*
+ * Destroy stack, and every chunk of nodes
+ */
+void cadtlfstack_destroy(LFStackADT *s)
+{
+    size_t k;
+
+    for (k = 0; k < s->nchunks; k++)
+    {
+        free(s->chunks[k]);
+    }
+    free(s);
+    return;
+}
+
+/*
+ * Return the number of elements `s` currently holds
+ */
+size_t cadtlfstack_nelems(LFStackADT *s)
+{
+    uint32_t ref = (uint32_t) (__atomic_load_n(&s->top, __ATOMIC_ACQUIRE)
+                               & REF_MASK);
+
+    return (ref == 0) ? 0
+        : __atomic_load_n(&node_of(s, ref)->depth, __ATOMIC_RELAXED);
+}
+
+/*
+ * Push element onto the top of `s`
+ */
+Element cadtlfstack_push(LFStackADT *s, Element e)
+{
+    uint32_t ref = alloc_node(s);
+    Node *node;
+
+    if (ref == 0)
+    {
+        return NULL;
+    }
+    node = node_of(s, ref);
+    __atomic_store_n(&node->item, e, __ATOMIC_RELAXED);
+    list_push(s, &s->top, ref, node);
+
+    return e;
+}
+
+/*
+ * Pop element at the top of `s`
+ */
+Element cadtlfstack_pop(LFStackADT *s)
+{
+    uint32_t ref = list_pop(s, &s->top);
+    Element ret;
+
+    /* handle stack underflow */
+    if (ref == 0)
+    {
+        errno = EPERM;
+        return NULL;
+    }
+
+    ret = __atomic_load_n(&node_of(s, ref)->item, __ATOMIC_RELAXED);
+    free_node(s, ref);
+
+    return ret;
+}
@@ -0,0 +1,246 @@
+/* posix_memalign() for pure c99 compilers */
+#if !defined(_POSIX_C_SOURCE) || _POSIX_C_SOURCE < 200112L
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "mpmcqueue_adt.h"
+
+#include <stdint.h>
+
+/* Positions are padded to a whole line so producers and consumers never share one */
+#define CACHE_LINE_SIZE 64
+
+/*********************************************************** Data Definitions */
+
+/*
+ * A `Cell` is:
+ * + A sequence number, telling which lap of the ring the cell is ready for.
+ *   A cell at index `i` is free for the enqueue at position `pos` when its
+ *   sequence is `pos`, and full for the dequeue at position `pos` when it is
+ *   `pos + 1`.
+ * + A void pointer to the item held.
+ */
+typedef struct cell
+{
+    size_t seq;
+    Element item;
+} Cell;
+
+/*
+ * # Datatype completion
+ *
+ * A `MPMCQueueADT` object is:
+ *  + A dynamically allocated array of cells, a power of two no smaller than two
+ *    long.
+ *  + The number of cells minus one, masking a position into an index.
+ *  + The position of the next enqueue, ever increasing.  Claimed by producers
+ *    with a compare-and-swap.
+ *  + The position of the next dequeue, ever increasing.  Claimed by consumers
+ *    with a compare-and-swap.
+ *
+ * A producer owns a cell once it moves `enqueue_pos` past it, fills it, then
+ * publishes it by storing `pos + 1` into its sequence.  A consumer owns a cell
+ * once it moves `dequeue_pos` past it, empties it, then hands it to the next
+ * lap by storing `pos + mask + 1`.  No lock is ever held.
+ */
+struct mpmc_queue_type
+{
+    Cell *cells;
+    size_t mask;
+    char pad0[CACHE_LINE_SIZE - sizeof(Cell *) - sizeof(size_t)];
+
+    size_t enqueue_pos;
+    char pad1[CACHE_LINE_SIZE - sizeof(size_t)];
+
+    size_t dequeue_pos;
+    char pad2[CACHE_LINE_SIZE - sizeof(size_t)];
+};
+
+/********************************************************** Private Functions */
+
+/*
+ * Returns the closest power of two greater than or equal to `n`, and no
+ * smaller than two.  With a single cell, a full cell's sequence (`pos + 1`)
+ * would read as free for the next lap.
+ */
+static inline size_t get_next_pow2(size_t n)
+{
+    size_t pow2 = 2;
+
+    while (pow2 < n)
+    {
+        pow2 *= 2;
+    }
+    return pow2;
+}
+
+/***************************************************** Public Implementations */
+
+/*
+ * Create multi-producer multi-consumer queue
+ */
+MPMCQueueADT *cadtmpmcqueue_new(size_t size)
+{
+    MPMCQueueADT *new;
+    void *mem;
+    size_t i;
+
+    if (size == 0 || size > SIZE_MAX / 2)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (posix_memalign(&mem, CACHE_LINE_SIZE, sizeof(struct mpmc_queue_type)) != 0)
+    {
+        perror("cadtmpmcqueue_new posix_memalign failed allocating struct mpmc_queue_type");
+        errno = ENOMEM;
+        return NULL;
+    }
+    new = mem;
+
+    size = get_next_pow2(size);
+
+    new->cells = malloc(size * sizeof(Cell));
+    if (new->cells == NULL)
+    {
+        perror("cadtmpmcqueue_new malloc failed allocating Cell array");
+        free(new);
+        return NULL;
+    }
+
+    for (i = 0; i < size; i++)
+    {
+        new->cells[i].seq = i;
+    }
+    new->mask = size - 1;
+    new->enqueue_pos = 0;
+    new->dequeue_pos = 0;
+
+    return new;
+}
+
+/*
+ * Destroy queue
+ */
+void cadtmpmcqueue_destroy(MPMCQueueADT *q)
+{
+    free(q->cells);
+    free(q);
+    return;
+}
+
+/*
+ * Return the number of elements `q` currently holds
+ */
+size_t cadtmpmcqueue_nelems(MPMCQueueADT *q)
+{
+    size_t dequeue_pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_ACQUIRE);
+    size_t enqueue_pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_ACQUIRE);
+
+    /* Both loads are not taken at once, clamp to the queue's bounds */
+    if (enqueue_pos < dequeue_pos)
+    {
+        return 0;
+    }
+    if (enqueue_pos - dequeue_pos > q->mask + 1)
+    {
+        return q->mask + 1;
+    }
+    return enqueue_pos - dequeue_pos;
+}
+
+/*
+ * Return the maximum number of elements `q` can hold
+ */
+size_t cadtmpmcqueue_capacity(MPMCQueueADT *q)
+{
+    return q->mask + 1;
+}
+
+/*
+ * Append element to `q`
+ */
+Element cadtmpmcqueue_enqueue(MPMCQueueADT *q, Element e)
+{
+    size_t pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+    Cell *cell;
+
+    for (;;)
+    {
+        size_t seq;
+
+        cell = &q->cells[pos & q->mask];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == pos)
+        {
+            /* Free for this lap, try to claim it */
+            if (__atomic_compare_exchange_n(&q->enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+            /* Lost the race, `pos` now holds the current position */
+        }
+        else if ((intptr_t) (seq - pos) < 0)
+        {
+            /* handle queue overflow, the cell still holds last lap's item */
+            errno = EPERM;
+            return NULL;
+        }
+        else
+        {
+            pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->item = e;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+    return e;
+}
+
+/*
+ * Remove element at the front of `q`
+ */
+Element cadtmpmcqueue_dequeue(MPMCQueueADT *q)
+{
+    size_t pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+    Element ret;
+    Cell *cell;
+
+    for (;;)
+    {
+        size_t seq;
+
+        cell = &q->cells[pos & q->mask];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == pos + 1)
+        {
+            /* Full for this lap, try to claim it */
+            if (__atomic_compare_exchange_n(&q->dequeue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if ((intptr_t) (seq - (pos + 1)) < 0)
+        {
+            /* handle queue underflow, no producer has published this cell */
+            errno = EPERM;
+            return NULL;
+        }
+        else
+        {
+            pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    ret = cell->item;
+    __atomic_store_n(&cell->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+
+    return ret;
+}
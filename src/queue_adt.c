@@ -1,40 +1,52 @@
+#define CADT_QUEUE_SOURCE
 #include "queue_adt.h"
+#include "queue_adt_inline.h"
 
-#define HALF 0.5
-#define TWICE 2.0
+#include <stdint.h>
+
+/* Runs of up to this many elements are copied without `memcpy` */
+#define SHORT_RUN 8
 
 /*********************************************************** Data Definitions */
 /*
  * # Datatype completion
  *
- * A `QueueADT` object is:  
- *  + A dynamically allocated array of void pointers.
- *  + The index of the first item that arrived in the queue.
- *  + The index of the last item that arrived in the queue.
- *  + The number of elements currently in the queue.
- *  + The array's minimum size.
- *  + The array's current maximum size.
- *  + A flag that determines whether the queue is dynamic or not.
- */
-struct queue_type
-{
-    Element *contents;
-    size_t head;
-    size_t tail;
-    size_t nelems;
-    size_t min_size;
-    size_t curr_max_size;
-    int is_fix;
-};
+ * The `QueueADT` object is completed in queue_adt_inline.h, where the inline
+ * fast paths of `CADT_INLINE` can reach its fields.
+ */
 
 /********************************************************** Private Functions */ 
 
+/*
+ * Returns non-zero if the size of `q` is a power of two
+ */
+static inline int is_pow2(QueueADT *q)
+{
+    return q->is_pow2;
+}
+
+/*
+ * Returns the number of elements in `q`
+ */
+static inline size_t count(QueueADT *q)
+{
+    return is_pow2(q) ? (q->tail - q->head) : q->nelems;
+}
+
+/*
+ * Returns the index of the first item of `q`
+ */
+static inline size_t first_index(QueueADT *q)
+{
+    return is_pow2(q) ? (q->head & (q->curr_max_size - 1)) : q->head;
+}
+
 /*
  * Returns non-zero if `q` is full
  */
 static inline int is_full(QueueADT *q)
 {
-    return (q->nelems == q->curr_max_size);
+    return (count(q) == q->curr_max_size);
 }
 
 /*
@@ -45,71 +57,179 @@ static inline int is_fix(QueueADT *q)
     return q->is_fix;
 }
 
+/*
+ * Returns the closest power of two greater than or equal to `n`, or zero if
+ * there is none.
+ */
+static inline size_t get_next_pow2(size_t n)
+{
+    size_t pow2 = 1;
 
-/* 
+    if (n > SIZE_MAX / 2 + 1)
+    {
+        return 0;
+    }
+    while (pow2 < n)
+    {
+        pow2 *= 2;
+    }
+    return pow2;
+}
+
+/*
+ * Returns the size `q` never shrinks below.
+ */
+static inline size_t floor_size(QueueADT *q)
+{
+    return cadt_policy_floor(&q->policy, q->min_size);
+}
+
+/*
+ * Returns the number of elements below which a dequeue shrinks an array of
+ * `size` elements, zero if it never does.
+ */
+static inline size_t shrink_threshold(QueueADT *q, size_t size)
+{
+    return cadt_policy_shrink_threshold(&q->policy, size, floor_size(q));
+}
+
+/*
+ * Returns the size a full array of `size` elements grows to, rounded up to a
+ * power of two in power of two mode.
+ */
+static inline size_t grown_size(QueueADT *q, size_t size)
+{
+    size_t new_size = cadt_policy_grown_size(&q->policy, size);
+
+    if (is_pow2(q))
+    {
+        new_size = get_next_pow2(new_size);
+        return (new_size != 0) ? new_size : SIZE_MAX;
+    }
+    return new_size;
+}
+
+/*
+ * Returns the size an array of `size` elements shrinks to, never below the 
+ * floor of `q` nor its elements, and rounded up to a power of two in power of
+ * two mode.
+ */
+static inline size_t shrunk_size(QueueADT *q, size_t size)
+{
+    size_t new_size = cadt_policy_shrunk_size(&q->policy, size, floor_size(q),
+                                              count(q));
+
+    return is_pow2(q) ? get_next_pow2(new_size) : new_size;
+}
+
+/*
  * Copies into `new[]` `q->contents[]` shifting to lower indexes if necessary.
- */ 
+ */
 static inline void shift_elements(QueueADT *q, Element new[])
 {
-    if (q->head > q->tail)
-    {
-        /*    <---                   --->            */
-        /* | x | x |   |   |   |   | x | x | x | x | */
-        /*       tl                  hd              */
+    cadt_ring_unwrap(new, q->contents, q->curr_max_size, first_index(q),
+                     count(q));
+}
 
-        size_t hdbytes = sizeof(Element) * (q->curr_max_size - q->head);
-        size_t tlbytes = sizeof(Element) * (q->tail + 1);
+/*
+ * Copies `n` elements from `src[]` into `dst[]`.  Short runs are copied in
+ * place, sparing the call to `memcpy`.
+ */
+static inline void copy_run(Element *dst, const Element *src, size_t n)
+{
+    size_t i;
 
-        memcpy(&new[0], &q->contents[q->head], hdbytes);
-        memcpy(&new[q->curr_max_size - q->head], &q->contents[0], tlbytes);
+    if (n > SHORT_RUN)
+    {
+        memcpy(dst, src, n * sizeof(Element));
+        return;
     }
-    else
+    for (i = 0; i < n; i++)
     {
-        /*                       --->    < ---
-         * |   |   |   |   |   | x | x | x | x |   | */
-        /*                       hd          tl      */
+        dst[i] = src[i];
+    }
+}
 
-        size_t bytes = sizeof(Element) * (q->nelems);
+/*
+ * Returns the index `n` slots past index `i` (wrap-around), for `n` up to the
+ * size of `q`.
+ */
+static inline size_t index_after(QueueADT *q, size_t i, size_t n)
+{
+    i += n;
+    return (i >= q->curr_max_size) ? (i - q->curr_max_size) : i;
+}
 
-        memcpy(&new[0], &q->contents[q->head], bytes);
+#if defined(CADT_STATS)
+/*
+ * Counts the resize of `q` to `new_size` elements, before it happens.
+ */
+static inline void count_resize(QueueADT *q, size_t new_size)
+{
+    if (new_size > q->curr_max_size)
+    {
+        q->stats.ngrows++;
     }
+    else
+    {
+        q->stats.nshrinks++;
+    }
+    q->stats.bytes_copied += count(q) * sizeof(Element);
 }
 
 /*
- * Reallocates `q->contents[]` to an array half or twice the current size
- * depending upon factor.
+ * Raises the high-water mark of `q` to its number of elements.
  */
-static inline Element *resize_contents_array(QueueADT *q, double factor)
-{     
-    Element *new; 
-    size_t new_size; 
-
-    /* Set new size */
-    if (factor == TWICE)
+static inline void count_enqueue(QueueADT *q)
+{
+    if (count(q) > q->stats.high_water)
     {
-        new_size = q->curr_max_size * 2;
+        q->stats.high_water = count(q);
     }
-    if (factor == HALF)
+}
+#endif
+
+/*
+ * Reallocates `q->contents[]` to an array of `new_size` elements, which must be
+ * enough to hold those in `q`.
+ */
+static CADT_SLOW_PATH Element *resize_contents_to(QueueADT *q, size_t new_size)
+{
+    Element *new;
+
+    if (new_size > SIZE_MAX / sizeof(Element))
     {
-        new_size = q->curr_max_size / 2;
+        errno = ENOMEM;
+        return NULL;
     }
 
     /* Allocate new array */
-    new = malloc(new_size * sizeof(Element));
+    new = cadt_alloc(&q->allocator, new_size * sizeof(Element));
     if (new == NULL)
     {
         perror("double_contents_size malloc failed allocating Element array: ");
+        errno = ENOMEM;
         return NULL;
     }
 
+    CADT_STATS_ONLY(count_resize(q, new_size));
     shift_elements(q, new);
-    free(q->contents);
+    cadt_free(&q->allocator, q->contents, q->curr_max_size * sizeof(Element));
 
     /* Update internal values */
     q->contents = new;
+    if (is_pow2(q))
+    {
+        q->tail = count(q);
+    }
+    else
+    {
+        /* an empty queue keeps its tail on its head */
+        q->tail = (q->nelems != 0) ? (q->nelems - 1) : 0;
+    }
     q->head = 0;
-    q->tail = q->nelems - 1;
     q->curr_max_size = new_size;
+    q->shrink_at = shrink_threshold(q, new_size);
 
     return q->contents;
 }
@@ -120,26 +240,38 @@ static inline Element *resize_contents_array(QueueADT *q, double factor)
  * Create non-circular (dynamic) queue
  */
 QueueADT *cadtqueue_new(size_t size)
+{
+    static const Allocator default_allocator = CADT_ALLOCATOR_DEFAULT;
+
+    return cadtqueue_new_with_allocator(size, &default_allocator);
+}
+
+/*
+ * Create non-circular (dynamic) queue, allocating through `a`
+ */
+QueueADT *cadtqueue_new_with_allocator(size_t size, const Allocator *a)
 {
     QueueADT *new;
 
-    if (size == 0)
+    if (size == 0 || a == NULL || !cadt_is_valid_allocator(a))
     {
         errno = EINVAL;
         return NULL;
     }
 
-    new = malloc(sizeof(struct queue_type));
+    new = cadt_alloc(a, sizeof(struct queue_type));
     if (new == NULL)
     { 
         perror("cadtqueue_new malloc failed allocating struct queue_type");
         return NULL;
     }
+    new->allocator = *a;
     
-    new->contents = malloc(size * sizeof(Element));
+    new->contents = cadt_alloc(a, size * sizeof(Element));
     if (new->contents == NULL)
     {
         perror("cadtqueue_new malloc failed allocating Element array");
+        cadt_free(a, new, sizeof(struct queue_type));
         return NULL;
     }
 
@@ -149,6 +281,9 @@ QueueADT *cadtqueue_new(size_t size)
     new->min_size = size;
     new->curr_max_size = size;
     new->is_fix = 0;
+    new->is_pow2 = 0;
+    CADT_STATS_ONLY(new->stats = (ContainerStats) { 0 });
+    cadtqueue_set_policy(new, NULL);
 
     return new;
 }
@@ -168,13 +303,52 @@ QueueADT *cadtqueue_new_circular(size_t size)
     return new;
 }
 
+/*
+ * Create non-circular (dynamic) queue of a power of two size
+ */
+QueueADT *cadtqueue_new_pow2(size_t size)
+{
+    QueueADT *new;
+    size_t pow2 = get_next_pow2(size);
+
+    if (size == 0 || pow2 == 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    new = cadtqueue_new(pow2);
+    if (new == NULL)
+    {
+        return NULL;
+    }
+    new->is_pow2 = 1;
+
+    return new;
+}
+
+/*
+ * Create circular (fixed-size) queue of a power of two size
+ */
+QueueADT *cadtqueue_new_circular_pow2(size_t size)
+{
+    QueueADT *new = cadtqueue_new_pow2(size);
+    if (new == NULL)
+    {
+        return NULL;
+    }
+    new->is_fix = 1;
+
+    return new;
+}
+
 /*
  * Destroy queue
  */
 void cadtqueue_destroy(QueueADT *q)
 {
-    free(q->contents);
-    free(q);
+    cadt_free(&q->allocator, q->contents, q->curr_max_size * sizeof(Element));
+    cadt_free(&q->allocator, q, sizeof(struct queue_type));
     return;
 }
 
@@ -183,7 +357,58 @@ void cadtqueue_destroy(QueueADT *q)
  */
 size_t cadtqueue_nelems(QueueADT *q)
 {
-    return q->nelems;
+    return count(q);
+}
+
+/*
+ * Set how `q` grows and shrinks
+ */
+QueueADT *cadtqueue_set_policy(QueueADT *q, const ResizePolicy *policy)
+{
+    static const ResizePolicy default_policy = CADT_RESIZE_POLICY_DEFAULT;
+    ResizePolicy new_policy;
+
+    if (policy == NULL)
+    {
+        policy = &default_policy;
+    }
+    new_policy = *policy;
+    if (is_pow2(q) && new_policy.min_size != 0)
+    {
+        new_policy.min_size = get_next_pow2(new_policy.min_size);
+    }
+    if (!cadt_policy_is_valid(policy) 
+        || (policy->min_size != 0 && new_policy.min_size == 0))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    q->policy = new_policy;
+    q->shrink_at = shrink_threshold(q, q->curr_max_size);
+
+    return q;
+}
+
+/*
+ * Release the room `q` does not use
+ */
+QueueADT *cadtqueue_trim(QueueADT *q)
+{
+    size_t new_size = (count(q) > floor_size(q)) ? count(q) : floor_size(q);
+
+    if (is_pow2(q))
+    {
+        new_size = get_next_pow2(new_size);
+    }
+    if (!is_fix(q) && new_size < q->curr_max_size)
+    {
+        if (resize_contents_to(q, new_size) == NULL)
+        {
+            return NULL;
+        }
+    }
+    return q;
 }
 
 /*
@@ -192,23 +417,27 @@ size_t cadtqueue_nelems(QueueADT *q)
 QueueADT *cadtqueue_clear(QueueADT *q)
 {
     /* q has grown, make a new queue for resizing*/
-    if (q->curr_max_size > q->min_size) 
+    if (!is_fix(q) && !q->policy.lazy && q->curr_max_size > floor_size(q))
     {                                    
-        Element *new = malloc(q->min_size * sizeof(Element));
+        Element *new = cadt_alloc(&q->allocator,
+                                  floor_size(q) * sizeof(Element));
         if (new== NULL)
         {
             perror("cadtqueue_clear malloc failed allocating Element array");
             return NULL;
         }
 
-        free(q->contents);
+        cadt_free(&q->allocator, q->contents,
+                  q->curr_max_size * sizeof(Element));
         q->contents = new;
+        q->curr_max_size = floor_size(q);
+        CADT_STATS_ONLY(q->stats.nshrinks++);
+        q->shrink_at = shrink_threshold(q, q->curr_max_size);
     }
     /* q hasn't grown or is fixed in size */
     q->head = 0;
     q->tail = 0;
     q->nelems = 0;
-    q->curr_max_size = q->min_size;
     return q;
 }
 
@@ -224,7 +453,7 @@ Element cadtqueue_peek_first(QueueADT *q)
         return NULL;
     }
 
-    return q->contents[q->head];
+    return q->contents[first_index(q)];
 }
 
 /*
@@ -239,6 +468,10 @@ Element cadtqueue_peek_rear(QueueADT *q)
         return NULL;
     }
 
+    if (is_pow2(q))
+    {
+        return q->contents[(q->tail - 1) & (q->curr_max_size - 1)];
+    }
     return q->contents[q->tail];
 }
 
@@ -256,12 +489,20 @@ Element cadtqueue_enqueue(QueueADT *q, Element e)
     /* handle dynamic queue */
     if (!is_fix(q) && is_full(q))
     {
-        if (resize_contents_array(q, TWICE) == NULL)
+        if (resize_contents_to(q, grown_size(q, q->curr_max_size)) == NULL)
         {
             return NULL;
         }
     }
 
+    /* counters only ever increase, the mask does the wrap-around */
+    if (is_pow2(q))
+    {
+        q->contents[q->tail++ & (q->curr_max_size - 1)] = e;
+        CADT_STATS_ONLY(count_enqueue(q));
+        return e;
+    }
+
     /* update tail index (wrap-around) */ 
     if (q->nelems >= 1)
     {
@@ -270,6 +511,7 @@ Element cadtqueue_enqueue(QueueADT *q, Element e)
 
     q->contents[q->tail] = e;
     q->nelems++; 
+    CADT_STATS_ONLY(count_enqueue(q));
 
     return e;
 }
@@ -280,22 +522,25 @@ Element cadtqueue_enqueue(QueueADT *q, Element e)
 Element cadtqueue_dequeue(QueueADT *q)
 {
     Element ret;
-    double usage = (double) q->nelems / (double) q->curr_max_size;
 
     /* handle queue underflow */
-    if (q->nelems == 0)
+    if (count(q) == 0)
     {
         errno = EPERM;
         return NULL;
     }
 
-    else if (!is_fix(q) && usage < 0.25)
+    /* usage below the policy's threshold, on failure `q` keeps its size */
+    else if (!is_fix(q) && count(q) < q->shrink_at
+             && shrunk_size(q, q->curr_max_size) < q->curr_max_size)
     {
         /* make it small */;
-        if (resize_contents_array(q, HALF) == NULL)
-        {
-            return NULL;
-        }
+        resize_contents_to(q, shrunk_size(q, q->curr_max_size));
+    }
+
+    if (is_pow2(q))
+    {
+        return q->contents[q->head++ & (q->curr_max_size - 1)];
     }
 
     /* get element at head */
@@ -310,3 +555,143 @@ Element cadtqueue_dequeue(QueueADT *q)
 
     return ret;
 }
+
+/*
+ * Append `n` elements to `q` at once
+ */
+size_t cadtqueue_enqueue_n(QueueADT *q, const Element *src, size_t n)
+{
+    size_t nelems = count(q);
+    size_t start, nrun;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+    if (src == NULL)
+    {
+        errno = EINVAL;
+        return 0;
+    }
+
+    /* handle dynamic queue, growing once to fit the whole batch */
+    if (!is_fix(q) && n > q->curr_max_size - nelems)
+    {
+        size_t new_size = q->curr_max_size;
+
+        while (n > new_size - nelems)
+        {
+            new_size = grown_size(q, new_size);
+        }
+        if (resize_contents_to(q, new_size) == NULL)
+        {
+            return 0;
+        }
+    }
+
+    /* handle queue overflow, enqueue as many as fit */
+    if (n > q->curr_max_size - nelems)
+    {
+        n = q->curr_max_size - nelems;
+        if (n == 0)
+        {
+            errno = EPERM;
+            return 0;
+        }
+    }
+
+    /* copy up to the end of the array, then the rest from its start */
+    start = index_after(q, first_index(q), nelems);
+    nrun = (n < q->curr_max_size - start) ? n : (q->curr_max_size - start);
+    copy_run(&q->contents[start], &src[0], nrun);
+    copy_run(&q->contents[0], &src[nrun], n - nrun);
+
+    if (is_pow2(q))
+    {
+        q->tail += n;
+    }
+    else
+    {
+        q->tail = index_after(q, start, n - 1);
+        q->nelems += n;
+    }
+    CADT_STATS_ONLY(count_enqueue(q));
+
+    return n;
+}
+
+/*
+ * Remove up to `n` elements at the front of `q` at once
+ */
+size_t cadtqueue_dequeue_n(QueueADT *q, Element *dst, size_t n)
+{
+    size_t nelems = count(q);
+    size_t first, nrun, new_size;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+    if (dst == NULL)
+    {
+        errno = EINVAL;
+        return 0;
+    }
+
+    /* handle queue underflow */
+    if (nelems == 0)
+    {
+        errno = EPERM;
+        return 0;
+    }
+    if (n > nelems)
+    {
+        n = nelems;
+    }
+
+    /* copy up to the end of the array, then the rest from its start */
+    first = first_index(q);
+    nrun = (n < q->curr_max_size - first) ? n : (q->curr_max_size - first);
+    copy_run(&dst[0], &q->contents[first], nrun);
+    copy_run(&dst[nrun], &q->contents[0], n - nrun);
+
+    if (is_pow2(q))
+    {
+        q->head += n;
+    }
+    else
+    {
+        q->nelems -= n;
+        /* an empty queue keeps its head on its tail */
+        q->head = (q->nelems != 0) ? index_after(q, first, n) : q->tail;
+    }
+
+    /* make it small, once for the whole batch */
+    new_size = q->curr_max_size;
+    while (!is_fix(q) && count(q) < shrink_threshold(q, new_size)
+           && shrunk_size(q, new_size) < new_size)
+    {
+        new_size = shrunk_size(q, new_size);
+    }
+    if (new_size != q->curr_max_size)
+    {
+        resize_contents_to(q, new_size);
+    }
+
+    return n;
+}
+
+#if defined(CADT_STATS)
+/*
+ * Return the statistics of `q`
+ */
+ContainerStats cadtqueue_stats(QueueADT *q)
+{
+    ContainerStats stats = q->stats;
+
+    stats.nelems = count(q);
+    stats.capacity = q->curr_max_size;
+
+    return stats;
+}
+#endif
@@ -0,0 +1,169 @@
+/* posix_memalign() for pure c99 compilers */
+#if !defined(_POSIX_C_SOURCE) || _POSIX_C_SOURCE < 200112L
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "spscqueue_adt.h"
+
+/* Indexes are padded to a whole line so producer and consumer never share one */
+#define CACHE_LINE_SIZE 64
+
+/*********************************************************** Data Definitions */
+/*
+ * # Datatype completion
+ *
+ * A `SPSCQueueADT` object is:
+ *  + A dynamically allocated array of void pointers, with one more slot than
+ *    the queue's size.  One slot is always left free, so that a full queue
+ *    (`next(tail) == head`) can be told apart from an empty one
+ *    (`tail == head`) without a shared element count.
+ *  + The number of slots of the array.
+ *  + The index of the first item that arrived in the queue.  Written by the
+ *    consumer, read by the producer.
+ *  + The consumer's copy of `tail`, refreshed only when the queue looks empty.
+ *  + The index of the slot the next item will be stored in.  Written by the
+ *    producer, read by the consumer.
+ *  + The producer's copy of `head`, refreshed only when the queue looks full.
+ *
+ * Each side's index and cached copy share a cache line that the other side
+ * only reads from, so a handoff moves at most two lines between cores.
+ */
+struct spsc_queue_type
+{
+    Element *contents;
+    size_t nslots;
+    char pad0[CACHE_LINE_SIZE - sizeof(Element *) - sizeof(size_t)];
+
+    size_t head;
+    size_t cached_tail;
+    char pad1[CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+
+    size_t tail;
+    size_t cached_head;
+    char pad2[CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+};
+
+/********************************************************** Private Functions */
+
+/*
+ * Returns the index following `i` (wrap-around)
+ */
+static inline size_t next_index(SPSCQueueADT *q, size_t i)
+{
+    return (i == q->nslots - 1) ? 0 : (i + 1);
+}
+
+/***************************************************** Public Implementations */
+
+/*
+ * Create single-producer single-consumer queue
+ */
+SPSCQueueADT *cadtspscqueue_new(size_t size)
+{
+    SPSCQueueADT *new;
+    void *mem;
+
+    if (size == 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (posix_memalign(&mem, CACHE_LINE_SIZE, sizeof(struct spsc_queue_type)) != 0)
+    {
+        perror("cadtspscqueue_new posix_memalign failed allocating struct spsc_queue_type");
+        errno = ENOMEM;
+        return NULL;
+    }
+    new = mem;
+
+    new->contents = malloc((size + 1) * sizeof(Element));
+    if (new->contents == NULL)
+    {
+        perror("cadtspscqueue_new malloc failed allocating Element array");
+        free(new);
+        return NULL;
+    }
+
+    new->nslots = size + 1;
+    new->head = 0;
+    new->cached_tail = 0;
+    new->tail = 0;
+    new->cached_head = 0;
+
+    return new;
+}
+
+/*
+ * Destroy queue
+ */
+void cadtspscqueue_destroy(SPSCQueueADT *q)
+{
+    free(q->contents);
+    free(q);
+    return;
+}
+
+/*
+ * Return the number of elements `q` currently holds
+ */
+size_t cadtspscqueue_nelems(SPSCQueueADT *q)
+{
+    size_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+
+    return (tail >= head) ? (tail - head) : (q->nslots - head + tail);
+}
+
+/*
+ * Append element to `q`, producer side
+ */
+Element cadtspscqueue_enqueue(SPSCQueueADT *q, Element e)
+{
+    size_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    size_t next = next_index(q, tail);
+
+    /* handle queue overflow, only reading `head` if the cached one says full */
+    if (next == q->cached_head)
+    {
+        q->cached_head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+        if (next == q->cached_head)
+        {
+            errno = EPERM;
+            return NULL;
+        }
+    }
+
+    q->contents[tail] = e;
+    /* publish the element along with the new tail */
+    __atomic_store_n(&q->tail, next, __ATOMIC_RELEASE);
+
+    return e;
+}
+
+/*
+ * Remove element at the front of `q`, consumer side
+ */
+Element cadtspscqueue_dequeue(SPSCQueueADT *q)
+{
+    size_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    Element ret;
+
+    /* handle queue underflow, only reading `tail` if the cached one says empty */
+    if (head == q->cached_tail)
+    {
+        q->cached_tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+        if (head == q->cached_tail)
+        {
+            errno = EPERM;
+            return NULL;
+        }
+    }
+
+    ret = q->contents[head];
+    /* hand the slot back to the producer */
+    __atomic_store_n(&q->head, next_index(q, head), __ATOMIC_RELEASE);
+
+    return ret;
+}
@@ -1,25 +1,17 @@
+#define CADT_STACK_SOURCE
 #include "stack_adt.h"
+#include "stack_adt_inline.h"
+
+#include <stdint.h>
 
 /*********************************************************** Data Definitions */
+
 /*
  * # Datatype completion
  *
- * A `StackADT` object is:  
- *  + A dynamically allocated array of void pointers.
- *  + The array's minimum size.
- *  + The array's current maximum size.
- *  + The index of its top element.
- *  + A flag that determines whether the stack is of fixed size or may possibly
- *    grow 
- */
-struct stack_type
-{
-    Element *contents;
-    size_t min_size;
-    size_t curr_max_size;
-    size_t top;
-    int is_fix;
-};
+ * The `StackADT` object is completed in stack_adt_inline.h, where the inline
+ * fast paths of `CADT_INLINE` can reach its fields.
+ */
 
 /**************************************************** Private Implementations */ 
 
@@ -39,32 +31,229 @@ static inline int is_fix(StackADT *s)
     return s->is_fix;
 }
 
+/*
+ * Tests whether `s` is segmented
+ */
+static inline int is_seg(StackADT *s)
+{
+    return s->is_seg;
+}
+
+/*
+ * Returns the size `s` never shrinks below.
+ */
+static inline size_t floor_size(StackADT *s)
+{
+    return cadt_policy_floor(&s->policy, s->min_size);
+}
+
+/*
+ * Returns the number of elements below which a pop shrinks an array of `size`
+ * elements, zero if it never does.
+ */
+static inline size_t shrink_threshold(StackADT *s, size_t size)
+{
+    return cadt_policy_shrink_threshold(&s->policy, size, floor_size(s));
+}
+
+#if defined(CADT_STATS)
+/*
+ * Counts the resize of `s` to `new_size` elements, before it happens.
+ */
+static inline void count_resize(StackADT *s, size_t new_size)
+{
+    if (new_size > s->curr_max_size)
+    {
+        s->stats.ngrows++;
+    }
+    else
+    {
+        s->stats.nshrinks++;
+    }
+    s->stats.bytes_copied += s->top * sizeof(Element);
+}
+
+/*
+ * Raises the high-water mark of `s` to its number of elements.
+ */
+static inline void count_push(StackADT *s)
+{
+    if (s->top > s->stats.high_water)
+    {
+        s->stats.high_water = s->top;
+    }
+}
+#endif
+
+/*
+ * Returns the size in bytes of a segment of `s`.
+ */
+static inline size_t segment_bytes(StackADT *s)
+{
+    return sizeof(StackSegment) + s->min_size * sizeof(Element);
+}
+
+/*
+ * Reallocates `s->contents[]` to an array of `new_size` elements, leaving `s`
+ * untouched on failure.
+ */
+static CADT_SLOW_PATH Element *resize_contents_to(StackADT *s, size_t new_size)
+{
+    Element *p;
+
+    if (new_size > SIZE_MAX / sizeof(Element))
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    p = cadt_realloc(&s->allocator, s->contents,
+                     s->curr_max_size * sizeof(Element),
+                     new_size * sizeof(Element));
+    if (p == NULL)
+    {
+        perror("resize_contents_to (Realloc)");
+        errno = ENOMEM;
+        return NULL;
+    }
+    CADT_STATS_ONLY(count_resize(s, new_size));
+    s->contents = p;
+    s->curr_max_size = new_size;
+    s->shrink_at = shrink_threshold(s, new_size);
+
+    return p;
+}
+
+/*
+ * Returns the size a full `s` grows to.
+ */
+static inline size_t grown_size(StackADT *s)
+{
+    return cadt_policy_grown_size(&s->policy, s->curr_max_size);
+}
+
+/*
+ * Returns the size `s` shrinks to, never below its floor nor its elements.
+ */
+static inline size_t shrunk_size(StackADT *s)
+{
+    return cadt_policy_shrunk_size(&s->policy, s->curr_max_size, floor_size(s),
+                                   s->top);
+}
+
+/*
+ * Allocates a segment of `s->min_size` slots, returns `NULL` on failure.
+ */
+static StackSegment *segment_new(StackADT *s)
+{
+    StackSegment *seg;
+
+    if (s->min_size > (SIZE_MAX - sizeof(StackSegment)) / sizeof(Element))
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    seg = cadt_alloc(&s->allocator, segment_bytes(s));
+    if (seg == NULL)
+    {
+        perror("segment_new malloc failed allocating StackSegment");
+        return NULL;
+    }
+    seg->prev = NULL;
+
+    return seg;
+}
+
+/*
+ * Keeps the emptied segment `seg` as the spare of `s`, or frees it if there
+ * is one already.
+ */
+static inline void release_segment(StackADT *s, StackSegment *seg)
+{
+    if (s->spare == NULL)
+    {
+        s->spare = seg;
+        return;
+    }
+    cadt_free(&s->allocator, seg, segment_bytes(s));
+}
+
+/*
+ * Moves the top of a full segmented `s` onto a new segment, the spare one if
+ * any.  Only the spare's absence costs an allocation.
+ */
+static CADT_SLOW_PATH Element *push_segment(StackADT *s)
+{
+    StackSegment *seg = s->spare;
+
+    if (seg == NULL && (seg = segment_new(s)) == NULL)
+    {
+        return NULL;
+    }
+    s->spare = NULL;
+    seg->prev = s->seg;
+    s->seg = seg;
+    s->contents = seg->slots;
+    s->base = s->curr_max_size;
+    s->curr_max_size += s->min_size;
+    CADT_STATS_ONLY(s->stats.ngrows++);
+
+    return s->contents;
+}
+
+/*
+ * Moves the top of `s`, whose top segment is empty, down to the segment
+ * below, keeping the emptied one as the spare.
+ */
+static CADT_SLOW_PATH void pop_segment(StackADT *s)
+{
+    StackSegment *seg = s->seg;
+
+    s->seg = seg->prev;
+    s->contents = s->seg->slots;
+    s->curr_max_size -= s->min_size;
+    s->base -= s->min_size;
+    CADT_STATS_ONLY(s->stats.nshrinks++);
+    release_segment(s, seg);
+}
+
 /***************************************************** Public Implementations */
 
 /* 
  * Create variable size stack 
  */
 StackADT *cadtstack_new(size_t size)
+{
+    static const Allocator default_allocator = CADT_ALLOCATOR_DEFAULT;
+
+    return cadtstack_new_with_allocator(size, &default_allocator);
+}
+
+/*
+ * Create variable size stack, allocating through `a`
+ */
+StackADT *cadtstack_new_with_allocator(size_t size, const Allocator *a)
 {
     StackADT *new;
 
-    if (size == 0)
+    if (size == 0 || a == NULL || !cadt_is_valid_allocator(a))
     {
         errno = EINVAL;
         return NULL;
     }
 
-    new = malloc(sizeof (struct stack_type));
+    new = cadt_alloc(a, sizeof (struct stack_type));
     if (new == NULL)
     {
         perror("cadtstack_new malloc failed allocating struct stack_type");
         return NULL;
     }
-    new->contents = malloc(size * sizeof(Element));
+    new->allocator = *a;
+    new->contents = cadt_alloc(a, size * sizeof(Element));
 
     if (new->contents == NULL)
     {
         perror("cadtstack_new malloc failed allocating Element");
+        cadt_free(a, new, sizeof (struct stack_type));
         return NULL;
     }
 
@@ -72,6 +261,12 @@ StackADT *cadtstack_new(size_t size)
     new->curr_max_size = size;
     new->top = 0;
     new->is_fix = 0;
+    new->is_seg = 0;
+    new->base = 0;
+    new->seg = NULL;
+    new->spare = NULL;
+    CADT_STATS_ONLY(new->stats = (ContainerStats) { 0 });
+    cadtstack_set_policy(new, NULL);
 
     return new;
 }
@@ -91,13 +286,77 @@ StackADT *cadtstack_new_fix(size_t size)
     return new;
 }
 
+/*
+ * Create segmented stack
+ */
+StackADT *cadtstack_new_segmented(size_t size)
+{
+    static const Allocator default_allocator = CADT_ALLOCATOR_DEFAULT;
+
+    return cadtstack_new_segmented_with_allocator(size, &default_allocator);
+}
+
+/*
+ * Create segmented stack, allocating through `a`
+ */
+StackADT *cadtstack_new_segmented_with_allocator(size_t size,
+                                                 const Allocator *a)
+{
+    StackADT *new;
+
+    if (size == 0 || a == NULL || !cadt_is_valid_allocator(a))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    new = cadt_alloc(a, sizeof (struct stack_type));
+    if (new == NULL)
+    {
+        perror("cadtstack_new_segmented malloc failed allocating struct stack_type");
+        return NULL;
+    }
+    new->allocator = *a;
+    new->min_size = size;
+    new->seg = segment_new(new);
+    if (new->seg == NULL)
+    {
+        cadt_free(a, new, sizeof (struct stack_type));
+        return NULL;
+    }
+
+    new->contents = new->seg->slots;
+    new->curr_max_size = size;
+    new->top = 0;
+    new->is_fix = 0;
+    new->is_seg = 1;
+    new->base = 0;
+    new->spare = NULL;
+    CADT_STATS_ONLY(new->stats = (ContainerStats) { 0 });
+    cadtstack_set_policy(new, NULL);
+
+    return new;
+}
+
 /*
  * Destroy stack
  */
 void cadtstack_destroy(StackADT *s)
 {
-    free(s->contents);
-    free(s);
+    if (is_seg(s))
+    {
+        while (s->seg != NULL)
+        {
+            StackSegment *prev = s->seg->prev;
+            cadt_free(&s->allocator, s->seg, segment_bytes(s));
+            s->seg = prev;
+        }
+        cadt_free(&s->allocator, s->spare, segment_bytes(s));
+        cadt_free(&s->allocator, s, sizeof (struct stack_type));
+        return;
+    }
+    cadt_free(&s->allocator, s->contents, s->curr_max_size * sizeof(Element));
+    cadt_free(&s->allocator, s, sizeof (struct stack_type));
     return;
 }
 
@@ -109,15 +368,75 @@ size_t cadtstack_nelems(StackADT *s)
     return s->top;
 }
 
+/*
+ * Set how `s` grows and shrinks
+ */
+StackADT *cadtstack_set_policy(StackADT *s, const ResizePolicy *policy)
+{
+    static const ResizePolicy default_policy = CADT_RESIZE_POLICY_DEFAULT;
+
+    if (policy == NULL)
+    {
+        policy = &default_policy;
+    }
+    if (!cadt_policy_is_valid(policy))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    s->policy = *policy;
+    s->shrink_at = shrink_threshold(s, s->curr_max_size);
+
+    return s;
+}
+
+/*
+ * Release the room `s` does not use
+ */
+StackADT *cadtstack_trim(StackADT *s)
+{
+    size_t new_size = (s->top > floor_size(s)) ? s->top : floor_size(s);
+
+    /* segments are never resized, only the spare one is unused */
+    if (is_seg(s))
+    {
+        cadt_free(&s->allocator, s->spare, segment_bytes(s));
+        s->spare = NULL;
+        return s;
+    }
+
+    if (!is_fix(s) && new_size < s->curr_max_size)
+    {
+        if (resize_contents_to(s, new_size) == NULL)
+        {
+            return NULL;
+        }
+    }
+    return s;
+}
+
 /* 
  * Make `s` empty 
  */
 StackADT *cadtstack_clear(StackADT *s)
 {
+    /* keep the bottom segment, and one more as the spare */
+    if (is_seg(s))
+    {
+        while (s->seg->prev != NULL)
+        {
+            pop_segment(s);
+        }
+        s->top = 0;
+        return s;
+    }
+
     /* s has grown, make a new stack for resizing*/
-    if (s->curr_max_size > s->min_size) 
+    if (!is_fix(s) && !s->policy.lazy && s->curr_max_size > floor_size(s))
     {                                    
-        Element *new = malloc(s->min_size * sizeof(Element));
+        Element *new = cadt_alloc(&s->allocator,
+                                  floor_size(s) * sizeof(Element));
 
         if (new == NULL)
         {
@@ -125,9 +444,12 @@ StackADT *cadtstack_clear(StackADT *s)
             return NULL;
         }
 
-        free(s->contents);
+        cadt_free(&s->allocator, s->contents,
+                  s->curr_max_size * sizeof(Element));
         s->contents = new;
-        s->curr_max_size = s->min_size;
+        s->curr_max_size = floor_size(s);
+        CADT_STATS_ONLY(s->stats.nshrinks++);
+        s->shrink_at = shrink_threshold(s, s->curr_max_size);
         s->top = 0;
         return s;
     }
@@ -150,20 +472,25 @@ Element cadtstack_push(StackADT *s, Element e)
         errno = EPERM;
         return NULL; 
     }
+    /* handle full segmented stack */
+    else if (is_seg(s) && is_full(s))
+    {
+        if (push_segment(s) == NULL)
+        {
+            return NULL;
+        }
+    }
     /* handle full variable-size stack */
     else if (!is_fix(s) && is_full(s))
     {
-        Element *p = 
-            realloc(s->contents, (s->curr_max_size *= 2) * sizeof(Element));
-        if (p == NULL)
+        if (resize_contents_to(s, grown_size(s)) == NULL)
         {
-            perror("push_ezstack (Realloc)");
             return NULL;
         }
-        s->contents = p;
     }
 
-    s->contents[s->top++] = e;
+    s->contents[s->top++ - s->base] = e;
+    CADT_STATS_ONLY(count_push(s));
     return e;
 }
 
@@ -172,8 +499,6 @@ Element cadtstack_push(StackADT *s, Element e)
  */
 Element cadtstack_pop(StackADT *s)
 {
-    double usage = (double) s->top / (double) s->curr_max_size;
-
     /* handle stack underflow */
     if (s->top == 0)
     {
@@ -181,17 +506,34 @@ Element cadtstack_pop(StackADT *s)
         return NULL;
     }
 
-    /* handle shrinking case */
-    if (!is_fix(s) && usage < 0.25)
+    /* handle empty top segment, left one pop late to spare a push the work */
+    if (is_seg(s))
     {
-        Element *p = 
-            realloc(s->contents, (s->curr_max_size /= 2) * sizeof(Element));
-        if (p == NULL)
+        if (s->top == s->base)
         {
-            perror("push_ezstack (Realloc)");
-            return s->contents[--s->top];
+            pop_segment(s);
         }
-        s->contents = p;
     }
-    return s->contents[--s->top];
+    /* handle shrinking case, on failure `s` keeps its size */
+    else if (!is_fix(s) && s->top < s->shrink_at 
+             && shrunk_size(s) < s->curr_max_size)
+    {
+        resize_contents_to(s, shrunk_size(s));
+    }
+    return s->contents[--s->top - s->base];
+}
+
+#if defined(CADT_STATS)
+/*
+ * Return the statistics of `s`
+ */
+ContainerStats cadtstack_stats(StackADT *s)
+{
+    ContainerStats stats = s->stats;
+
+    stats.nelems = s->top;
+    stats.capacity = s->curr_max_size;
+
+    return stats;
 }
+#endif
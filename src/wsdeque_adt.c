@@ -0,0 +1,296 @@
+/* posix_memalign() for pure c99 compilers */
+#if !defined(_POSIX_C_SOURCE) || _POSIX_C_SOURCE < 200112L
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "wsdeque_adt.h"
+
+#include <stdint.h>
+
+/* Indexes are padded to a whole line so the owner and thieves never share one */
+#define CACHE_LINE_SIZE 64
+
+/*********************************************************** Data Definitions */
+
+/*
+ * A `WSArray` is:
+ * + The number of slots, a power of two.
+ * + The array `d` used before this one, kept until `d` is destroyed since a
+ *   thief may still be reading from it.  `NULL` for the first array.
+ * + The slots, indexed by positions masked with `size - 1`.
+ */
+typedef struct ws_array
+{
+    size_t size;
+    struct ws_array *prev;
+    Element slots[];
+} WSArray;
+
+/*
+ * # Datatype completion
+ *
+ * A `WSDequeADT` object is:
+ *  + The current array.  Replaced by the owner when it grows, read by thieves.
+ *  + The position of the oldest item, ever increasing.  Claimed by thieves,
+ *    and by the owner for the last item, with a compare-and-swap.
+ *  + The position one past the newest item.  Written by the owner only, read
+ *    by thieves.
+ *
+ * Positions are signed: a pop first moves `bottom` down, then backs off if
+ * that left it below `top`.  The items are those in `[top, bottom)`.
+ */
+struct ws_deque_type
+{
+    WSArray *array;
+    char pad0[CACHE_LINE_SIZE - sizeof(WSArray *)];
+
+    int64_t top;
+    char pad1[CACHE_LINE_SIZE - sizeof(int64_t)];
+
+    int64_t bottom;
+    char pad2[CACHE_LINE_SIZE - sizeof(int64_t)];
+};
+
+/********************************************************** Private Functions */
+
+/*
+ * Returns the closest power of two greater than or equal to `n`, or zero if
+ * there is none.
+ */
+static inline size_t get_next_pow2(size_t n)
+{
+    size_t pow2 = 1;
+
+    if (n > SIZE_MAX / 2 + 1)
+    {
+        return 0;
+    }
+    while (pow2 < n)
+    {
+        pow2 *= 2;
+    }
+    return pow2;
+}
+
+/*
+ * Allocates an array of `size` slots, returns `NULL` on failure.
+ */
+static WSArray *array_new(size_t size)
+{
+    WSArray *a;
+
+    if (size > (SIZE_MAX - sizeof(WSArray)) / sizeof(Element))
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    a = malloc(sizeof(WSArray) + size * sizeof(Element));
+    if (a == NULL)
+    {
+        perror("array_new malloc failed allocating WSArray");
+        return NULL;
+    }
+    a->size = size;
+    a->prev = NULL;
+
+    return a;
+}
+
+/*
+ * Returns the slot of `a` at position `i`.
+ */
+static inline Element *slot(WSArray *a, int64_t i)
+{
+    return &a->slots[(size_t) i & (a->size - 1)];
+}
+
+/*
+ * Doubles the array of `d`, copying the items in `[top, bottom)`.  Owner side,
+ * the old array is chained to the new one for thieves still reading it.
+ */
+static WSArray *grow(WSDequeADT *d, WSArray *a, int64_t top, int64_t bottom)
+{
+    WSArray *new;
+    int64_t i;
+
+    if (a->size > SIZE_MAX / 2 || (new = array_new(a->size * 2)) == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    for (i = top; i < bottom; i++)
+    {
+        *slot(new, i) = __atomic_load_n(slot(a, i), __ATOMIC_RELAXED);
+    }
+    new->prev = a;
+    /* publish the copied items along with the new array */
+    __atomic_store_n(&d->array, new, __ATOMIC_RELEASE);
+
+    return new;
+}
+
+/***************************************************** Public Implementations */
+
+/*
+ * Create work-stealing deque
+ */
+WSDequeADT *cadtwsdeque_new(size_t size)
+{
+    WSDequeADT *new;
+    void *mem;
+    size_t pow2 = get_next_pow2(size);
+
+    if (size == 0 || pow2 == 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (posix_memalign(&mem, CACHE_LINE_SIZE, sizeof(struct ws_deque_type)) != 0)
+    {
+        perror("cadtwsdeque_new posix_memalign failed allocating struct ws_deque_type");
+        errno = ENOMEM;
+        return NULL;
+    }
+    new = mem;
+
+    new->array = array_new(pow2);
+    if (new->array == NULL)
+    {
+        free(new);
+        return NULL;
+    }
+    new->top = 0;
+    new->bottom = 0;
+
+    return new;
+}
+
+/*
+ * Destroy deque, and every array it outgrew
+ */
+void cadtwsdeque_destroy(WSDequeADT *d)
+{
+    WSArray *a = d->array;
+
+    while (a != NULL)
+    {
+        WSArray *prev = a->prev;
+        free(a);
+        a = prev;
+    }
+    free(d);
+    return;
+}
+
+/*
+ * Return the number of elements `d` currently holds
+ */
+size_t cadtwsdeque_nelems(WSDequeADT *d)
+{
+    int64_t top = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    int64_t bottom = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+
+    /* a pop in progress may have moved `bottom` below `top` */
+    return (bottom > top) ? (size_t) (bottom - top) : 0;
+}
+
+/*
+ * Push element onto the bottom of `d`, owner side
+ */
+Element cadtwsdeque_push(WSDequeADT *d, Element e)
+{
+    int64_t bottom = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+    int64_t top = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    WSArray *a = __atomic_load_n(&d->array, __ATOMIC_RELAXED);
+
+    /* handle full deque */
+    if ((size_t) (bottom - top) == a->size)
+    {
+        if ((a = grow(d, a, top, bottom)) == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    __atomic_store_n(slot(a, bottom), e, __ATOMIC_RELAXED);
+    /* publish the element along with the new bottom */
+    __atomic_store_n(&d->bottom, bottom + 1, __ATOMIC_RELEASE);
+
+    return e;
+}
+
+/*
+ * Pop element at the bottom of `d`, owner side
+ */
+Element cadtwsdeque_pop(WSDequeADT *d)
+{
+    int64_t bottom = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+    WSArray *a = __atomic_load_n(&d->array, __ATOMIC_RELAXED);
+    int64_t top;
+    Element ret;
+
+    /* claim the bottom item before looking at `top`, thieves do the reverse */
+    __atomic_store_n(&d->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    top = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+
+    /* handle deque underflow */
+    if (top > bottom)
+    {
+        __atomic_store_n(&d->bottom, bottom + 1, __ATOMIC_RELAXED);
+        errno = EPERM;
+        return NULL;
+    }
+
+    ret = __atomic_load_n(slot(a, bottom), __ATOMIC_RELAXED);
+    if (top < bottom)
+    {
+        return ret;
+    }
+
+    /* last item, race thieves for it */
+    if (!__atomic_compare_exchange_n(&d->top, &top, top + 1, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+    {
+        ret = NULL;
+        errno = EPERM;
+    }
+    __atomic_store_n(&d->bottom, bottom + 1, __ATOMIC_RELAXED);
+
+    return ret;
+}
+
+/*
+ * Steal element at the top of `d`, thief side
+ */
+Element cadtwsdeque_steal(WSDequeADT *d)
+{
+    int64_t top = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    int64_t bottom;
+    WSArray *a;
+    Element ret;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    bottom = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+
+    /* handle deque underflow */
+    if (top >= bottom)
+    {
+        errno = EPERM;
+        return NULL;
+    }
+
+    a = __atomic_load_n(&d->array, __ATOMIC_ACQUIRE);
+    ret = __atomic_load_n(slot(a, top), __ATOMIC_RELAXED);
+    /* lost the item to the owner or another thief */
+    if (!__atomic_compare_exchange_n(&d->top, &top, top + 1, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+    {
+        errno = EAGAIN;
+        return NULL;
+    }
+
+    return ret;
+}
@@ -0,0 +1,219 @@
+#include "minunit.h"
+#include "../src/concurrenthashtable_adt.c"
+
+#define NTHREADS 4
+#define NKEYS_PER_THREAD 2000
+
+/* A structure to manipulate its members directly */
+static ConcurrentHashTableADT *mock_hash_table;
+
+/*
+ * FNV-1a, safe to call from several threads.
+ */
+static HashFunction fnv_hash;
+
+/*
+ * Inserts, looks up and deletes keys of its own, checking the keys of the
+ * other threads stay reachable.
+ */
+static void *worker(void *arg);
+
+void test_setup(void)
+{
+    if ((mock_hash_table = cadtconcurrenthashtable_new(1, fnv_hash)) == NULL)
+    {
+        fprintf(stderr, "test_setup cadtconcurrenthashtable_new");
+        exit(EXIT_FAILURE);
+    }
+    return;
+}
+
+void test_teardown(void)
+{
+    cadtconcurrenthashtable_destroy(mock_hash_table);
+    return;
+}
+
+/*
+ * Test object creation and corner cases.
+ */
+MU_TEST(test_cadtconcurrenthashtable_new)
+{
+    ConcurrentHashTableADT *ht;
+
+    errno = 0;
+    mu_check(cadtconcurrenthashtable_new(0, fnv_hash) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtconcurrenthashtable_new(8, NULL) == NULL);
+    mu_check(errno == EINVAL);
+
+    mu_check(mock_hash_table->nbuckets == NSTRIPES);
+    mu_check(sizeof(Stripe) % CACHE_LINE_SIZE == 0);
+    mu_check((size_t) mock_hash_table->stripes % CACHE_LINE_SIZE == 0);
+
+    mu_check((ht = cadtconcurrenthashtable_new(1000, fnv_hash)) != NULL);
+    mu_check(ht->nbuckets == 1024);
+    mu_check(cadtconcurrenthashtable_nelems(ht) == 0);
+    cadtconcurrenthashtable_destroy(ht);
+}
+
+/*
+ * Test single-threaded insertion, lookup and deletion.
+ */
+MU_TEST(test_operations)
+{
+    const char *long_key = "a key longer than sixteen bytes";
+
+    /* Sanity checks */
+    errno = 0;
+    mu_check(cadtconcurrenthashtable_insert(NULL, "key", 1, "obj") == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtconcurrenthashtable_insert(mock_hash_table, "key", 0, "obj") == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtconcurrenthashtable_lookup(mock_hash_table, NULL, 1) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtconcurrenthashtable_delete(mock_hash_table, "key", 1, NULL) == NULL);
+    mu_check(errno == EINVAL);
+
+    mu_check(cadtconcurrenthashtable_insert(mock_hash_table, "Hello", sizeof("Hello"), "Hello") != NULL);
+    mu_check(cadtconcurrenthashtable_insert(mock_hash_table, long_key, strlen(long_key), "long") != NULL);
+    errno = 0;
+    mu_check(cadtconcurrenthashtable_insert(mock_hash_table, "Hello", sizeof("Hello"), "Hello") == NULL);
+    mu_check(errno == EEXIST);
+    mu_check(cadtconcurrenthashtable_nelems(mock_hash_table) == 2);
+
+    mu_assert_string_eq(cadtconcurrenthashtable_lookup(mock_hash_table, "Hello", sizeof("Hello")), "Hello");
+    mu_assert_string_eq(cadtconcurrenthashtable_lookup(mock_hash_table, long_key, strlen(long_key)), "long");
+    mu_check(cadtconcurrenthashtable_lookup(mock_hash_table, "Hope", sizeof("Hope")) == NULL);
+
+    mu_check(cadtconcurrenthashtable_delete(mock_hash_table, long_key, strlen(long_key), "long") != NULL);
+    mu_check(cadtconcurrenthashtable_delete(mock_hash_table, long_key, strlen(long_key), "long") == NULL);
+    mu_check(cadtconcurrenthashtable_lookup(mock_hash_table, long_key, strlen(long_key)) == NULL);
+    mu_check(cadtconcurrenthashtable_nelems(mock_hash_table) == 1);
+
+    /* The removed entry's item is returned, not `e` */
+    mu_assert_string_eq(cadtconcurrenthashtable_delete(mock_hash_table, "Hello", sizeof("Hello"), "other"), "Hello");
+    mu_check(cadtconcurrenthashtable_nelems(mock_hash_table) == 0);
+}
+
+/*
+ * Test growth keeps every key reachable and the load of every stripe bounded.
+ */
+MU_TEST(test_grow)
+{
+    static char keys[5000][8];
+    size_t i;
+
+    for (i = 0; i < 5000; i++)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "k%zu", i);
+        mu_check(cadtconcurrenthashtable_insert(mock_hash_table, keys[i],
+                                                sizeof(keys[i]), keys[i]) != NULL);
+    }
+    mu_check(mock_hash_table->nbuckets >= 5000 / 2);
+    for (i = 0; i < NSTRIPES; i++)
+    {
+        mu_check(mock_hash_table->stripes[i].s.nelems
+                 <= mock_hash_table->nbuckets / NSTRIPES);
+    }
+    for (i = 0; i < 5000; i++)
+    {
+        mu_check(cadtconcurrenthashtable_lookup(mock_hash_table, keys[i],
+                                                sizeof(keys[i])) == keys[i]);
+    }
+}
+
+/*
+ * Test concurrent operations on disjoint keys, growing the table meanwhile.
+ */
+MU_TEST(test_threads)
+{
+    pthread_t threads[NTHREADS];
+    size_t ids[NTHREADS];
+    size_t i;
+    void *failures;
+    size_t nfailures = 0;
+
+    for (i = 0; i < NTHREADS; i++)
+    {
+        ids[i] = i;
+        mu_check(pthread_create(&threads[i], NULL, worker, &ids[i]) == 0);
+    }
+    for (i = 0; i < NTHREADS; i++)
+    {
+        mu_check(pthread_join(threads[i], &failures) == 0);
+        nfailures += (size_t) failures;
+    }
+
+    mu_check(nfailures == 0);
+    mu_check(cadtconcurrenthashtable_nelems(mock_hash_table)
+             == NTHREADS * NKEYS_PER_THREAD / 2);
+}
+
+MU_TEST_SUITE(test_suite)
+{
+	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+	MU_RUN_TEST(test_cadtconcurrenthashtable_new);
+	MU_RUN_TEST(test_operations);
+	MU_RUN_TEST(test_grow);
+	MU_RUN_TEST(test_threads);
+}
+
+int main(int argc, char *argv[])
+{
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+
+	return MU_EXIT_CODE;
+}
+
+static size_t fnv_hash(const void* key, size_t key_len)
+{
+    const unsigned char *p = key;
+    size_t hash = 2166136261u;
+
+    while (key_len-- > 0)
+    {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+static void *worker(void *arg)
+{
+    static size_t keys[NTHREADS][NKEYS_PER_THREAD];
+    size_t id = *(size_t *) arg;
+    size_t i, nfailures = 0;
+
+    for (i = 0; i < NKEYS_PER_THREAD; i++)
+    {
+        keys[id][i] = id * NKEYS_PER_THREAD + i;
+        if (cadtconcurrenthashtable_insert(mock_hash_table, &keys[id][i],
+                                           sizeof(size_t), &keys[id][i]) == NULL)
+        {
+            nfailures++;
+        }
+    }
+    for (i = 0; i < NKEYS_PER_THREAD; i++)
+    {
+        if (cadtconcurrenthashtable_lookup(mock_hash_table, &keys[id][i],
+                                           sizeof(size_t)) != &keys[id][i])
+        {
+            nfailures++;
+        }
+    }
+    for (i = 0; i < NKEYS_PER_THREAD; i += 2)
+    {
+        if (cadtconcurrenthashtable_delete(mock_hash_table, &keys[id][i],
+                                           sizeof(size_t), &keys[id][i]) == NULL)
+        {
+            nfailures++;
+        }
+    }
+
+    return (void *) nfailures;
+}
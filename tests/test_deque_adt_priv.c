@@ -0,0 +1,217 @@
+#include "minunit.h"
+#include "../src/deque_adt.c"
+
+static DequeADT *fix, *dyn;
+static char* elements[6] = { "Lorem", "ipsum", "dolor", "sit", "amet",
+                              "consectetur", };
+
+void test_setup(void)
+{
+    fix = cadtdeque_new_circular(3);
+    dyn = cadtdeque_new(2);
+    return;
+}
+
+void test_teardown(void)
+{
+    cadtdeque_destroy(fix);
+    cadtdeque_destroy(dyn);
+    return;
+}
+
+/*
+ * Testing `deque_type` creation goes smoothly, and some corner cases.
+ */
+MU_TEST(test_deque_type)
+{
+    errno = 0;
+    mu_assert(cadtdeque_new(0) == NULL,
+            "Zero size deques should not be allowed");
+    mu_check(errno == EINVAL);
+
+    errno = 0;
+    mu_assert(cadtdeque_new_circular(0) == NULL,
+            "Zero size deques should not be allowed");
+    mu_check(errno == EINVAL);
+
+    mu_check(fix->min_size == 3);
+    mu_check(fix->curr_max_size == 3);
+    mu_check(fix->head == 0);
+    mu_check(fix->nelems == 0);
+    mu_check(fix->is_fix == 1);
+    mu_check(dyn->is_fix == 0);
+    /* Created at its floor, pops never shrink it */
+    mu_check(dyn->shrink_at == 0);
+}
+
+/*
+ * Testing both ends of a circular deque, overflow and underflow.
+ */
+MU_TEST(test_both_ends)
+{
+    errno = 0;
+    mu_check(cadtdeque_pop_front(fix) == NULL);
+    mu_check(errno == EPERM);
+    errno = 0;
+    mu_check(cadtdeque_pop_rear(fix) == NULL);
+    mu_check(errno == EPERM);
+    errno = 0;
+    mu_check(cadtdeque_peek_rear(fix) == NULL);
+    mu_check(errno == EPERM);
+
+    /* The front wraps around to the end of the array */
+    mu_assert_string_eq("ipsum", cadtdeque_push_rear(fix, elements[1]));
+    mu_assert_string_eq("Lorem", cadtdeque_push_front(fix, elements[0]));
+    mu_check(fix->head == 2);
+    mu_assert_string_eq("dolor", cadtdeque_push_rear(fix, elements[2]));
+    mu_check(cadtdeque_nelems(fix) == 3);
+
+    errno = 0;
+    mu_check(cadtdeque_push_front(fix, elements[3]) == NULL);
+    mu_check(errno == EPERM);
+    errno = 0;
+    mu_check(cadtdeque_push_rear(fix, elements[3]) == NULL);
+    mu_check(errno == EPERM);
+
+    mu_assert_string_eq("Lorem", cadtdeque_peek_front(fix));
+    mu_assert_string_eq("dolor", cadtdeque_peek_rear(fix));
+    mu_assert_string_eq("dolor", cadtdeque_pop_rear(fix));
+    mu_assert_string_eq("Lorem", cadtdeque_pop_front(fix));
+    mu_assert_string_eq("ipsum", cadtdeque_pop_rear(fix));
+    mu_check(cadtdeque_nelems(fix) == 0);
+
+    mu_assert_string_eq("sit", cadtdeque_push_front(fix, elements[3]));
+    mu_check(cadtdeque_clear(fix) == fix);
+    mu_check(cadtdeque_nelems(fix) == 0);
+    mu_check(fix->head == 0);
+}
+
+/*
+ * Testing indexed access across the wrap-around point.
+ */
+MU_TEST(test_at)
+{
+    size_t i;
+
+    errno = 0;
+    mu_check(cadtdeque_at(fix, 0) == NULL);
+    mu_check(errno == EINVAL);
+
+    cadtdeque_push_rear(fix, elements[1]);
+    cadtdeque_push_rear(fix, elements[2]);
+    cadtdeque_push_front(fix, elements[0]);
+    for (i = 0; i < 3; i++)
+    {
+        mu_assert_string_eq(elements[i], cadtdeque_at(fix, i));
+    }
+    errno = 0;
+    mu_check(cadtdeque_at(fix, 3) == NULL);
+    mu_check(errno == EINVAL);
+}
+
+/*
+ * Testing a dynamic deque unwraps its items when it grows and shrinks.
+ */
+MU_TEST(test_resize)
+{
+    size_t i;
+
+    /* Pushed at the front, the items wrap before the array grows */
+    for (i = 0; i < 6; i++)
+    {
+        mu_assert_string_eq(elements[5 - i],
+                            cadtdeque_push_front(dyn, elements[5 - i]));
+    }
+    mu_check(dyn->curr_max_size == 8);
+    mu_check(cadtdeque_nelems(dyn) == 6);
+    for (i = 0; i < 6; i++)
+    {
+        mu_assert_string_eq(elements[i], cadtdeque_at(dyn, i));
+    }
+
+    /* Usage under 25% before popping, halves to 4 */
+    mu_assert_string_eq("consectetur", cadtdeque_pop_rear(dyn));
+    mu_assert_string_eq("Lorem", cadtdeque_pop_front(dyn));
+    mu_assert_string_eq("amet", cadtdeque_pop_rear(dyn));
+    mu_assert_string_eq("ipsum", cadtdeque_pop_front(dyn));
+    mu_assert_string_eq("sit", cadtdeque_pop_rear(dyn));
+    mu_check(dyn->curr_max_size == 8);
+    mu_assert_string_eq("dolor", cadtdeque_peek_front(dyn));
+    mu_assert_string_eq("dolor", cadtdeque_peek_rear(dyn));
+    mu_assert_string_eq("dolor", cadtdeque_pop_front(dyn));
+    mu_check(dyn->curr_max_size == 4);
+    mu_check(cadtdeque_nelems(dyn) == 0);
+
+    /* Cleared back to the size it was created with */
+    for (i = 0; i < 8; i++)
+    {
+        cadtdeque_push_rear(dyn, elements[i % 6]);
+    }
+    mu_check(dyn->curr_max_size == 8);
+    mu_check(cadtdeque_clear(dyn) == dyn);
+    mu_check(dyn->curr_max_size == 2);
+    mu_check(dyn->shrink_at == 0);
+}
+
+/*
+ * Testing a lazy policy, usage oscillating at one end keeps the size, and
+ * trimming.
+ */
+MU_TEST(test_policy)
+{
+    ResizePolicy bad = { 2.0, 0.5, 0, 0 };
+    ResizePolicy lazy = { 2.0, 0.25, 0, 1 };
+    size_t i;
+
+    errno = 0;
+    mu_check(cadtdeque_set_policy(dyn, &bad) == NULL);
+    mu_check(errno == EINVAL);
+
+    mu_check(cadtdeque_set_policy(dyn, &lazy) == dyn);
+    for (i = 0; i < 16; i++)
+    {
+        cadtdeque_push_front(dyn, elements[i % 6]);
+    }
+    mu_check(dyn->curr_max_size == 16);
+    while (cadtdeque_nelems(dyn) > 1)
+    {
+        cadtdeque_pop_rear(dyn);
+    }
+    for (i = 0; i < 100; i++)
+    {
+        cadtdeque_push_rear(dyn, elements[0]);
+        cadtdeque_pop_front(dyn);
+        mu_check(dyn->curr_max_size == 16);
+    }
+    mu_check(cadtdeque_trim(dyn) == dyn);
+    mu_check(dyn->curr_max_size == 2);
+    mu_check(cadtdeque_nelems(dyn) == 1);
+    mu_assert_string_eq("Lorem", cadtdeque_peek_front(dyn));
+
+    /* A circular deque keeps its size on clear, whatever the floor */
+    lazy.min_size = 1;
+    lazy.lazy = 0;
+    mu_check(cadtdeque_set_policy(fix, &lazy) == fix);
+    cadtdeque_push_rear(fix, elements[0]);
+    mu_check(cadtdeque_clear(fix) == fix);
+    mu_check(fix->curr_max_size == 3);
+    mu_check(cadtdeque_nelems(fix) == 0);
+}
+
+MU_TEST_SUITE(test_suite)
+{
+	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+	MU_RUN_TEST(test_deque_type);
+	MU_RUN_TEST(test_both_ends);
+	MU_RUN_TEST(test_at);
+	MU_RUN_TEST(test_resize);
+	MU_RUN_TEST(test_policy);
+}
+
+int main(int argc, char *argv[])
+{
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+
+	return MU_EXIT_CODE;
+}
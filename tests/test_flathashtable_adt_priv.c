@@ -0,0 +1,243 @@
+#include "minunit.h"
+#include "../src/flathashtable_adt.c"
+
+static FlatHashTableADT *ht;
+
+/*
+ * Hashes a null-terminated string.
+ * Returns (size_t) key[0] + strlen(string)
+ */
+static HashFunction dummy_hash;
+
+void test_setup(void)
+{
+    if ((ht = cadtflathashtable_new(1, dummy_hash)) == NULL)
+    {
+        fprintf(stderr, "test_setup cadtflathashtable_new failed");
+        exit(EXIT_FAILURE);
+    }
+    return;
+}
+
+void test_teardown(void)
+{
+    cadtflathashtable_destroy(ht);
+    return;
+}
+
+/*
+ * Test object creation and corner cases.
+ */
+MU_TEST(test_cadtflathashtable_new)
+{
+    FlatHashTableADT *big;
+
+    errno = 0;
+    mu_check(cadtflathashtable_new(0, dummy_hash) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtflathashtable_new(16, NULL) == NULL);
+    mu_check(errno == EINVAL);
+
+    mu_check(ht->capacity == GROUP_WIDTH);
+    mu_check(ht->nelems == 0);
+    mu_check(ht->ndeleted == 0);
+    mu_check(ht->hash == dummy_hash);
+    mu_check(group_match(ht->ctrl, CTRL_EMPTY) == 0xFFFF);
+
+    mu_check((big = cadtflathashtable_new(1000, dummy_hash)) != NULL);
+    mu_check(big->capacity == 1024);
+    cadtflathashtable_destroy(big);
+}
+
+/*
+ * Test group probing against the scalar fallback.
+ */
+MU_TEST(test_group_match)
+{
+    unsigned char ctrl[GROUP_WIDTH];
+
+    memset(ctrl, CTRL_EMPTY, sizeof(ctrl));
+    ctrl[0] = 0x05;
+    ctrl[3] = CTRL_DELETED;
+    ctrl[7] = 0x05;
+    ctrl[15] = 0x7F;
+
+    mu_check(group_match(ctrl, 0x05) == ((1u << 0) | (1u << 7)));
+    mu_check(group_match(ctrl, 0x7F) == (1u << 15));
+    mu_check(group_match(ctrl, 0x06) == 0);
+    mu_check(group_match(ctrl, 0x05) == group_match_scalar(ctrl, 0x05));
+    mu_check(group_match(ctrl, CTRL_EMPTY)
+            == group_match_scalar(ctrl, CTRL_EMPTY));
+    /* Every slot but the full ones is free */
+    mu_check(group_match_free(ctrl)
+            == (0xFFFFu & ~((1u << 0) | (1u << 7) | (1u << 15))));
+    mu_check(lowest_bit(1u << 9) == 9);
+}
+
+/*
+ * Test insertion, "Hope" and "Hogs" collide thus share the same probe
+ * sequence and tag.
+ */
+MU_TEST(test_cadtflathashtable_insert)
+{
+    size_t hash = cadt_hash_mix(dummy_hash("Hope", sizeof("Hope")));
+    size_t group = hash_group(ht, hash);
+    unsigned int match;
+
+    /* Sanity checks */
+    errno = 0;
+    mu_check(cadtflathashtable_insert(NULL, "key", 1, "obj") == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtflathashtable_insert(ht, NULL, 1, "obj") == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtflathashtable_insert(ht, "key", 0, "obj") == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtflathashtable_insert(ht, "key", 1, NULL) == NULL);
+    mu_check(errno == EINVAL);
+
+    mu_check(cadtflathashtable_insert(ht, "Hello", sizeof("Hello"), "Hello") != NULL);
+    mu_check(cadtflathashtable_insert(ht, "Hope", sizeof("Hope"), "Hope") != NULL);
+    mu_check(cadtflathashtable_insert(ht, "Hogs", sizeof("Hogs"), "Hogs") != NULL);
+    mu_check(ht->nelems == 3);
+
+    /* Both colliding keys are tagged alike in the same group */
+    match = group_match(&ht->ctrl[group * GROUP_WIDTH], hash_tag(hash));
+    mu_check(match != 0 && (match & (match - 1)) != 0);
+
+    /* Check re-insertion of element */
+    errno = 0;
+    mu_check(cadtflathashtable_insert(ht, "Hello", sizeof("Hello"), "Hello") == NULL);
+    mu_check(errno == EEXIST);
+    mu_check(ht->nelems == 3);
+}
+
+/*
+ * Testing lookup function, with a key too long to be stored inline.
+ */
+MU_TEST(test_cadtflathashtable_lookup)
+{
+    static const char longkey[] = "http://example.com/a/rather/long/key";
+
+    mu_check(cadtflathashtable_insert(ht, "Hope", sizeof("Hope"), "Hope") != NULL);
+    mu_check(cadtflathashtable_insert(ht, "Hogs", sizeof("Hogs"), "Hogs") != NULL);
+    mu_check(cadtflathashtable_insert(ht, longkey, sizeof(longkey), "long") != NULL);
+
+    /* Sanity checks */
+    errno = 0;
+    mu_check(cadtflathashtable_lookup(NULL, "key", 1) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtflathashtable_lookup(ht, NULL, 1) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtflathashtable_lookup(ht, "key", 0) == NULL);
+    mu_check(errno == EINVAL);
+
+    mu_assert_string_eq("Hope", cadtflathashtable_lookup(ht, "Hope", sizeof("Hope")));
+    mu_assert_string_eq("Hogs", cadtflathashtable_lookup(ht, "Hogs", sizeof("Hogs")));
+    mu_assert_string_eq("long", cadtflathashtable_lookup(ht, longkey, sizeof(longkey)));
+    mu_check(cadtflathashtable_lookup(ht, "Holy", sizeof("Holy")) == NULL);
+    mu_check(cadtflathashtable_lookup(ht, "Hope", sizeof("Hop")) == NULL);
+}
+
+/*
+ * Testing deletion function, a deleted slot in a group with empty slots is
+ * emptied rather than marked.
+ */
+MU_TEST(test_cadtflathashtable_delete)
+{
+    static const char longkey[] = "http://example.com/a/rather/long/key";
+
+    mu_check(cadtflathashtable_insert(ht, "Hope", sizeof("Hope"), "Hope") != NULL);
+    mu_check(cadtflathashtable_insert(ht, "Hogs", sizeof("Hogs"), "Hogs") != NULL);
+    mu_check(cadtflathashtable_insert(ht, longkey, sizeof(longkey), "long") != NULL);
+
+    /* Sanity checks */
+    errno = 0;
+    mu_check(cadtflathashtable_delete(NULL, "key", 1, "elm") == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtflathashtable_delete(ht, "key", 1, NULL) == NULL);
+    mu_check(errno == EINVAL);
+
+    mu_check(cadtflathashtable_delete(ht, "Holy", sizeof("Holy"), "Holy") == NULL);
+    mu_assert_string_eq("Hope", cadtflathashtable_delete(ht, "Hope", sizeof("Hope"), "Hope"));
+    mu_assert_string_eq("long", cadtflathashtable_delete(ht, longkey, sizeof(longkey), "long"));
+    mu_check(ht->nelems == 1);
+    mu_check(ht->ndeleted == 0);
+
+    mu_check(cadtflathashtable_lookup(ht, "Hope", sizeof("Hope")) == NULL);
+    mu_assert_string_eq("Hogs", cadtflathashtable_lookup(ht, "Hogs", sizeof("Hogs")));
+}
+
+/*
+ * Test growth and deletion markers, with every key colliding on its hash so
+ * probe sequences run across several full groups.
+ */
+MU_TEST(test_growth_and_tombstones)
+{
+    char keys[200][8];
+    size_t i;
+
+    for (i = 0; i < 200; i++)
+    {
+        /* Same first letter and length, same hash */
+        snprintf(keys[i], sizeof(keys[i]), "a%06zu", i);
+        mu_check(cadtflathashtable_insert(ht, keys[i], sizeof(keys[i]), keys[i]) != NULL);
+    }
+    mu_check(ht->nelems == 200);
+    mu_check(ht->capacity == 256);
+
+    /* Deleting from full groups leaves markers, probes still get through */
+    for (i = 0; i < 100; i++)
+    {
+        mu_check(cadtflathashtable_delete(ht, keys[i], sizeof(keys[i]), keys[i]) == keys[i]);
+    }
+    mu_check(ht->ndeleted > 0);
+    for (i = 0; i < 200; i++)
+    {
+        Element expected = i < 100 ? NULL : keys[i];
+        mu_check(cadtflathashtable_lookup(ht, keys[i], sizeof(keys[i])) == expected);
+    }
+
+    /* Reinsertion reuses markers or drops them on rehash, but never grows */
+    for (i = 0; i < 100; i++)
+    {
+        mu_check(cadtflathashtable_insert(ht, keys[i], sizeof(keys[i]), keys[i]) != NULL);
+    }
+    mu_check(ht->nelems == 200);
+    mu_check(ht->capacity == 256);
+    for (i = 0; i < 200; i++)
+    {
+        mu_check(cadtflathashtable_lookup(ht, keys[i], sizeof(keys[i])) == keys[i]);
+    }
+}
+
+MU_TEST_SUITE(test_suite)
+{
+	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+	MU_RUN_TEST(test_cadtflathashtable_new);
+	MU_RUN_TEST(test_group_match);
+	MU_RUN_TEST(test_cadtflathashtable_insert);
+	MU_RUN_TEST(test_cadtflathashtable_lookup);
+	MU_RUN_TEST(test_cadtflathashtable_delete);
+	MU_RUN_TEST(test_growth_and_tombstones);
+}
+
+int main(int argc, char *argv[])
+{
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+
+	return MU_EXIT_CODE;
+}
+
+static size_t dummy_hash(const void* key, size_t key_len)
+{
+    const char *p = key;
+    return (size_t) p[0] + key_len - 1;
+}
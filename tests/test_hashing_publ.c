@@ -0,0 +1,127 @@
+#include "minunit.h"
+#include "../include/hashing.h"
+
+#define NBUCKETS 1024
+#define NKEYS (16 * NBUCKETS)
+
+/*
+ * Returns the size of the fullest of `NBUCKETS` buckets after hashing `NKEYS`
+ * consecutive integers of the given size with `fp`, using the low bits only.
+ */
+static size_t max_bucket_load(HashFunction *fp, size_t keysize)
+{
+    static size_t buckets[NBUCKETS];
+    size_t max = 0;
+    uint64_t k;
+
+    memset(buckets, 0, sizeof(buckets));
+    for (k = 0; k < NKEYS; k++)
+    {
+        uint32_t k32 = (uint32_t) k;
+        const void *key = keysize == sizeof(k32) ? (const void *) &k32 : &k;
+        size_t b = fp(key, keysize) & (NBUCKETS - 1);
+
+        if (++buckets[b] > max)
+        {
+            max = buckets[b];
+        }
+    }
+    return max;
+}
+
+/*
+ * Hashes are deterministic and depend on every byte and on the length.
+ */
+MU_TEST(test_cadthash_bytes)
+{
+    unsigned char buf[256];
+    size_t i, len;
+
+    for (i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (unsigned char) i;
+    }
+
+    mu_check(cadthash_bytes("Hello", 5) == cadthash_bytes("Hello", 5));
+    mu_check(cadthash_bytes("Hello", 5) != cadthash_bytes("Hello", 6));
+    mu_check(cadthash_bytes("Hello", 5) != cadthash_bytes("Hellp", 5));
+    mu_check(cadthash_bytes("Hello", 0) == cadthash_bytes("World", 0));
+
+    /* Every length goes through a different read pattern */
+    for (len = 1; len < sizeof(buf); len++)
+    {
+        size_t h = cadthash_bytes(buf, len);
+
+        mu_check(h != cadthash_bytes(buf, len - 1));
+        buf[len - 1] ^= 1;
+        mu_check(h != cadthash_bytes(buf, len));
+        buf[len - 1] ^= 1;
+        buf[0] ^= 0x80;
+        mu_check(h != cadthash_bytes(buf, len));
+        buf[0] ^= 0x80;
+    }
+}
+
+/*
+ * Integer keys hash through the fast path, other sizes fall back.
+ */
+MU_TEST(test_cadthash_int)
+{
+    uint64_t k64 = 42;
+    uint32_t k32 = 42;
+    char key[3] = "ab";
+
+    mu_check(cadthash_int(&k64, sizeof(k64)) == cadthash_int(&k64, sizeof(k64)));
+    mu_check(cadthash_int(&k32, sizeof(k32)) != 42);
+    mu_check(cadthash_int(&k64, sizeof(k64)) != cadthash_bytes(&k64, sizeof(k64)));
+    mu_check(cadthash_int(key, sizeof(key)) == cadthash_bytes(key, sizeof(key)));
+
+    k64++;
+    mu_check(cadthash_int(&k64, sizeof(k64)) != cadthash_int(&k32, sizeof(k32)));
+}
+
+/*
+ * The seeded variant depends on the seed.
+ */
+MU_TEST(test_cadthash_bytes_seeded)
+{
+    size_t h1, h2;
+
+    cadthash_set_seed(1);
+    h1 = cadthash_bytes_seeded("Hello", 5);
+    mu_check(h1 == cadthash_bytes_seeded("Hello", 5));
+
+    cadthash_set_seed(2);
+    h2 = cadthash_bytes_seeded("Hello", 5);
+    mu_check(h1 != h2);
+    mu_check(h2 != cadthash_bytes("Hello", 5));
+}
+
+/*
+ * Consecutive integers spread evenly over the low bits.  With 16 keys per
+ * bucket on average, a fair hash keeps every bucket well under 48.
+ */
+MU_TEST(test_distribution)
+{
+    mu_check(max_bucket_load(cadthash_bytes, sizeof(uint32_t)) < 48);
+    mu_check(max_bucket_load(cadthash_bytes, sizeof(uint64_t)) < 48);
+    mu_check(max_bucket_load(cadthash_int, sizeof(uint32_t)) < 48);
+    mu_check(max_bucket_load(cadthash_int, sizeof(uint64_t)) < 48);
+    mu_check(max_bucket_load(cadthash_bytes_seeded, sizeof(uint64_t)) < 48);
+}
+
+MU_TEST_SUITE(test_suite)
+{
+	MU_RUN_TEST(test_cadthash_bytes);
+	MU_RUN_TEST(test_cadthash_int);
+	MU_RUN_TEST(test_cadthash_bytes_seeded);
+	MU_RUN_TEST(test_distribution);
+}
+
+int main(int argc, char *argv[])
+{
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+
+	return MU_EXIT_CODE;
+}
@@ -1,3 +1,4 @@
+#define CADT_STATS
 #include "minunit.h"
 #include "../src/hashtable_adt.c"
 
@@ -10,6 +11,37 @@ static HashTableADT *mock_hash_table;
  */
 static HashFunction dummy_hash;
 
+/*
+ * FNV-1a, spreads keys well enough to exercise resizing.
+ */
+static HashFunction fnv_hash;
+
+/*
+ * `fnv_hash`, counting its calls in `nhashes`.
+ */
+static HashFunction counting_hash;
+static size_t nhashes;
+
+/*
+ * Counts its calls in the `size_t` pointed to by `ctx`, checking the table's
+ * key matches the element.
+ */
+static HashTableVisitor counting_visitor;
+
+/*
+ * Frees the element.
+ */
+static HashTableVisitor freeing_visitor;
+
+/*
+ * Allocation functions keeping track in the `size_t` pointed to by `ctx` of
+ * the bytes in use, from the sizes the table passes.
+ */
+static void *counting_alloc(void *ctx, size_t size);
+static void *counting_realloc(void *ctx, void *ptr, size_t old_size,
+                              size_t new_size);
+static void counting_free(void *ctx, void *ptr, size_t size);
+
 void test_setup(void)
 {   
     if ((mock_hash_table = malloc(sizeof(struct hash_table_type))) == NULL)
@@ -17,6 +49,17 @@ void test_setup(void)
         fprintf(stderr, "test_hash malloc"); 
         exit(EXIT_FAILURE);
     }
+    mock_hash_table->oldentries = NULL;
+    mock_hash_table->noldbuckets = 0;
+    mock_hash_table->rehashidx = 0;
+    mock_hash_table->is_pow2 = 0;
+    mock_hash_table->shift = 0;
+    mock_hash_table->oldshift = 0;
+    mock_hash_table->chunks = NULL;
+    mock_hash_table->nfresh = 0;
+    mock_hash_table->freelist = NULL;
+    mock_hash_table->allocator = (Allocator) CADT_ALLOCATOR_DEFAULT;
+    mock_hash_table->stats = (HashTableStats) { 0 };
 
     return;
 }
@@ -32,18 +75,15 @@ MU_TEST(test_dummy_hash)
     mu_assert_int_eq(('H' + 5), (int) dummy_hash("Hello", sizeof("Hello")));
 }
 
-MU_TEST(test_calculate_key_hash)
+MU_TEST(test_bucket_index)
 {
-    mock_hash_table->nbuckets = 31;
-    mock_hash_table->hash = dummy_hash;
-    
     mu_assert_int_eq((('H' + 5) % 31), 
-                    (int) calculate_key_hash(mock_hash_table, "Hello", sizeof("Hello")));
+                    (int) bucket_index(dummy_hash("Hello", sizeof("Hello")), 31));
     mu_assert_int_eq((('H' + 4) % 31), 
-                    (int) calculate_key_hash(mock_hash_table, "Hope", sizeof("Hope")));
+                    (int) bucket_index(dummy_hash("Hope", sizeof("Hope")), 31));
     /*key2 and key3 hash to the same value */
-    mu_assert_int_eq((int) calculate_key_hash(mock_hash_table, "Hope", sizeof("Hope")),
-                     (int) calculate_key_hash(mock_hash_table, "Hogs", sizeof("Hogs")));
+    mu_assert_int_eq((int) bucket_index(dummy_hash("Hope", sizeof("Hope")), 31),
+                     (int) bucket_index(dummy_hash("Hogs", sizeof("Hogs")), 31));
 }
 
 MU_TEST(test_get_next_prime)
@@ -55,6 +95,39 @@ MU_TEST(test_get_next_prime)
     mu_assert_int_eq((int) get_next_prime(2147483630), 2147483647);
 }
 
+MU_TEST(test_get_next_pow2)
+{
+    mu_assert_int_eq((int) get_next_pow2(1), 2);
+    mu_assert_int_eq((int) get_next_pow2(2), 2);
+    mu_assert_int_eq((int) get_next_pow2(3), 4);
+    mu_assert_int_eq((int) get_next_pow2(1000), 1024);
+    mu_assert_int_eq((int) get_next_pow2(1024), 1024);
+    mu_assert_int_eq((int) pow2_shift(2), 63);
+    mu_assert_int_eq((int) pow2_shift(1024), 54);
+}
+
+/*
+ * Fibonacci hashing stays in range and spreads hashes that differ only in their
+ * high bits, which a mask would send to a single bucket.
+ */
+MU_TEST(test_fibonacci_index)
+{
+    size_t buckets[64] = { 0 };
+    size_t i, max = 0;
+
+    for (i = 0; i < 64 * 16; i++)
+    {
+        size_t index = fibonacci_index(i << 40, pow2_shift(64));
+
+        mu_check(index < 64);
+        if (++buckets[index] > max)
+        {
+            max = buckets[index];
+        }
+    }
+    mu_check(max < 48);
+}
+
 /*
  * Test object creation and corner cases.
  */
@@ -95,6 +168,36 @@ MU_TEST(test_cadthashtable_new)
     mu_check(mock_hash_table->nbuckets == 10007);
     mu_check(mock_hash_table->nelems == 0);
     mu_check(mock_hash_table->hash == dummy_hash);
+    mu_check(mock_hash_table->is_pow2 == 0);
+    free(mock_hash_table->entries);
+}
+
+/*
+ * Test creation with a power of two number of buckets.
+ */
+MU_TEST(test_cadthashtable_new_pow2)
+{
+    errno = 0;
+    mu_check(cadthashtable_new_pow2(0, dummy_hash) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadthashtable_new_pow2(8, NULL) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+
+    free(mock_hash_table);
+    mu_check((mock_hash_table = cadthashtable_new_pow2(1, dummy_hash)) != NULL);
+    mu_check(mock_hash_table->nbucketsinitial == 2);
+    mu_check(mock_hash_table->nbuckets == 2);
+    mu_check(mock_hash_table->is_pow2 == 1);
+    mu_check(mock_hash_table->shift == 63);
+    free(mock_hash_table->entries);
+
+    free(mock_hash_table);
+    mu_check((mock_hash_table = cadthashtable_new_pow2(9999, dummy_hash)) != NULL);
+    mu_check(mock_hash_table->nbucketsinitial == 16384);
+    mu_check(mock_hash_table->nbuckets == 16384);
+    mu_check(mock_hash_table->shift == 50);
     free(mock_hash_table->entries);
 }
 
@@ -141,6 +244,8 @@ MU_TEST(test_cadthashtable_insert)
     mu_check((cadthashtable_insert(mock_hash_table, "Hogs", sizeof("Hogs"), "Hogs")) != NULL);
 
     /* Validate table structure */
+    mu_check(mock_hash_table->entries[index1]->hash == dummy_hash("Hello", sizeof("Hello")));
+    mu_check(mock_hash_table->entries[index2]->hash == dummy_hash("Hope", sizeof("Hope")));
     mu_assert_string_eq(mock_hash_table->entries[index1]->item, "Hello");
     mu_assert_string_eq(mock_hash_table->entries[index2]->item, "Hogs");
     mu_assert_string_eq(mock_hash_table->entries[index2]->next->item, "Hope");
@@ -152,12 +257,7 @@ MU_TEST(test_cadthashtable_insert)
     mu_check(errno == EEXIST);
 
     /* Cleanup */
-    free(mock_hash_table->entries[index2]->next->key);
-    free(mock_hash_table->entries[index2]->next);
-    free(mock_hash_table->entries[index2]->key);
-    free(mock_hash_table->entries[index2]);
-    free(mock_hash_table->entries[index1]->key);
-    free(mock_hash_table->entries[index1]);
+    free_pool(mock_hash_table, NULL, NULL);
     free(mock_hash_table->entries);
 }
 
@@ -184,9 +284,9 @@ MU_TEST(test_cadthashtable_lookup)
     mock_hash_table->hash = dummy_hash;
 
     /* Allocate entries */
-    Entry entry1 = { sizeof("Hello"), "Hello", "Hello", NULL };
-    Entry entry2 = { sizeof("Hope"), "Hope", "Hope", NULL };
-    Entry entry3 = { sizeof("Hogs"), "Hogs", "Hogs", NULL };
+    Entry entry1 = { 'H' + 5, sizeof("Hello"), { "Hello" }, "Hello", NULL };
+    Entry entry2 = { 'H' + 4, sizeof("Hope"), { "Hope" }, "Hope", NULL };
+    Entry entry3 = { 'H' + 4, sizeof("Hogs"), { "Hogs" }, "Hogs", NULL };
     /* Build array of entries */
     mock_hash_table->entries[index1] = &entry1;
     mock_hash_table->entries[index2] = &entry2;
@@ -219,6 +319,10 @@ MU_TEST(test_cadthashtable_lookup)
     mu_check(e == entry3.item);
     mu_check(cadthashtable_lookup(mock_hash_table, "NotInTable", sizeof("NotInTable")) == NULL);
 
+    /* Keys are never compared if the cached hashes differ */
+    entry3.hash++;
+    mu_check(cadthashtable_lookup(mock_hash_table, "Hogs", sizeof("Hogs")) == NULL);
+
     free(mock_hash_table->entries);
 }
 
@@ -249,28 +353,32 @@ MU_TEST(test_cadthashtable_delete)
 
     /* Allocate and initialize entries */
     Entry *entry1, *entry2, *entry3, *entry4;
-    if ((entry1 = malloc(sizeof(Entry))) == NULL
-            || (entry2 = malloc(sizeof(Entry))) == NULL
-            || (entry3 = malloc(sizeof(Entry))) == NULL
-            || (entry4 = malloc(sizeof(Entry))) == NULL)
+    if ((entry1 = entry_alloc(mock_hash_table)) == NULL
+            || (entry2 = entry_alloc(mock_hash_table)) == NULL
+            || (entry3 = entry_alloc(mock_hash_table)) == NULL
+            || (entry4 = entry_alloc(mock_hash_table)) == NULL)
     { 
-        perror("test_cadthashtable_lookup malloc failed allocating struct entry");
+        perror("test_cadthashtable_delete failed allocating struct entry");
         exit(EXIT_FAILURE);
     }
+    entry1->hash = dummy_hash("Hello", sizeof("Hello"));
     entry1->keysize = sizeof("Hello");
-    entry1->key = "Hello";
+    memcpy(entry1->key.bytes, "Hello", sizeof("Hello"));
     entry1->item = "Hello";
     entry1->next = NULL;
+    entry2->hash = dummy_hash("Hope", sizeof("Hope"));
     entry2->keysize = sizeof("Hope");
-    entry2->key = "Hope";
+    memcpy(entry2->key.bytes, "Hope", sizeof("Hope"));
     entry2->item = "Hope";
     entry2->next = NULL;
+    entry3->hash = dummy_hash("Hogs", sizeof("Hogs"));
     entry3->keysize = sizeof("Hogs");
-    entry3->key = "Hogs";
+    memcpy(entry3->key.bytes, "Hogs", sizeof("Hogs"));
     entry3->item = "Hogs";
     entry3->next = NULL;
+    entry4->hash = dummy_hash("Holy", sizeof("Holy"));
     entry4->keysize = sizeof("Holy");
-    entry4->key = "Holy";
+    memcpy(entry4->key.bytes, "Holy", sizeof("Holy"));
     entry4->item = "Holy";
     entry4->next = NULL;
 
@@ -331,20 +439,520 @@ MU_TEST(test_cadthashtable_delete)
     mu_assert_string_eq(mock_hash_table->entries[index2]->item, "Hogs");
     mu_assert(mock_hash_table->nelems == 1, "nelems should be 1");
 
+    /* Deleted entries went back to the pool */
+    mu_check(mock_hash_table->freelist == entry1);
+    mu_check(entry1->next == entry4 && entry4->next == entry2);
+
+    free_pool(mock_hash_table, NULL, NULL);
     free(mock_hash_table->entries);
-    free(entry3);
+}
+
+/*
+ * Test entries are carved from chunks, and released ones are reused first.
+ */
+MU_TEST(test_entry_pool)
+{
+    Entry *e[POOL_CHUNK_NENTRIES + 2];
+    size_t i;
+
+    mock_hash_table->chunks = NULL;
+    mock_hash_table->nfresh = 0;
+    mock_hash_table->freelist = NULL;
+
+    for (i = 0; i < POOL_CHUNK_NENTRIES + 2; i++)
+    {
+        mu_check((e[i] = entry_alloc(mock_hash_table)) != NULL);
+        e[i]->keysize = sizeof("Hello");
+    }
+    /* Two chunks, contiguous entries within each */
+    mu_check(mock_hash_table->chunks->next != NULL);
+    mu_check(mock_hash_table->chunks->next->next == NULL);
+    mu_check(mock_hash_table->nfresh == POOL_CHUNK_NENTRIES - 2);
+    mu_check(e[1] == e[0] + 1);
+    mu_check(e[POOL_CHUNK_NENTRIES] == &mock_hash_table->chunks->entries[0]);
+
+    entry_free(mock_hash_table, e[3]);
+    entry_free(mock_hash_table, e[5]);
+    mu_check(e[3]->keysize == 0);
+    mu_check(entry_alloc(mock_hash_table) == e[5]);
+    mu_check(entry_alloc(mock_hash_table) == e[3]);
+    mu_check(mock_hash_table->freelist == NULL);
+    mu_check(mock_hash_table->nfresh == POOL_CHUNK_NENTRIES - 2);
+
+    free_pool(mock_hash_table, NULL, NULL);
+    mu_check(mock_hash_table->chunks == NULL);
+    mu_check(mock_hash_table->nfresh == 0);
+}
+
+/*
+ * Test keys up to `INLINE_KEY_SIZE` bytes are stored inside the entry, and
+ * larger ones in their own allocation.
+ */
+MU_TEST(test_inline_keys)
+{
+    static const char id[INLINE_KEY_SIZE] = "0123456789abcde";
+    static const char url[] = "https://example.com/a/long/key";
+    Entry *e;
+
+    free(mock_hash_table);
+    mu_check((mock_hash_table = cadthashtable_new(31, fnv_hash)) != NULL);
+
+    mu_check(cadthashtable_insert(mock_hash_table, id, sizeof(id), "id") != NULL);
+    mu_check(cadthashtable_insert(mock_hash_table, url, sizeof(url), "url") != NULL);
+
+    e = *find_key(mock_hash_table, fnv_hash(id, sizeof(id)), id, sizeof(id));
+    mu_check(!has_spilled_key(e));
+    mu_check(entry_key(e) == e->key.bytes);
+    mu_check(memcmp(e->key.bytes, id, sizeof(id)) == 0);
+
+    e = *find_key(mock_hash_table, fnv_hash(url, sizeof(url)), url, sizeof(url));
+    mu_check(has_spilled_key(e));
+    mu_check(entry_key(e) == e->key.ptr);
+    mu_check(memcmp(e->key.ptr, url, sizeof(url)) == 0);
+
+    mu_assert_string_eq("id", cadthashtable_lookup(mock_hash_table, id, sizeof(id)));
+    mu_assert_string_eq("url", cadthashtable_lookup(mock_hash_table, url, sizeof(url)));
+
+    /* The spilled copy is released on deletion */
+    mu_assert_string_eq("url", cadthashtable_delete(mock_hash_table, (void *) url, 
+                                                    sizeof(url), "url"));
+    mu_assert_string_eq("id", cadthashtable_delete(mock_hash_table, (void *) id, 
+                                                   sizeof(id), "id"));
+
+    cadthashtable_destroy(mock_hash_table);
+    mock_hash_table = NULL;
+}
+
+/*
+ * Test a key is hashed once per insert, lookup or delete, and never again when
+ * its entry is migrated by a rehash.
+ */
+MU_TEST(test_hash_once)
+{
+    char keys[100][8];
+    size_t i;
+
+    free(mock_hash_table);
+    mu_check((mock_hash_table = cadthashtable_new(7, counting_hash)) != NULL);
+
+    for (i = 0; i < 100; i++)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "k%zu", i);
+        nhashes = 0;
+        mu_check(cadthashtable_insert(mock_hash_table, keys[i], 
+                                      sizeof(keys[i]), keys[i]) != NULL);
+        mu_check(nhashes == 1);
+    }
+
+    nhashes = 0;
+    mu_check(cadthashtable_lookup(mock_hash_table, keys[7], sizeof(keys[7])) == keys[7]);
+    mu_check(nhashes == 1);
+
+    for (i = 0; i < 100; i++)
+    {
+        nhashes = 0;
+        mu_check(cadthashtable_delete(mock_hash_table, keys[i], 
+                                      sizeof(keys[i]), keys[i]) == keys[i]);
+        mu_check(nhashes == 1);
+    }
+
+    cadthashtable_destroy(mock_hash_table);
+    mock_hash_table = NULL;
+}
+
+/*
+ * Test the table grows and shrinks with its load factor, migrating entries a
+ * few buckets at a time while keeping every key reachable.
+ */
+MU_TEST(test_resize_on_load)
+{
+    char keys[1000][8];
+    size_t i, nbuckets;
+    int seen_rehash = 0;
+
+    free(mock_hash_table);
+    mu_check((mock_hash_table = cadthashtable_new(7, fnv_hash)) != NULL);
+
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "k%zu", i);
+        mu_check(cadthashtable_insert(mock_hash_table, keys[i], 
+                                      sizeof(keys[i]), keys[i]) != NULL);
+
+        if (mock_hash_table->oldentries != NULL)
+        {
+            seen_rehash = 1;
+            /* Lookups must reach entries not migrated yet */
+            mu_check(cadthashtable_lookup(mock_hash_table, keys[0], 
+                                          sizeof(keys[0])) == keys[0]);
+            mu_check(cadthashtable_lookup(mock_hash_table, keys[i], 
+                                          sizeof(keys[i])) == keys[i]);
+        }
+    }
+    mu_check(seen_rehash);
+    mu_check(mock_hash_table->nelems == 1000);
+    mu_check(mock_hash_table->nbuckets >= 500);
+
+    /* Migration is bounded per call */
+    if (mock_hash_table->oldentries != NULL)
+    {
+        size_t before = mock_hash_table->rehashidx;
+        cadthashtable_lookup(mock_hash_table, keys[0], sizeof(keys[0]));
+        mu_check(mock_hash_table->oldentries == NULL
+                || mock_hash_table->rehashidx - before <= REHASH_STEP * 10);
+    }
+
+    for (i = 0; i < 1000; i++)
+    {
+        mu_check(cadthashtable_lookup(mock_hash_table, keys[i], 
+                                      sizeof(keys[i])) == keys[i]);
+    }
+
+    nbuckets = mock_hash_table->nbuckets;
+    for (i = 0; i < 1000; i++)
+    {
+        mu_check(cadthashtable_delete(mock_hash_table, keys[i], 
+                                      sizeof(keys[i]), keys[i]) == keys[i]);
+        mu_check(cadthashtable_lookup(mock_hash_table, keys[i], 
+                                      sizeof(keys[i])) == NULL);
+    }
+    mu_check(mock_hash_table->nelems == 0);
+    mu_check(mock_hash_table->nbuckets < nbuckets);
+    mu_check(mock_hash_table->nbuckets >= mock_hash_table->nbucketsinitial);
+
+    cadthashtable_destroy(mock_hash_table);
+    mock_hash_table = NULL;
+}
+
+/*
+ * Test batch lookups agree with single lookups, across several batches and
+ * while the table is rehashing.
+ */
+MU_TEST(test_cadthashtable_lookup_n)
+{
+    char keys[100][8];
+    const void *ptrs[100];
+    size_t sizes[100];
+    Element results[100];
+    size_t i;
+
+    free(mock_hash_table);
+    mu_check((mock_hash_table = cadthashtable_new(7, fnv_hash)) != NULL);
+
+    for (i = 0; i < 100; i++)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "k%zu", i);
+        ptrs[i] = keys[i];
+        sizes[i] = sizeof(keys[i]);
+        if (i % 2 == 0)
+        {
+            mu_check(cadthashtable_insert(mock_hash_table, keys[i], 
+                                          sizeof(keys[i]), keys[i]) != NULL);
+        }
+    }
+
+    /* Sanity checks */
+    errno = 0;
+    mu_check(cadthashtable_lookup_n(NULL, ptrs, sizes, 100, results) == 0);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadthashtable_lookup_n(mock_hash_table, ptrs, sizes, 100, NULL) == 0);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadthashtable_lookup_n(mock_hash_table, ptrs, sizes, 0, results) == 0);
+    mu_check(errno == 0);
+
+    mu_check(cadthashtable_lookup_n(mock_hash_table, ptrs, sizes, 100, results) == 50);
+    for (i = 0; i < 100; i++)
+    {
+        mu_check(results[i] == (i % 2 == 0 ? keys[i] : NULL));
+    }
+
+    /* A bad key does not stop the batch */
+    sizes[3] = 0;
+    ptrs[4] = NULL;
+    mu_check(cadthashtable_lookup_n(mock_hash_table, ptrs, sizes, 20, results) == 9);
+    mu_check(errno == EINVAL);
+    mu_check(results[2] == keys[2]);
+    mu_check(results[4] == NULL);
+    mu_check(results[6] == keys[6]);
+
+    cadthashtable_destroy(mock_hash_table);
+    mock_hash_table = NULL;
+}
+
+/*
+ * Test a power of two table keeps its bucket count a power of two while it
+ * resizes, and keeps every key reachable even with a hash as weak as
+ * `dummy_hash`.
+ */
+MU_TEST(test_resize_pow2)
+{
+    char keys[1000][8];
+    size_t i;
+
+    free(mock_hash_table);
+    mu_check((mock_hash_table = cadthashtable_new_pow2(7, fnv_hash)) != NULL);
+
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "k%zu", i);
+        mu_check(cadthashtable_insert(mock_hash_table, keys[i], 
+                                      sizeof(keys[i]), keys[i]) != NULL);
+        mu_check((mock_hash_table->nbuckets & (mock_hash_table->nbuckets - 1)) == 0);
+        mu_check(mock_hash_table->shift == pow2_shift(mock_hash_table->nbuckets));
+    }
+    mu_check(mock_hash_table->nbuckets >= 1000);
+
+    for (i = 0; i < 1000; i++)
+    {
+        mu_check(cadthashtable_lookup(mock_hash_table, keys[i], 
+                                      sizeof(keys[i])) == keys[i]);
+    }
+    for (i = 0; i < 1000; i++)
+    {
+        mu_check(cadthashtable_delete(mock_hash_table, keys[i], 
+                                      sizeof(keys[i]), keys[i]) == keys[i]);
+    }
+    mu_check(mock_hash_table->nelems == 0);
+    mu_check(mock_hash_table->nbuckets == mock_hash_table->nbucketsinitial
+             || mock_hash_table->oldentries != NULL);
+    cadthashtable_destroy(mock_hash_table);
+
+    mu_check((mock_hash_table = cadthashtable_new_pow2(4, dummy_hash)) != NULL);
+    mu_check(cadthashtable_insert(mock_hash_table, "Hello", sizeof("Hello"), "Hello") != NULL);
+    mu_check(cadthashtable_insert(mock_hash_table, "Hope", sizeof("Hope"), "Hope") != NULL);
+    mu_check(cadthashtable_insert(mock_hash_table, "Hogs", sizeof("Hogs"), "Hogs") != NULL);
+    mu_assert_string_eq(cadthashtable_lookup(mock_hash_table, "Hope", sizeof("Hope")), "Hope");
+    mu_assert_string_eq(cadthashtable_lookup(mock_hash_table, "Hogs", sizeof("Hogs")), "Hogs");
+    cadthashtable_destroy(mock_hash_table);
+    mock_hash_table = NULL;
+}
+
+/*
+ * Test every entry is visited exactly once, whether the table is rehashing or
+ * not, and that destroying with a visitor hands over every element.
+ */
+MU_TEST(test_iteration)
+{
+    static char keys[500][24];
+    static int seen[500];
+    HashTableIterator it;
+    const void *key;
+    size_t i, keysize, nvisited;
+    int seen_rehash = 0;
+    Element e;
+
+    free(mock_hash_table);
+    mu_check((mock_hash_table = cadthashtable_new(7, fnv_hash)) != NULL);
+
+    /* Nothing to visit */
+    cadthashtable_iter_init(mock_hash_table, &it);
+    mu_check(cadthashtable_iter_next(&it, &key, &keysize, &e) == false);
+    nvisited = 0;
+    cadthashtable_foreach(mock_hash_table, counting_visitor, &nvisited);
+    mu_check(nvisited == 0);
+
+    for (i = 0; i < 500; i++)
+    {
+        char *item;
+
+        /* Both inline and separately allocated keys */
+        snprintf(keys[i], sizeof(keys[i]), i % 2 ? "k%zu" : "long-key-%zu", i);
+        if ((item = malloc(sizeof(keys[i]))) == NULL)
+        {
+            perror("test_iteration malloc failed allocating item");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(item, keys[i], sizeof(keys[i]));
+        mu_check(cadthashtable_insert(mock_hash_table, keys[i], 
+                                      strlen(keys[i]) + 1, item) != NULL);
+
+        /* Visits buckets not migrated yet too */
+        if (mock_hash_table->oldentries != NULL)
+        {
+            seen_rehash = 1;
+            nvisited = 0;
+            cadthashtable_foreach(mock_hash_table, counting_visitor, &nvisited);
+            mu_check(nvisited == i + 1);
+        }
+    }
+    mu_check(seen_rehash);
+    mu_check(cadthashtable_nelems(mock_hash_table) == 500);
+    nvisited = 0;
+    cadthashtable_foreach(mock_hash_table, counting_visitor, &nvisited);
+    mu_check(nvisited == 500);
+
+    /* Finishes the pending rehash, if any */
+    cadthashtable_iter_init(mock_hash_table, &it);
+    mu_check(mock_hash_table->oldentries == NULL);
+    nvisited = 0;
+    while (cadthashtable_iter_next(&it, &key, &keysize, &e))
+    {
+        mu_check(keysize == strlen(key) + 1);
+        mu_assert_string_eq(key, e);
+        i = (size_t) atoi((const char *) key + (((const char *) key)[0] == 'l' ? 9 : 1));
+        mu_check(i < 500 && seen[i] == 0);
+        seen[i] = 1;
+        nvisited++;
+    }
+    mu_check(nvisited == 500);
+    mu_check(cadthashtable_iter_next(&it, NULL, NULL, NULL) == false);
+
+    /* Sanity checks */
+    errno = 0;
+    cadthashtable_foreach(NULL, counting_visitor, &nvisited);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    cadthashtable_iter_init(NULL, &it);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadthashtable_iter_next(&it, NULL, NULL, NULL) == false);
+    mu_check(errno == EINVAL);
+
+    /* Deleted entries are not handed over, leaks would fail the test */
+    e = cadthashtable_lookup(mock_hash_table, keys[0], strlen(keys[0]) + 1);
+    mu_check(cadthashtable_delete(mock_hash_table, keys[0], 
+                                  strlen(keys[0]) + 1, e) == e);
+    free(e);
+    cadthashtable_destroy_with(mock_hash_table, freeing_visitor, NULL);
+    mock_hash_table = NULL;
+}
+
+/*
+ * Test every block of a table goes through its allocator, with the sizes it
+ * was allocated with, across resizes and spilled keys.
+ */
+MU_TEST(test_allocator)
+{
+    size_t nbytes = 0;
+    Allocator a = { counting_alloc, counting_realloc, counting_free, &nbytes };
+    Allocator incomplete = { counting_alloc, counting_realloc, NULL, &nbytes };
+    char keys[1000][INLINE_KEY_SIZE * 2];
+    size_t i;
+
+    free(mock_hash_table);
+    mock_hash_table = NULL;
+
+    errno = 0;
+    mu_check(cadthashtable_new_with_allocator(31, fnv_hash, NULL) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadthashtable_new_with_allocator(31, fnv_hash, &incomplete) == NULL);
+    mu_check(errno == EINVAL);
+    mu_check(nbytes == 0);
+
+    mock_hash_table = cadthashtable_new_with_allocator(31, fnv_hash, &a);
+    mu_check(mock_hash_table != NULL);
+    mu_check(nbytes == sizeof(struct hash_table_type) + 31 * sizeof(Entry*));
+
+    /* Every other key is spilled out of its entry */
+    for (i = 0; i < 1000; i++)
+    {
+        size_t keysize = (i % 2) ? sizeof(keys[i]) : INLINE_KEY_SIZE;
+
+        memset(keys[i], 'k', sizeof(keys[i]));
+        sprintf(keys[i], "%zu", i);
+        mu_check(cadthashtable_insert(mock_hash_table, keys[i], keysize, 
+                                      keys[i]) != NULL);
+    }
+    for (i = 0; i < 1000; i++)
+    {
+        size_t keysize = (i % 2) ? sizeof(keys[i]) : INLINE_KEY_SIZE;
+
+        mu_check(cadthashtable_delete(mock_hash_table, keys[i], keysize, 
+                                      keys[i]) == keys[i]);
+    }
+    while (mock_hash_table->oldentries != NULL)
+    {
+        rehash_step(mock_hash_table, REHASH_STEP);
+    }
+    mu_check(nbytes == sizeof(struct hash_table_type) 
+                       + mock_hash_table->nbuckets * sizeof(Entry*)
+                       + 4 * sizeof(EntryChunk));
+
+    cadthashtable_destroy(mock_hash_table);
+    mock_hash_table = NULL;
+    mu_check(nbytes == 0);
+}
+
+/*
+ * Test the statistics follow the rehashes, and the histogram accounts for
+ * every bucket and every entry.
+ */
+MU_TEST(test_stats)
+{
+    HashTableStats stats;
+    size_t keys[100];
+    size_t i, nbuckets, nentries;
+
+    free(mock_hash_table);
+    mu_check((mock_hash_table = cadthashtable_new(31, fnv_hash)) != NULL);
+
+    for (i = 0; i < 100; i++)
+    {
+        keys[i] = i;
+        cadthashtable_insert(mock_hash_table, &keys[i], sizeof(keys[i]), "x");
+    }
+    stats = cadthashtable_stats(mock_hash_table);
+    mu_check(stats.nelems == 100);
+    mu_check(stats.high_water == 100);
+    mu_check(stats.ngrows >= 1);
+    mu_check(stats.nshrinks == 0);
+    mu_check(stats.nbuckets == mock_hash_table->nbuckets);
+    mu_check(stats.load_factor == 100.0 / (double) stats.nbuckets);
+
+    /* The histogram covers the buckets of both arrays while rehashing */
+    nbuckets = 0;
+    nentries = 0;
+    for (i = 0; i < CADT_CHAIN_HISTOGRAM_SIZE; i++)
+    {
+        nbuckets += stats.chain_lengths[i];
+        nentries += i * stats.chain_lengths[i];
+    }
+    mu_check(nbuckets == mock_hash_table->nbuckets 
+                         + mock_hash_table->noldbuckets 
+                         - mock_hash_table->rehashidx);
+    mu_check(stats.max_chain < CADT_CHAIN_HISTOGRAM_SIZE);
+    mu_check(nentries == 100);
+
+    for (i = 0; i < 100; i++)
+    {
+        cadthashtable_delete(mock_hash_table, &keys[i], sizeof(keys[i]), "x");
+    }
+    stats = cadthashtable_stats(mock_hash_table);
+    mu_check(stats.nelems == 0);
+    mu_check(stats.high_water == 100);
+    mu_check(stats.nshrinks >= 1);
+    mu_check(stats.nmigrated >= 100);
+    mu_check(stats.max_chain == 0);
+
+    cadthashtable_destroy(mock_hash_table);
+    mock_hash_table = NULL;
 }
 
 MU_TEST_SUITE(test_suite) 
 {
 	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
     MU_RUN_TEST(test_dummy_hash);
-	MU_RUN_TEST(test_calculate_key_hash);
+	MU_RUN_TEST(test_bucket_index);
     MU_RUN_TEST(test_get_next_prime);
+	MU_RUN_TEST(test_get_next_pow2);
+	MU_RUN_TEST(test_fibonacci_index);
 	MU_RUN_TEST(test_cadthashtable_new);
+	MU_RUN_TEST(test_cadthashtable_new_pow2);
 	MU_RUN_TEST(test_cadthashtable_insert);
 	MU_RUN_TEST(test_cadthashtable_lookup);
+	MU_RUN_TEST(test_cadthashtable_lookup_n);
 	MU_RUN_TEST(test_cadthashtable_delete);
+	MU_RUN_TEST(test_entry_pool);
+	MU_RUN_TEST(test_inline_keys);
+	MU_RUN_TEST(test_hash_once);
+	MU_RUN_TEST(test_resize_on_load);
+	MU_RUN_TEST(test_resize_pow2);
+	MU_RUN_TEST(test_iteration);
+	MU_RUN_TEST(test_allocator);
+	MU_RUN_TEST(test_stats);
 }
 
 int main(int argc, char *argv[]) 
@@ -360,3 +968,63 @@ static size_t dummy_hash(const void* key, size_t key_len)
     const char *p = key;
     return (size_t) p[0] + key_len - 1;
 }
+
+static size_t fnv_hash(const void* key, size_t key_len)
+{
+    const unsigned char *p = key;
+    size_t hash = 2166136261u;
+
+    while (key_len-- > 0)
+    {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+static size_t counting_hash(const void* key, size_t key_len)
+{
+    nhashes++;
+    return fnv_hash(key, key_len);
+}
+
+static void counting_visitor(const void *key, size_t keysize, Element e, 
+                             void *ctx)
+{
+    if (keysize == strlen(key) + 1 && strcmp(key, e) == 0)
+    {
+        (*(size_t *) ctx)++;
+    }
+}
+
+static void freeing_visitor(const void *key, size_t keysize, Element e, 
+                            void *ctx)
+{
+    (void) key;
+    (void) keysize;
+    (void) ctx;
+    free(e);
+}
+
+static void *counting_alloc(void *ctx, size_t size)
+{
+    *(size_t *) ctx += size;
+    return malloc(size);
+}
+
+static void *counting_realloc(void *ctx, void *ptr, size_t old_size,
+                              size_t new_size)
+{
+    void *p;
+
+    if ((p = realloc(ptr, new_size)) != NULL)
+    {
+        *(size_t *) ctx = *(size_t *) ctx - old_size + new_size;
+    }
+    return p;
+}
+
+static void counting_free(void *ctx, void *ptr, size_t size)
+{
+    *(size_t *) ctx -= size;
+    free(ptr);
+}
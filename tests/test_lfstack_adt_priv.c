@@ -0,0 +1,175 @@
+#include "minunit.h"
+#include "../src/lfstack_adt.c"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define NTHREADS 4
+#define NITEMS_PER_THREAD 50000
+
+static LFStackADT *size_1;
+static char* elements[3] = { "Lorem", "ipsum", "dolor" };
+
+/* Items pushed by each thread, and how many times each item was popped */
+static size_t items[NTHREADS * NITEMS_PER_THREAD];
+static size_t seen[NTHREADS * NITEMS_PER_THREAD];
+
+/*
+ * Pushes its share of items onto `size_1`, popping one item every other push.
+ */
+static void *worker(void *arg);
+
+void test_setup(void)
+{
+    size_1 = cadtlfstack_new(1);
+    return;
+}
+
+void test_teardown(void)
+{
+    cadtlfstack_destroy(size_1);
+    return;
+}
+
+/*
+ * Testing `lf_stack_type` creation goes smoothly, and its layout.
+ */
+MU_TEST(test_lf_stack_type)
+{
+    LFStackADT *s;
+
+    errno = 0;
+    mu_assert(cadtlfstack_new(0) == NULL,
+            "Zero size stacks should not be allowed");
+    mu_check(errno == EINVAL);
+
+    mu_check(size_1->nchunks == 1);
+    mu_check(size_1->top == 0);
+    s = cadtlfstack_new(100);
+    mu_check(s->nchunks == 2);
+    cadtlfstack_destroy(s);
+
+    /* The top and the free list on cache lines of their own */
+    mu_check((size_t) size_1 % CACHE_LINE_SIZE == 0);
+    mu_check(offsetof(struct lf_stack_type, free) == CACHE_LINE_SIZE);
+    mu_check(sizeof(NodeCache) == 2 * CACHE_LINE_SIZE);
+
+    /* Node references map onto consecutive chunks */
+    mu_check(node_of(size_1, 1) == &size_1->chunks[0][0]);
+    mu_check(node_of(size_1, 64) == &size_1->chunks[0][63]);
+}
+
+/*
+ * Testing push and pop from a single thread, generations, growth and node
+ * recycling.
+ */
+MU_TEST(test_push_pop)
+{
+    size_t i;
+    uint64_t top;
+
+    errno = 0;
+    mu_check(cadtlfstack_pop(size_1) == NULL);
+    mu_check(errno == EPERM);
+
+    mu_assert_string_eq("Lorem", cadtlfstack_push(size_1, elements[0]));
+    mu_assert_string_eq("ipsum", cadtlfstack_push(size_1, elements[1]));
+    mu_check(cadtlfstack_nelems(size_1) == 2);
+    mu_check(size_1->top >> 32 == 2);
+
+    /* The popped node is reused by the next push, under a new generation */
+    top = size_1->top;
+    mu_assert_string_eq("ipsum", cadtlfstack_pop(size_1));
+    mu_assert_string_eq("dolor", cadtlfstack_push(size_1, elements[2]));
+    mu_check((size_1->top & REF_MASK) == (top & REF_MASK));
+    mu_check(size_1->top != top);
+
+    /* Grows past the first chunk */
+    for (i = 0; i < 100; i++)
+    {
+        mu_check(cadtlfstack_push(size_1, elements[i % 3]) != NULL);
+    }
+    mu_check(size_1->nchunks == 2);
+    mu_check(cadtlfstack_nelems(size_1) == 102);
+    for (i = 100; i > 0; i--)
+    {
+        mu_assert_string_eq(elements[(i - 1) % 3], cadtlfstack_pop(size_1));
+    }
+    mu_assert_string_eq("dolor", cadtlfstack_pop(size_1));
+    mu_assert_string_eq("Lorem", cadtlfstack_pop(size_1));
+    mu_check(cadtlfstack_nelems(size_1) == 0);
+
+    /* Warm, pushing again allocates no chunk */
+    for (i = 0; i < 100; i++)
+    {
+        cadtlfstack_push(size_1, elements[0]);
+    }
+    mu_check(size_1->nchunks == 2);
+}
+
+/*
+ * Testing every item is popped exactly once with several threads pushing and
+ * popping.
+ */
+MU_TEST(test_threads)
+{
+    pthread_t threads[NTHREADS];
+    size_t ids[NTHREADS];
+    size_t i, *item;
+
+    for (i = 0; i < NTHREADS; i++)
+    {
+        ids[i] = i;
+        mu_check(pthread_create(&threads[i], NULL, worker, &ids[i]) == 0);
+    }
+    for (i = 0; i < NTHREADS; i++)
+    {
+        mu_check(pthread_join(threads[i], NULL) == 0);
+    }
+    mu_check(cadtlfstack_nelems(size_1) == NTHREADS * NITEMS_PER_THREAD / 2);
+
+    while ((item = cadtlfstack_pop(size_1)) != NULL)
+    {
+        seen[*item]++;
+    }
+    for (i = 0; i < NTHREADS * NITEMS_PER_THREAD; i++)
+    {
+        mu_check(seen[i] == 1);
+    }
+}
+
+MU_TEST_SUITE(test_suite)
+{
+	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+	MU_RUN_TEST(test_lf_stack_type);
+	MU_RUN_TEST(test_push_pop);
+	MU_RUN_TEST(test_threads);
+}
+
+int main(int argc, char *argv[])
+{
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+
+	return MU_EXIT_CODE;
+}
+
+static void *worker(void *arg)
+{
+    size_t id = *(size_t *) arg;
+    size_t i, *item;
+
+    for (i = id * NITEMS_PER_THREAD; i < (id + 1) * NITEMS_PER_THREAD; i++)
+    {
+        items[i] = i;
+        while (cadtlfstack_push(size_1, &items[i]) == NULL)
+        {
+            sched_yield();
+        }
+        if (i % 2 == 1 && (item = cadtlfstack_pop(size_1)) != NULL)
+        {
+            __atomic_fetch_add(&seen[*item], 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,194 @@
+#include "minunit.h"
+#include "../src/mpmcqueue_adt.c"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define NTHREADS 3
+#define NITEMS_PER_THREAD 20000
+
+static MPMCQueueADT *size_4, *size_2;
+static char* elements[5] = { "Lorem", "ipsum", "dolor", "sit", "amet" };
+
+/* Counts how many times each item was dequeued */
+static unsigned char seen[NTHREADS * NITEMS_PER_THREAD];
+static size_t items[NTHREADS * NITEMS_PER_THREAD];
+static size_t nconsumed;
+
+/*
+ * Enqueues its share of `items` into `size_4`.
+ */
+static void *producer(void *arg);
+
+/*
+ * Dequeues from `size_4` until every item was consumed by some consumer.
+ */
+static void *consumer(void *arg);
+
+void test_setup(void)
+{
+    size_4 = cadtmpmcqueue_new(3);
+    size_2 = cadtmpmcqueue_new(1);
+    return;
+}
+
+void test_teardown(void)
+{
+    cadtmpmcqueue_destroy(size_4);
+    cadtmpmcqueue_destroy(size_2);
+    return;
+}
+
+/*
+ * Testing `mpmc_queue_type` creation goes smoothly, and its layout.
+ */
+MU_TEST(test_mpmc_queue_type)
+{
+    errno = 0;
+    mu_assert(cadtmpmcqueue_new(0) == NULL,
+            "Zero size queues should not be allowed");
+    mu_check(errno == EINVAL);
+
+    mu_check(cadtmpmcqueue_capacity(size_4) == 4);
+    mu_check(cadtmpmcqueue_capacity(size_2) == 2);
+    mu_check(size_4->cells[3].seq == 3);
+
+    mu_check((size_t) size_4 % CACHE_LINE_SIZE == 0);
+    mu_check(offsetof(struct mpmc_queue_type, enqueue_pos) == CACHE_LINE_SIZE);
+    mu_check(offsetof(struct mpmc_queue_type, dequeue_pos) == 2 * CACHE_LINE_SIZE);
+}
+
+/*
+ * Testing overflow, underflow and laps around the ring from a single thread.
+ */
+MU_TEST(test_enqueue_dequeue)
+{
+    size_t i;
+
+    errno = 0;
+    mu_check(cadtmpmcqueue_dequeue(size_4) == NULL);
+    mu_check(errno == EPERM);
+
+    for (i = 0; i < 4; i++)
+    {
+        mu_assert_string_eq(elements[i], cadtmpmcqueue_enqueue(size_4, elements[i]));
+    }
+    mu_check(cadtmpmcqueue_nelems(size_4) == 4);
+    errno = 0;
+    mu_check(cadtmpmcqueue_enqueue(size_4, elements[4]) == NULL);
+    mu_check(errno == EPERM);
+
+    mu_assert_string_eq("Lorem", cadtmpmcqueue_dequeue(size_4));
+    mu_assert_string_eq("amet", cadtmpmcqueue_enqueue(size_4, elements[4]));
+    mu_check(size_4->cells[0].seq == 5);
+    for (i = 1; i < 5; i++)
+    {
+        mu_assert_string_eq(elements[i], cadtmpmcqueue_dequeue(size_4));
+    }
+    mu_check(cadtmpmcqueue_nelems(size_4) == 0);
+    mu_check(cadtmpmcqueue_dequeue(size_4) == NULL);
+
+    for (i = 0; i < 10; i++)
+    {
+        mu_assert_string_eq("Lorem", cadtmpmcqueue_enqueue(size_2, elements[0]));
+        mu_assert_string_eq("ipsum", cadtmpmcqueue_enqueue(size_2, elements[1]));
+        mu_check(cadtmpmcqueue_enqueue(size_2, elements[2]) == NULL);
+        mu_assert_string_eq("Lorem", cadtmpmcqueue_dequeue(size_2));
+        mu_assert_string_eq("ipsum", cadtmpmcqueue_dequeue(size_2));
+        mu_check(cadtmpmcqueue_dequeue(size_2) == NULL);
+    }
+}
+
+/*
+ * Testing every item crosses exactly once with several producers and
+ * consumers, and items of one producer keep their order.
+ */
+MU_TEST(test_threads)
+{
+    pthread_t producers[NTHREADS], consumers[NTHREADS];
+    size_t ids[NTHREADS];
+    size_t i;
+    void *misordered;
+    size_t nmisordered = 0;
+
+    for (i = 0; i < NTHREADS; i++)
+    {
+        ids[i] = i;
+        mu_check(pthread_create(&producers[i], NULL, producer, &ids[i]) == 0);
+        mu_check(pthread_create(&consumers[i], NULL, consumer, NULL) == 0);
+    }
+    for (i = 0; i < NTHREADS; i++)
+    {
+        mu_check(pthread_join(producers[i], NULL) == 0);
+        mu_check(pthread_join(consumers[i], &misordered) == 0);
+        nmisordered += (size_t) misordered;
+    }
+
+    mu_check(nmisordered == 0);
+    for (i = 0; i < NTHREADS * NITEMS_PER_THREAD; i++)
+    {
+        mu_check(seen[i] == 1);
+    }
+    mu_check(cadtmpmcqueue_nelems(size_4) == 0);
+}
+
+MU_TEST_SUITE(test_suite)
+{
+	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+	MU_RUN_TEST(test_mpmc_queue_type);
+	MU_RUN_TEST(test_enqueue_dequeue);
+	MU_RUN_TEST(test_threads);
+}
+
+int main(int argc, char *argv[])
+{
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+
+	return MU_EXIT_CODE;
+}
+
+static void *producer(void *arg)
+{
+    size_t id = *(size_t *) arg;
+    size_t i;
+
+    for (i = id * NITEMS_PER_THREAD; i < (id + 1) * NITEMS_PER_THREAD; i++)
+    {
+        items[i] = i;
+        while (cadtmpmcqueue_enqueue(size_4, &items[i]) == NULL)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    size_t last[NTHREADS] = { 0 };
+    size_t nmisordered = 0;
+
+    (void) arg;
+    while (__atomic_load_n(&nconsumed, __ATOMIC_RELAXED) < NTHREADS * NITEMS_PER_THREAD)
+    {
+        size_t *item = cadtmpmcqueue_dequeue(size_4);
+        size_t producer_id;
+
+        if (item == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        /* Each consumer sees the items of one producer in increasing order */
+        producer_id = *item / NITEMS_PER_THREAD;
+        if (*item + 1 <= last[producer_id])
+        {
+            nmisordered++;
+        }
+        last[producer_id] = *item + 1;
+        __atomic_fetch_add(&seen[*item], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&nconsumed, 1, __ATOMIC_RELAXED);
+    }
+    return (void *) nmisordered;
+}
@@ -1,3 +1,4 @@
+#define CADT_STATS
 #include "minunit.h"
 #include "../src/queue_adt.c"
 
@@ -246,7 +247,7 @@ MU_TEST(test_shift_elements)
 }
 
 /*
- * Test whether `resize_contents_array` correctly doubles contents array. 
+ * Test whether `resize_contents_to` correctly doubles contents array. 
  * Depends on a correct implementation of the `shift_elements` function.
  */
 MU_TEST(test_double_contents_size)
@@ -261,7 +262,7 @@ MU_TEST(test_double_contents_size)
     mu_check(!is_fix(size_3));
 
     /* Double the size */
-    mu_check(resize_contents_array(size_3, 2.0) != NULL);
+    mu_check(resize_contents_to(size_3, size_3->curr_max_size * 2) != NULL);
 
     /* Check new internals:
      * 
@@ -280,7 +281,7 @@ MU_TEST(test_double_contents_size)
 }
 
 /*
- * Test whether `resize_contents_array` correctly halves contents array. 
+ * Test whether `resize_contents_to` correctly halves contents array. 
  * Depends on a correct implementation of the `shift_elements` function.
  */
 MU_TEST(test_halve_content_size)
@@ -294,7 +295,7 @@ MU_TEST(test_halve_content_size)
      */
     size_48->min_size = 3;
 
-    mu_check(resize_contents_array(size_48, 0.5) != NULL);
+    mu_check(resize_contents_to(size_48, size_48->curr_max_size / 2) != NULL);
     /* 
      * Queue should be now: | h | i | j | k | l | m | n | ...|
      *                      | hd|   |   |   |   |   |   | ...|
@@ -333,6 +334,289 @@ MU_TEST(test_halve_content_size)
      * operation is done after the resizing takes place */
 }
 
+/*
+ * Tests power of two queues: rounding, masked wrap-around of the counters, and
+ * resizing in both directions.
+ */
+MU_TEST(test_pow2)
+{
+    QueueADT *fix, *dyn;
+    Element *new;
+    size_t i;
+
+    errno = 0;
+    mu_check(cadtqueue_new_pow2(0) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtqueue_new_circular_pow2(SIZE_MAX) == NULL);
+    mu_check(errno == EINVAL);
+
+    fix = cadtqueue_new_circular_pow2(3);
+    mu_check(fix->curr_max_size == 4);
+    mu_check(fix->is_fix && fix->is_pow2);
+
+    /* Go around the ring a few times, counters keep increasing */
+    for (i = 0; i < 4; i++)
+    {
+        mu_check(cadtqueue_enqueue(fix, "a") != NULL);
+    }
+    errno = 0;
+    mu_check(cadtqueue_enqueue(fix, "x") == NULL);
+    mu_check(errno == EPERM);
+    for (i = 0; i < 10; i++)
+    {
+        mu_assert_string_eq(i < 4 ? "a" : "b", cadtqueue_dequeue(fix));
+        mu_check(cadtqueue_enqueue(fix, "b") != NULL);
+    }
+    mu_check(fix->head == 10);
+    mu_check(fix->tail == 14);
+    mu_check(cadtqueue_nelems(fix) == 4);
+    mu_assert_string_eq("b", cadtqueue_peek_first(fix));
+    mu_assert_string_eq("b", cadtqueue_peek_rear(fix));
+
+    /* First item at index 2, the run wraps after two items */
+    fix->contents[2] = "h";
+    fix->contents[3] = "i";
+    fix->contents[0] = "j";
+    fix->contents[1] = "k";
+    new = malloc(4 * sizeof(Element));
+    if (new == NULL)
+    {
+        perror("malloc failed allocating Element array: ");
+        exit(EXIT_FAILURE);
+    }
+    shift_elements(fix, new);
+    mu_assert_string_eq(new[0], "h");
+    mu_assert_string_eq(new[1], "i");
+    mu_assert_string_eq(new[2], "j");
+    mu_assert_string_eq(new[3], "k");
+    free(new);
+    mu_assert_string_eq("h", cadtqueue_peek_first(fix));
+    mu_assert_string_eq("k", cadtqueue_peek_rear(fix));
+    cadtqueue_destroy(fix);
+
+    dyn = cadtqueue_new_pow2(2);
+    mu_check(cadtqueue_dequeue(dyn) == NULL);
+    cadtqueue_enqueue(dyn, "a");
+    cadtqueue_enqueue(dyn, "b");
+    cadtqueue_dequeue(dyn);
+    cadtqueue_enqueue(dyn, "c");
+    /* Full and wrapped, grows to 4 then 8 */
+    cadtqueue_enqueue(dyn, "d");
+    mu_check(dyn->curr_max_size == 4);
+    mu_check(dyn->head == 0);
+    mu_check(dyn->tail == 3);
+    cadtqueue_enqueue(dyn, "e");
+    cadtqueue_enqueue(dyn, "f");
+    mu_check(dyn->curr_max_size == 8);
+    mu_check(cadtqueue_nelems(dyn) == 5);
+    mu_assert_string_eq("b", cadtqueue_peek_first(dyn));
+    mu_assert_string_eq("f", cadtqueue_peek_rear(dyn));
+
+    mu_assert_string_eq("b", cadtqueue_dequeue(dyn));
+    mu_assert_string_eq("c", cadtqueue_dequeue(dyn));
+    mu_assert_string_eq("d", cadtqueue_dequeue(dyn));
+    mu_assert_string_eq("e", cadtqueue_dequeue(dyn));
+    /* Usage under 25% before dequeueing, halves to 4 */
+    mu_assert_string_eq("f", cadtqueue_dequeue(dyn));
+    mu_check(dyn->curr_max_size == 4);
+    mu_check(cadtqueue_nelems(dyn) == 0);
+    cadtqueue_destroy(dyn);
+}
+
+/*
+ * Testing bulk enqueue and dequeue, across the wrap-around point and with a
+ * single resize per batch.
+ */
+MU_TEST(test_bulk)
+{
+    Element src[8] = { "a", "b", "c", "d", "e", "f", "g", "h" };
+    Element dst[8];
+    QueueADT *fix, *dyn, *pow2;
+    size_t i;
+
+    fix = cadtqueue_new_circular(5);
+    errno = 0;
+    mu_check(cadtqueue_enqueue_n(fix, NULL, 2) == 0);
+    mu_check(errno == EINVAL);
+    mu_check(cadtqueue_enqueue_n(fix, src, 0) == 0);
+    errno = 0;
+    mu_check(cadtqueue_dequeue_n(fix, dst, 2) == 0);
+    mu_check(errno == EPERM);
+
+    /* Only as many as fit */
+    mu_check(cadtqueue_enqueue_n(fix, src, 3) == 3);
+    mu_check(cadtqueue_dequeue_n(fix, dst, 2) == 2);
+    mu_assert_string_eq("a", dst[0]);
+    mu_assert_string_eq("b", dst[1]);
+    mu_check(cadtqueue_enqueue_n(fix, &src[3], 5) == 4);
+    mu_check(cadtqueue_nelems(fix) == 5);
+    mu_check(fix->head == 2);
+    mu_check(fix->tail == 1);
+    errno = 0;
+    mu_check(cadtqueue_enqueue_n(fix, src, 1) == 0);
+    mu_check(errno == EPERM);
+    mu_assert_string_eq("c", cadtqueue_peek_first(fix));
+    mu_assert_string_eq("g", cadtqueue_peek_rear(fix));
+
+    /* Dequeue more than held, the run wraps */
+    mu_check(cadtqueue_dequeue_n(fix, dst, 8) == 5);
+    for (i = 0; i < 5; i++)
+    {
+        mu_assert_string_eq(src[i + 2], dst[i]);
+    }
+    mu_check(cadtqueue_nelems(fix) == 0);
+    mu_check(fix->head == fix->tail);
+    mu_assert_string_eq("a", cadtqueue_enqueue(fix, "a"));
+    mu_assert_string_eq("a", cadtqueue_peek_rear(fix));
+    cadtqueue_destroy(fix);
+
+    /* Grows once from 2 to 8, shrinks once to 4 */
+    dyn = cadtqueue_new(2);
+    cadtqueue_enqueue(dyn, "x");
+    mu_check(cadtqueue_enqueue_n(dyn, src, 6) == 6);
+    mu_check(dyn->curr_max_size == 8);
+    mu_check(cadtqueue_nelems(dyn) == 7);
+    mu_assert_string_eq("x", cadtqueue_dequeue(dyn));
+    mu_check(cadtqueue_dequeue_n(dyn, dst, 5) == 5);
+    mu_check(dyn->curr_max_size == 4);
+    mu_check(cadtqueue_nelems(dyn) == 1);
+    mu_assert_string_eq("f", cadtqueue_peek_first(dyn));
+    mu_assert_string_eq("f", cadtqueue_peek_rear(dyn));
+    mu_check(cadtqueue_dequeue_n(dyn, dst, 1) == 1);
+    mu_assert_string_eq("f", dst[0]);
+    cadtqueue_destroy(dyn);
+
+    /* Counters keep increasing across the batches */
+    pow2 = cadtqueue_new_circular_pow2(4);
+    for (i = 0; i < 5; i++)
+    {
+        mu_check(cadtqueue_enqueue_n(pow2, &src[i], 3) == 3);
+        mu_check(cadtqueue_dequeue_n(pow2, dst, 3) == 3);
+        mu_assert_string_eq(src[i], dst[0]);
+        mu_assert_string_eq(src[i + 2], dst[2]);
+    }
+    mu_check(pow2->head == 15);
+    mu_check(pow2->tail == 15);
+    mu_check(cadtqueue_enqueue_n(pow2, src, 8) == 4);
+    mu_assert_string_eq("a", cadtqueue_peek_first(pow2));
+    mu_assert_string_eq("d", cadtqueue_peek_rear(pow2));
+    cadtqueue_destroy(pow2);
+}
+
+/*
+ * Testing a custom policy: a smaller growth factor, a floor rounded up in 
+ * power of two mode, no reallocation while usage oscillates, and lazy trims.
+ */
+MU_TEST(test_policy)
+{
+    ResizePolicy bad = { 2.0, 0.5, 0, 0 };
+    ResizePolicy slow = { 1.5, 0.25, 0, 0 };
+    ResizePolicy lazy = { 2.0, 0.25, 3, 1 };
+    QueueADT *dyn, *pow2;
+    int i;
+
+    dyn = cadtqueue_new(4);
+    errno = 0;
+    mu_check(cadtqueue_set_policy(dyn, &bad) == NULL);
+    mu_check(errno == EINVAL);
+
+    /* Grows by half its size */
+    mu_check(cadtqueue_set_policy(dyn, &slow) == dyn);
+    for (i = 0; i < 7; i++)
+    {
+        cadtqueue_enqueue(dyn, "x");
+    }
+    mu_check(dyn->curr_max_size == 9);
+
+    /* Oscillating around the growth threshold keeps the size */
+    for (i = 0; i < 100; i++)
+    {
+        cadtqueue_enqueue(dyn, "x");
+        cadtqueue_dequeue(dyn);
+        mu_check(dyn->curr_max_size == 9);
+    }
+    while (cadtqueue_nelems(dyn) > 0)
+    {
+        cadtqueue_dequeue(dyn);
+    }
+    mu_check(dyn->curr_max_size == 4);
+    /* At its floor, dequeues never shrink it */
+    mu_check(dyn->shrink_at == 0);
+    cadtqueue_destroy(dyn);
+
+    /* The floor is rounded up to a power of two, lazy only shrinks on trim */
+    pow2 = cadtqueue_new_pow2(2);
+    mu_check(cadtqueue_set_policy(pow2, &lazy) == pow2);
+    mu_check(pow2->policy.min_size == 4);
+    for (i = 0; i < 20; i++)
+    {
+        cadtqueue_enqueue(pow2, "x");
+    }
+    mu_check(pow2->curr_max_size == 32);
+    mu_check(cadtqueue_dequeue_n(pow2, NULL, 0) == 0);
+    for (i = 0; i < 19; i++)
+    {
+        cadtqueue_dequeue(pow2);
+    }
+    mu_check(pow2->curr_max_size == 32);
+    mu_check(cadtqueue_trim(pow2) == pow2);
+    mu_check(pow2->curr_max_size == 4);
+    mu_check(cadtqueue_nelems(pow2) == 1);
+    cadtqueue_destroy(pow2);
+
+    /* A circular queue keeps its size on clear, whatever the floor */
+    slow.min_size = 1;
+    mu_check(cadtqueue_set_policy(size_3_fix, &slow) == size_3_fix);
+    cadtqueue_enqueue(size_3_fix, "x");
+    mu_check(cadtqueue_clear(size_3_fix) == size_3_fix);
+    mu_check(size_3_fix->curr_max_size == 3);
+    mu_check(cadtqueue_nelems(size_3_fix) == 0);
+}
+
+/*
+ * Testing the statistics count every resize and the elements they moved.
+ */
+MU_TEST(test_stats)
+{
+    QueueADT *q = cadtqueue_new(3);
+    Element batch[16];
+    ContainerStats stats;
+    int i;
+
+    for (i = 0; i < 10; i++)
+    {
+        cadtqueue_enqueue(q, "x");
+    }
+    stats = cadtqueue_stats(q);
+    mu_check(stats.nelems == 10);
+    mu_check(stats.capacity == 12);
+    mu_check(stats.high_water == 10);
+    mu_check(stats.ngrows == 2);
+    mu_check(stats.bytes_copied == (3 + 6) * sizeof(Element));
+
+    /* A batch grows once, and counts as many elements */
+    for (i = 0; i < 16; i++)
+    {
+        batch[i] = "y";
+    }
+    mu_check(cadtqueue_enqueue_n(q, batch, 16) == 16);
+    stats = cadtqueue_stats(q);
+    mu_check(stats.high_water == 26);
+    mu_check(stats.ngrows == 3);
+    mu_check(stats.bytes_copied == (3 + 6 + 10) * sizeof(Element));
+
+    while (cadtqueue_nelems(q) > 0)
+    {
+        cadtqueue_dequeue(q);
+    }
+    stats = cadtqueue_stats(q);
+    mu_check(stats.nshrinks > 0);
+    mu_check(stats.capacity < 48);
+    mu_check(stats.high_water == 26);
+    cadtqueue_destroy(q);
+}
+
 MU_TEST_SUITE(test_suite) 
 {
 	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
@@ -343,6 +627,10 @@ MU_TEST_SUITE(test_suite)
     MU_RUN_TEST(test_shift_elements);
     MU_RUN_TEST(test_double_contents_size);
     MU_RUN_TEST(test_halve_content_size);
+    MU_RUN_TEST(test_pow2);
+    MU_RUN_TEST(test_bulk);
+    MU_RUN_TEST(test_policy);
+    MU_RUN_TEST(test_stats);
 }
 
 int main(int argc, char *argv[]) 
@@ -0,0 +1,154 @@
+#include "minunit.h"
+#include "../src/spscqueue_adt.c"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define NITEMS 100000
+
+static SPSCQueueADT *size_3, *size_1;
+static char* elements[4] = { "Lorem", "ipsum", "dolor", "sit" };
+
+/*
+ * Hands `NITEMS` consecutive integers to the consumer through `size_3`.
+ */
+static void *producer(void *arg);
+
+void test_setup(void)
+{
+    size_3 = cadtspscqueue_new(3);
+    size_1 = cadtspscqueue_new(1);
+    return;
+}
+
+void test_teardown(void)
+{
+    cadtspscqueue_destroy(size_3);
+    cadtspscqueue_destroy(size_1);
+    return;
+}
+
+/*
+ * Testing `spsc_queue_type` creation goes smoothly, and its layout.
+ */
+MU_TEST(test_spsc_queue_type)
+{
+    errno = 0;
+    mu_assert(cadtspscqueue_new(0) == NULL,
+            "Zero size queues should not be allowed");
+    mu_check(errno == EINVAL);
+
+    mu_check(size_3->nslots == 4);
+    mu_check(size_3->head == 0);
+    mu_check(size_3->tail == 0);
+    mu_check(size_1->nslots == 2);
+
+    /* Each side's indexes on a cache line of its own */
+    mu_check((size_t) size_3 % CACHE_LINE_SIZE == 0);
+    mu_check(offsetof(struct spsc_queue_type, head) == CACHE_LINE_SIZE);
+    mu_check(offsetof(struct spsc_queue_type, tail) == 2 * CACHE_LINE_SIZE);
+}
+
+/*
+ * Testing overflow, underflow and wrap-around from a single thread.
+ */
+MU_TEST(test_enqueue_dequeue)
+{
+    size_t i;
+
+    errno = 0;
+    mu_check(cadtspscqueue_dequeue(size_3) == NULL);
+    mu_check(errno == EPERM);
+
+    mu_assert_string_eq("Lorem", cadtspscqueue_enqueue(size_3, elements[0]));
+    mu_assert_string_eq("ipsum", cadtspscqueue_enqueue(size_3, elements[1]));
+    mu_assert_string_eq("dolor", cadtspscqueue_enqueue(size_3, elements[2]));
+    mu_check(cadtspscqueue_nelems(size_3) == 3);
+
+    errno = 0;
+    mu_check(cadtspscqueue_enqueue(size_3, elements[3]) == NULL);
+    mu_check(errno == EPERM);
+
+    mu_assert_string_eq("Lorem", cadtspscqueue_dequeue(size_3));
+    mu_assert_string_eq("sit", cadtspscqueue_enqueue(size_3, elements[3]));
+    mu_check(size_3->tail == 0);
+    mu_check(cadtspscqueue_nelems(size_3) == 3);
+
+    mu_assert_string_eq("ipsum", cadtspscqueue_dequeue(size_3));
+    mu_assert_string_eq("dolor", cadtspscqueue_dequeue(size_3));
+    mu_assert_string_eq("sit", cadtspscqueue_dequeue(size_3));
+    mu_check(cadtspscqueue_nelems(size_3) == 0);
+    errno = 0;
+    mu_check(cadtspscqueue_dequeue(size_3) == NULL);
+    mu_check(errno == EPERM);
+
+    for (i = 0; i < 10; i++)
+    {
+        mu_assert_string_eq("Lorem", cadtspscqueue_enqueue(size_1, elements[0]));
+        mu_check(cadtspscqueue_enqueue(size_1, elements[1]) == NULL);
+        mu_assert_string_eq("Lorem", cadtspscqueue_dequeue(size_1));
+        mu_check(cadtspscqueue_dequeue(size_1) == NULL);
+    }
+}
+
+/*
+ * Testing items cross from one thread to another in order, none lost.
+ */
+MU_TEST(test_threads)
+{
+    static size_t items[NITEMS];
+    pthread_t thread;
+    size_t i = 0;
+
+    mu_check(pthread_create(&thread, NULL, producer, items) == 0);
+    while (i < NITEMS)
+    {
+        size_t *item = cadtspscqueue_dequeue(size_3);
+
+        if (item == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        if (*item != i || item != &items[i])
+        {
+            break;
+        }
+        i++;
+    }
+    mu_check(pthread_join(thread, NULL) == 0);
+    mu_check(i == NITEMS);
+    mu_check(cadtspscqueue_nelems(size_3) == 0);
+}
+
+MU_TEST_SUITE(test_suite)
+{
+	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+	MU_RUN_TEST(test_spsc_queue_type);
+	MU_RUN_TEST(test_enqueue_dequeue);
+	MU_RUN_TEST(test_threads);
+}
+
+int main(int argc, char *argv[])
+{
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+
+	return MU_EXIT_CODE;
+}
+
+static void *producer(void *arg)
+{
+    size_t *items = arg;
+    size_t i;
+
+    for (i = 0; i < NITEMS; i++)
+    {
+        items[i] = i;
+        while (cadtspscqueue_enqueue(size_3, &items[i]) == NULL)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
@@ -1,8 +1,28 @@
+#define CADT_STATS
 #include "minunit.h"
 #include "../src/stack_adt.c"
 
 static StackADT *s0, *s1, *s2, *s3;
 
+/*
+ * Bytes an allocator hands out and takes back, and whether it should fail.
+ */
+struct counter
+{
+    size_t nbytes;
+    size_t ncalls;
+    int fail;
+};
+
+/*
+ * Allocation functions keeping track of the bytes in use in the `struct
+ * counter` pointed to by `ctx`, from the sizes the stack passes.
+ */
+static void *counting_alloc(void *ctx, size_t size);
+static void *counting_realloc(void *ctx, void *ptr, size_t old_size,
+                              size_t new_size);
+static void counting_free(void *ctx, void *ptr, size_t size);
+
 void test_setup(void)
 {
     s0 = cadtstack_new_fix(1);
@@ -128,6 +148,281 @@ MU_TEST(test_size_halves_on_clear)
     mu_check(s1->curr_max_size == s1->min_size);
 }
 
+/*
+ * Testing a custom policy: the floor is kept, usage oscillating between both
+ * thresholds never reallocates, and a lazy stack only shrinks on trim.
+ */
+MU_TEST(test_policy)
+{
+    ResizePolicy bad = { 1.0, 0.25, 0, 0 };
+    ResizePolicy hyst = { 2.0, 0.25, 4, 0 };
+    ResizePolicy lazy = { 2.0, 0.25, 0, 1 };
+    int i;
+
+    errno = 0;
+    mu_check(cadtstack_set_policy(s1, &bad) == NULL);
+    mu_check(errno == EINVAL);
+    bad.growth = 4.0;
+    mu_check(cadtstack_set_policy(s1, &bad) == NULL);
+    mu_check(s1->policy.growth == 2.0);
+
+    /* Never below the policy's floor */
+    mu_check(cadtstack_set_policy(s1, &hyst) == s1);
+    for (i = 0; i < 16; i++)
+    {
+        cadtstack_push(s1, "Data");
+    }
+    mu_check(s1->curr_max_size == 16);
+    while (cadtstack_nelems(s1) > 0)
+    {
+        cadtstack_pop(s1);
+    }
+    mu_check(s1->curr_max_size == 4);
+    /* At its floor, pops never shrink it */
+    mu_check(s1->shrink_at == 0);
+
+    /* Oscillating around the growth threshold keeps the size */
+    for (i = 0; i < 5; i++)
+    {
+        cadtstack_push(s1, "Data");
+    }
+    mu_check(s1->curr_max_size == 8);
+    for (i = 0; i < 100; i++)
+    {
+        cadtstack_pop(s1);
+        cadtstack_push(s1, "Data");
+        mu_check(s1->curr_max_size == 8);
+    }
+
+    /* Lazy stacks keep their size until trimmed */
+    mu_check(cadtstack_set_policy(s3, &lazy) == s3);
+    for (i = 0; i < 40; i++)
+    {
+        cadtstack_push(s3, "Data");
+    }
+    mu_check(s3->curr_max_size == 40);
+    for (i = 0; i < 38; i++)
+    {
+        cadtstack_pop(s3);
+    }
+    mu_check(cadtstack_clear(s3) == s3);
+    mu_check(s3->curr_max_size == 40);
+    cadtstack_push(s3, "Data");
+    mu_check(cadtstack_trim(s3) == s3);
+    mu_check(s3->curr_max_size == 5);
+    mu_check(cadtstack_nelems(s3) == 1);
+    mu_check(cadtstack_set_policy(s3, NULL) == s3);
+    mu_check(s3->policy.lazy == 0);
+
+    /* A fixed-size stack keeps its size on clear, whatever the floor */
+    mu_check(cadtstack_set_policy(s2, &hyst) == s2);
+    cadtstack_push(s2, "Data");
+    mu_check(cadtstack_clear(s2) == s2);
+    mu_check(s2->curr_max_size == 5);
+    mu_check(cadtstack_nelems(s2) == 0);
+}
+
+/*
+ * Testing a segmented stack links segments without moving elements, and
+ * keeps one spare segment across a boundary.
+ */
+MU_TEST(test_segmented)
+{
+    StackADT *seg;
+    Element *slot;
+    StackSegment *spare;
+    char *items[10] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9" };
+    int i;
+
+    errno = 0;
+    mu_check(cadtstack_new_segmented(0) == NULL);
+    mu_check(errno == EINVAL);
+
+    seg = cadtstack_new_segmented(4);
+    mu_check(seg->is_seg == 1);
+    mu_check(seg->curr_max_size == 4);
+    for (i = 0; i < 5; i++)
+    {
+        mu_check(cadtstack_push(seg, items[i]) == items[i]);
+    }
+    slot = &seg->seg->slots[0];
+    for (i = 5; i < 10; i++)
+    {
+        cadtstack_push(seg, items[i]);
+    }
+    mu_check(seg->curr_max_size == 12);
+    mu_check(seg->base == 8);
+    mu_check(cadtstack_nelems(seg) == 10);
+    /* The second segment's first slot still holds item 4 */
+    mu_check(slot == &seg->seg->prev->slots[0]);
+    mu_assert_string_eq("4", *slot);
+
+    /* The emptied segment is left at the next pop, and kept spare */
+    mu_assert_string_eq("9", cadtstack_pop(seg));
+    mu_assert_string_eq("8", cadtstack_pop(seg));
+    mu_check(seg->base == 8);
+    mu_check(seg->spare == NULL);
+    mu_assert_string_eq("7", cadtstack_pop(seg));
+    mu_check(seg->base == 4);
+    spare = seg->spare;
+    mu_check(spare != NULL);
+
+    /* Going up and down across the boundary reuses the spare */
+    for (i = 0; i < 100; i++)
+    {
+        cadtstack_push(seg, items[7]);
+        cadtstack_push(seg, items[8]);
+        mu_check(seg->seg == spare || seg->spare == spare);
+        cadtstack_pop(seg);
+        cadtstack_pop(seg);
+    }
+    mu_check(cadtstack_nelems(seg) == 7);
+    for (i = 6; i >= 0; i--)
+    {
+        mu_assert_string_eq(items[i], cadtstack_pop(seg));
+    }
+    errno = 0;
+    mu_check(cadtstack_pop(seg) == NULL);
+    mu_check(errno == EPERM);
+    mu_check(seg->base == 0);
+
+    /* Clear keeps the bottom segment, trim frees the spare */
+    for (i = 0; i < 10; i++)
+    {
+        cadtstack_push(seg, items[i]);
+    }
+    mu_check(cadtstack_clear(seg) == seg);
+    mu_check(cadtstack_nelems(seg) == 0);
+    mu_check(seg->curr_max_size == 4);
+    mu_check(seg->seg->prev == NULL);
+    mu_check(seg->spare != NULL);
+    mu_check(cadtstack_trim(seg) == seg);
+    mu_check(seg->spare == NULL);
+    cadtstack_push(seg, items[0]);
+    mu_assert_string_eq("0", cadtstack_pop(seg));
+    cadtstack_destroy(seg);
+}
+
+/*
+ * Testing every block of a stack goes through its allocator, with the sizes it
+ * was allocated with.
+ */
+MU_TEST(test_allocator)
+{
+    struct counter c = { 0, 0, 0 };
+    Allocator a = { counting_alloc, counting_realloc, counting_free, &c };
+    Allocator incomplete = { counting_alloc, NULL, counting_free, &c };
+    StackADT *s;
+    int i;
+
+    errno = 0;
+    mu_check(cadtstack_new_with_allocator(4, NULL) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(cadtstack_new_with_allocator(4, &incomplete) == NULL);
+    mu_check(errno == EINVAL);
+    mu_check(c.ncalls == 0);
+
+    s = cadtstack_new_with_allocator(4, &a);
+    mu_check(s != NULL);
+    mu_check(c.nbytes == sizeof(struct stack_type) + 4 * sizeof(Element));
+
+    /* Grows and shrinks through the allocator */
+    for (i = 0; i < 100; i++)
+    {
+        cadtstack_push(s, s1);
+    }
+    mu_check(c.nbytes == sizeof(struct stack_type) 
+                         + s->curr_max_size * sizeof(Element));
+    for (i = 0; i < 99; i++)
+    {
+        cadtstack_pop(s);
+    }
+    mu_check(c.nbytes == sizeof(struct stack_type) 
+                         + s->curr_max_size * sizeof(Element));
+
+    /* A failing allocator leaves the stack as it was, with `ENOMEM` */
+    while (!is_full(s))
+    {
+        cadtstack_push(s, s1);
+    }
+    c.fail = 1;
+    errno = 0;
+    mu_check(cadtstack_push(s, s1) == NULL);
+    mu_check(errno == ENOMEM);
+    mu_check(cadtstack_nelems(s) == s->curr_max_size);
+    c.fail = 0;
+
+    mu_check(cadtstack_clear(s) == s);
+    mu_check(c.nbytes == sizeof(struct stack_type) + 4 * sizeof(Element));
+    cadtstack_destroy(s);
+    mu_check(c.nbytes == 0);
+
+    /* Segmented stacks link and unlink their segments through it too */
+    errno = 0;
+    mu_check(cadtstack_new_segmented_with_allocator(4, &incomplete) == NULL);
+    mu_check(errno == EINVAL);
+    s = cadtstack_new_segmented_with_allocator(4, &a);
+    mu_check(s != NULL);
+    mu_check(c.nbytes == sizeof(struct stack_type) + segment_bytes(s));
+    for (i = 0; i < 10; i++)
+    {
+        cadtstack_push(s, s1);
+    }
+    mu_check(c.nbytes == sizeof(struct stack_type) + 3 * segment_bytes(s));
+    cadtstack_destroy(s);
+    mu_check(c.nbytes == 0);
+}
+
+/*
+ * Testing the statistics count every resize, and only those.
+ */
+MU_TEST(test_stats)
+{
+    StackADT *s = cadtstack_new(4);
+    StackADT *seg = cadtstack_new_segmented(4);
+    ContainerStats stats;
+    int i;
+
+    for (i = 0; i < 20; i++)
+    {
+        cadtstack_push(s, s1);
+        cadtstack_push(seg, s1);
+    }
+    stats = cadtstack_stats(s);
+    mu_check(stats.nelems == 20);
+    mu_check(stats.capacity == 32);
+    mu_check(stats.high_water == 20);
+    mu_check(stats.ngrows == 3);
+    mu_check(stats.nshrinks == 0);
+    mu_check(stats.bytes_copied == (4 + 8 + 16) * sizeof(Element));
+
+    for (i = 0; i < 20; i++)
+    {
+        cadtstack_pop(s);
+    }
+    stats = cadtstack_stats(s);
+    mu_check(stats.nelems == 0);
+    mu_check(stats.high_water == 20);
+    mu_check(stats.nshrinks == 3);
+    mu_check(stats.capacity == 4);
+
+    /* Segments are linked, never copied */
+    stats = cadtstack_stats(seg);
+    mu_check(stats.ngrows == 4);
+    mu_check(stats.bytes_copied == 0);
+    cadtstack_clear(seg);
+    mu_check(cadtstack_stats(seg).nshrinks == 4);
+
+    /* A fixed-size stack counts its high-water mark only */
+    cadtstack_push(s2, s1);
+    mu_check(cadtstack_stats(s2).high_water == 1);
+    mu_check(cadtstack_stats(s2).ngrows == 0);
+
+    cadtstack_destroy(s);
+    cadtstack_destroy(seg);
+}
+
 MU_TEST_SUITE(test_suite) 
 {
 	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
@@ -136,6 +431,10 @@ MU_TEST_SUITE(test_suite)
 	MU_RUN_TEST(test_size_doubles_on_push);
 	MU_RUN_TEST(test_size_halves_on_pop);
 	MU_RUN_TEST(test_size_halves_on_clear);
+	MU_RUN_TEST(test_policy);
+	MU_RUN_TEST(test_segmented);
+	MU_RUN_TEST(test_allocator);
+	MU_RUN_TEST(test_stats);
 }
 
 int main(int argc, char *argv[]) 
@@ -145,3 +444,40 @@ int main(int argc, char *argv[])
 
 	return MU_EXIT_CODE;
 }
+
+static void *counting_alloc(void *ctx, size_t size)
+{
+    struct counter *c = ctx;
+
+    c->ncalls++;
+    if (c->fail)
+    {
+        return NULL;
+    }
+    c->nbytes += size;
+    return malloc(size);
+}
+
+static void *counting_realloc(void *ctx, void *ptr, size_t old_size,
+                              size_t new_size)
+{
+    struct counter *c = ctx;
+    void *p;
+
+    c->ncalls++;
+    if (c->fail || (p = realloc(ptr, new_size)) == NULL)
+    {
+        return NULL;
+    }
+    c->nbytes = c->nbytes - old_size + new_size;
+    return p;
+}
+
+static void counting_free(void *ctx, void *ptr, size_t size)
+{
+    struct counter *c = ctx;
+
+    c->ncalls++;
+    c->nbytes -= size;
+    free(ptr);
+}
@@ -0,0 +1,226 @@
+#include "minunit.h"
+#include "../include/typed_adt.h"
+
+#define NITEMS 1000
+
+/* A 16-byte value */
+typedef struct point
+{
+    double x;
+    double y;
+} Point;
+
+static size_t hash_u32(const uint32_t *key)
+{
+    return *key;
+}
+
+static int eq_u32(const uint32_t *a, const uint32_t *b)
+{
+    return *a == *b;
+}
+
+/* Sends every key to slot zero, so that all of them share one probe run */
+static size_t hash_collide(const uint32_t *key)
+{
+    (void) key;
+    return 0;
+}
+
+CADT_STACK_DEFINE(PointStack, Point);
+CADT_QUEUE_DEFINE(U32Queue, uint32_t);
+CADT_HASHTABLE_DEFINE(U32Map, uint32_t, Point, hash_u32, eq_u32);
+CADT_HASHTABLE_DEFINE(CollidingMap, uint32_t, uint32_t, hash_collide, eq_u32);
+
+static PointStack *s;
+static U32Queue *q;
+static U32Map *ht;
+
+void test_setup(void)
+{
+    s = PointStack_new(2);
+    q = U32Queue_new(3);
+    ht = U32Map_new(4);
+    return;
+}
+
+void test_teardown(void)
+{
+    PointStack_destroy(s);
+    U32Queue_destroy(q);
+    U32Map_destroy(ht);
+    return;
+}
+
+MU_TEST(test_new)
+{
+    errno = 0;
+    mu_check(PointStack_new(0) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(U32Queue_new(0) == NULL);
+    mu_check(errno == EINVAL);
+    errno = 0;
+    mu_check(U32Map_new(0) == NULL);
+    mu_check(errno == EINVAL);
+
+    /* Rounded up to a power of two */
+    mu_check(q->size == 4);
+}
+
+MU_TEST(test_stack)
+{
+    Point p;
+    size_t i;
+
+    /* Underflow */
+    errno = 0;
+    mu_check(PointStack_pop(s) == NULL);
+    mu_check(errno == EPERM);
+    mu_check(PointStack_peek(s) == NULL);
+
+    for (i = 0; i < NITEMS; i++)
+    {
+        p.x = (double) i;
+        p.y = -(double) i;
+        mu_check(PointStack_push(s, p)->x == (double) i);
+    }
+    mu_check(PointStack_nelems(s) == NITEMS);
+    mu_check(s->size == 1024);
+    mu_check(PointStack_peek(s)->y == -(double) (NITEMS - 1));
+
+    for (i = NITEMS; i > 0; i--)
+    {
+        p = *PointStack_pop(s);
+        mu_check(p.x == (double) (i - 1) && p.y == -(double) (i - 1));
+    }
+    mu_check(PointStack_nelems(s) == 0);
+    /* Shrunk back, never below its initial size */
+    mu_check(s->size == 2);
+}
+
+MU_TEST(test_queue)
+{
+    uint32_t i;
+
+    errno = 0;
+    mu_check(U32Queue_dequeue(q) == NULL);
+    mu_check(errno == EPERM);
+    mu_check(U32Queue_peek_first(q) == NULL);
+
+    /* Wraps around before growing, so that the resize unwraps the ring */
+    mu_check(*U32Queue_enqueue(q, 0) == 0);
+    mu_check(*U32Queue_enqueue(q, 1) == 1);
+    mu_check(*U32Queue_dequeue(q) == 0);
+    for (i = 2; i < NITEMS; i++)
+    {
+        mu_check(*U32Queue_enqueue(q, i) == i);
+    }
+    mu_check(U32Queue_nelems(q) == NITEMS - 1);
+    mu_check(*U32Queue_peek_first(q) == 1);
+
+    for (i = 1; i < NITEMS; i++)
+    {
+        mu_check(*U32Queue_dequeue(q) == i);
+    }
+    mu_check(U32Queue_nelems(q) == 0);
+    mu_check(q->size == 4);
+}
+
+MU_TEST(test_hashtable)
+{
+    Point p, out;
+    uint32_t i;
+
+    for (i = 0; i < NITEMS; i++)
+    {
+        p.x = (double) i;
+        p.y = (double) i * 2;
+        mu_check(U32Map_insert(ht, i * 7, p)->y == (double) i * 2);
+    }
+    mu_check(U32Map_nelems(ht) == NITEMS);
+    /* Never above a load of 3/4 */
+    mu_check(ht->nelems * 4 <= ht->capacity * 3);
+
+    /* Duplicates */
+    errno = 0;
+    mu_check(U32Map_insert(ht, 7, p) == NULL);
+    mu_check(errno == EEXIST);
+    mu_check(U32Map_nelems(ht) == NITEMS);
+
+    for (i = 0; i < NITEMS; i++)
+    {
+        mu_check(U32Map_lookup(ht, i * 7)->x == (double) i);
+        mu_check(U32Map_lookup(ht, i * 7 + 1) == NULL);
+    }
+
+    /* Deletes every other key, the rest must still be found */
+    for (i = 0; i < NITEMS; i += 2)
+    {
+        mu_check(U32Map_delete(ht, i * 7, &out) == &out);
+        mu_check(out.x == (double) i);
+        mu_check(U32Map_delete(ht, i * 7, &out) == NULL);
+    }
+    mu_check(U32Map_nelems(ht) == NITEMS / 2);
+    for (i = 0; i < NITEMS; i++)
+    {
+        mu_check((U32Map_lookup(ht, i * 7) == NULL) == (i % 2 == 0));
+    }
+
+    /* Without `out` the value is dropped, the entry still removed */
+    mu_check(U32Map_delete(ht, 7, NULL) != NULL);
+    mu_check(U32Map_lookup(ht, 7) == NULL);
+    mu_check(U32Map_delete(ht, 7, NULL) == NULL);
+    mu_check(U32Map_nelems(ht) == NITEMS / 2 - 1);
+}
+
+MU_TEST(test_hashtable_delete_shifts)
+{
+    CollidingMap *cm;
+    uint32_t i, out;
+
+    mu_check((cm = CollidingMap_new(16)) != NULL);
+    for (i = 0; i < 10; i++)
+    {
+        mu_check(*CollidingMap_insert(cm, i, i * 10) == i * 10);
+    }
+
+    /* Removing from the middle of the run must keep the tail reachable */
+    mu_check(CollidingMap_delete(cm, 3, &out) != NULL && out == 30);
+    mu_check(CollidingMap_delete(cm, 0, &out) != NULL && out == 0);
+    for (i = 0; i < 10; i++)
+    {
+        if (i == 0 || i == 3)
+        {
+            mu_check(CollidingMap_lookup(cm, i) == NULL);
+            continue;
+        }
+        mu_check(*CollidingMap_lookup(cm, i) == i * 10);
+    }
+    /* Shifted back to fill the holes, the run has no gap */
+    for (i = 0; i < 8; i++)
+    {
+        mu_check(cm->used[i]);
+    }
+    mu_check(!cm->used[8]);
+
+    CollidingMap_destroy(cm);
+}
+
+MU_TEST_SUITE(test_suite)
+{
+        MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+        MU_RUN_TEST(test_new);
+        MU_RUN_TEST(test_stack);
+        MU_RUN_TEST(test_queue);
+        MU_RUN_TEST(test_hashtable);
+        MU_RUN_TEST(test_hashtable_delete_shifts);
+}
+
+int main(int argc, char *argv[])
+{
+        MU_RUN_SUITE(test_suite);
+        MU_REPORT();
+
+        return MU_EXIT_CODE;
+}
@@ -0,0 +1,186 @@
+#include "minunit.h"
+#include "../src/wsdeque_adt.c"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define NTHIEVES 3
+#define NITEMS 100000
+
+static WSDequeADT *size_2;
+static char* elements[5] = { "Lorem", "ipsum", "dolor", "sit", "amet" };
+
+/* Items taken by each side, and how many times each item was taken */
+static size_t items[NITEMS];
+static size_t seen[NITEMS];
+static size_t ntaken;
+
+/*
+ * Steals from `size_2` until every item has been taken.
+ */
+static void *thief(void *arg);
+
+void test_setup(void)
+{
+    size_2 = cadtwsdeque_new(2);
+    return;
+}
+
+void test_teardown(void)
+{
+    cadtwsdeque_destroy(size_2);
+    return;
+}
+
+/*
+ * Testing `ws_deque_type` creation goes smoothly, and its layout.
+ */
+MU_TEST(test_ws_deque_type)
+{
+    WSDequeADT *d;
+
+    errno = 0;
+    mu_assert(cadtwsdeque_new(0) == NULL,
+            "Zero size deques should not be allowed");
+    mu_check(errno == EINVAL);
+
+    d = cadtwsdeque_new(3);
+    mu_check(d->array->size == 4);
+    mu_check(d->array->prev == NULL);
+    mu_check(d->top == 0);
+    mu_check(d->bottom == 0);
+    cadtwsdeque_destroy(d);
+
+    /* The owner's and the thieves' indexes on cache lines of their own */
+    mu_check((size_t) size_2 % CACHE_LINE_SIZE == 0);
+    mu_check(offsetof(struct ws_deque_type, top) == CACHE_LINE_SIZE);
+    mu_check(offsetof(struct ws_deque_type, bottom) == 2 * CACHE_LINE_SIZE);
+}
+
+/*
+ * Testing the owner pops the newest items, thieves steal the oldest, and
+ * growth keeps both orders across wrapped positions.
+ */
+MU_TEST(test_push_pop_steal)
+{
+    size_t i;
+
+    errno = 0;
+    mu_check(cadtwsdeque_pop(size_2) == NULL);
+    mu_check(errno == EPERM);
+    mu_check(size_2->bottom == 0);
+    errno = 0;
+    mu_check(cadtwsdeque_steal(size_2) == NULL);
+    mu_check(errno == EPERM);
+
+    /* Move the positions past the end of the array before growing */
+    cadtwsdeque_push(size_2, elements[0]);
+    mu_assert_string_eq("Lorem", cadtwsdeque_steal(size_2));
+    cadtwsdeque_push(size_2, elements[0]);
+    mu_assert_string_eq("Lorem", cadtwsdeque_steal(size_2));
+    mu_check(size_2->top == 2);
+
+    for (i = 0; i < 5; i++)
+    {
+        mu_assert_string_eq(elements[i], cadtwsdeque_push(size_2, elements[i]));
+    }
+    mu_check(size_2->array->size == 8);
+    mu_check(size_2->array->prev->size == 4);
+    mu_check(size_2->array->prev->prev->size == 2);
+    mu_check(cadtwsdeque_nelems(size_2) == 5);
+
+    mu_assert_string_eq("Lorem", cadtwsdeque_steal(size_2));
+    mu_assert_string_eq("amet", cadtwsdeque_pop(size_2));
+    mu_assert_string_eq("ipsum", cadtwsdeque_steal(size_2));
+    mu_assert_string_eq("sit", cadtwsdeque_pop(size_2));
+    mu_assert_string_eq("dolor", cadtwsdeque_pop(size_2));
+    mu_check(cadtwsdeque_nelems(size_2) == 0);
+    errno = 0;
+    mu_check(cadtwsdeque_pop(size_2) == NULL);
+    mu_check(errno == EPERM);
+    mu_check(size_2->bottom == size_2->top);
+}
+
+/*
+ * Testing every item is taken exactly once while the owner pushes and pops
+ * and several thieves steal.
+ */
+MU_TEST(test_threads)
+{
+    pthread_t thieves[NTHIEVES];
+    size_t i;
+
+    for (i = 0; i < NTHIEVES; i++)
+    {
+        mu_check(pthread_create(&thieves[i], NULL, thief, NULL) == 0);
+    }
+
+    /* Pop one item every other push, leaving the rest to thieves */
+    for (i = 0; i < NITEMS; i++)
+    {
+        size_t *item;
+
+        items[i] = i;
+        mu_check(cadtwsdeque_push(size_2, &items[i]) != NULL);
+        if (i % 2 == 1 && (item = cadtwsdeque_pop(size_2)) != NULL)
+        {
+            __atomic_fetch_add(&seen[*item], 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&ntaken, 1, __ATOMIC_RELAXED);
+        }
+    }
+    for (;;)
+    {
+        size_t *item = cadtwsdeque_pop(size_2);
+
+        if (item == NULL)
+        {
+            break;
+        }
+        __atomic_fetch_add(&seen[*item], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&ntaken, 1, __ATOMIC_RELAXED);
+    }
+
+    for (i = 0; i < NTHIEVES; i++)
+    {
+        mu_check(pthread_join(thieves[i], NULL) == 0);
+    }
+    for (i = 0; i < NITEMS; i++)
+    {
+        mu_check(seen[i] == 1);
+    }
+    mu_check(cadtwsdeque_nelems(size_2) == 0);
+}
+
+MU_TEST_SUITE(test_suite)
+{
+	MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+	MU_RUN_TEST(test_ws_deque_type);
+	MU_RUN_TEST(test_push_pop_steal);
+	MU_RUN_TEST(test_threads);
+}
+
+int main(int argc, char *argv[])
+{
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+
+	return MU_EXIT_CODE;
+}
+
+static void *thief(void *arg)
+{
+    (void) arg;
+    while (__atomic_load_n(&ntaken, __ATOMIC_RELAXED) < NITEMS)
+    {
+        size_t *item = cadtwsdeque_steal(size_2);
+
+        if (item == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        __atomic_fetch_add(&seen[*item], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&ntaken, 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}